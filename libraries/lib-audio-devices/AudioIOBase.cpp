@@ -936,6 +936,10 @@ DoubleSetting AudioIOLatencyCorrection{
    L"/AudioIO/LatencyCorrection", -130.0 };
 DoubleSetting AudioIOLatencyDuration{
    L"/AudioIO/LatencyDuration", 100.0 };
+DoubleSetting AudioIOMonitorBufferDuration{
+   L"/AudioIO/MonitorBufferDuration", 5.0 };
+BoolSetting AudioIOMonitorEffects{
+   L"/AudioIO/MonitorEffects", false };
 StringSetting AudioIOPlaybackDevice{
    L"/AudioIO/PlaybackDevice", L"" };
 DoubleSetting AudioIOPlaybackVolume {
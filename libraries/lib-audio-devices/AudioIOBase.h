@@ -323,6 +323,8 @@ protected:
 extern AUDIO_DEVICES_API StringSetting AudioIOHost;
 extern AUDIO_DEVICES_API DoubleSetting AudioIOLatencyCorrection;
 extern AUDIO_DEVICES_API DoubleSetting AudioIOLatencyDuration;
+extern AUDIO_DEVICES_API DoubleSetting AudioIOMonitorBufferDuration;
+extern AUDIO_DEVICES_API BoolSetting   AudioIOMonitorEffects;
 extern AUDIO_DEVICES_API StringSetting AudioIOPlaybackDevice;
 extern AUDIO_DEVICES_API DoubleSetting AudioIOPlaybackVolume;
 extern AUDIO_DEVICES_API IntSetting    AudioIORecordChannels;
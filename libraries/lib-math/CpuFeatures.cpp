@@ -0,0 +1,55 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CpuFeatures.cpp
+
+**********************************************************************/
+
+#include "CpuFeatures.h"
+
+#if defined(AUDACITY_CPU_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+CpuFeatures Detect()
+{
+   CpuFeatures result;
+#if defined(AUDACITY_CPU_X86) && (defined(__GNUC__) || defined(__clang__))
+   __builtin_cpu_init();
+   result.sse2 = __builtin_cpu_supports("sse2");
+   result.avx = __builtin_cpu_supports("avx");
+   result.avx2 =
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(AUDACITY_CPU_X86) && defined(_MSC_VER)
+   int info[4];
+   __cpuid(info, 0);
+   const int nIds = info[0];
+   if (nIds >= 1) {
+      __cpuid(info, 1);
+      result.sse2 = (info[3] & (1 << 26)) != 0;
+      const bool osxsave = (info[2] & (1 << 27)) != 0;
+      const bool avx = (info[2] & (1 << 28)) != 0;
+      const bool fma = (info[2] & (1 << 12)) != 0;
+      // The operating system must also save the YMM registers
+      const bool ymm = osxsave && (_xgetbv(0) & 6) == 6;
+      result.avx = avx && ymm;
+      if (result.avx && nIds >= 7) {
+         __cpuidex(info, 7, 0);
+         result.avx2 = fma && (info[1] & (1 << 5)) != 0;
+      }
+   }
+#endif
+   return result;
+}
+
+}
+
+const CpuFeatures &GetCpuFeatures()
+{
+   static const CpuFeatures features = Detect();
+   return features;
+}
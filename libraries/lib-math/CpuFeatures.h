@@ -0,0 +1,44 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CpuFeatures.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_CPU_FEATURES__
+#define __AUDACITY_CPU_FEATURES__
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AUDACITY_CPU_X86 1
+#endif
+
+//! Instruction set extensions that kernels may select at run time
+/*!
+ Kernels using AVX or AVX2 are compiled for those extensions function by
+ function (see AUDACITY_TARGET_AVX), so the rest of the program keeps
+ running on processors without them.
+ */
+struct CpuFeatures
+{
+   bool sse2{ false };
+   bool avx{ false };
+   //! Also implies FMA
+   bool avx2{ false };
+};
+
+//! Detected once; the result does not change during the run
+MATH_API const CpuFeatures &GetCpuFeatures();
+
+#if defined(AUDACITY_CPU_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AUDACITY_TARGET_SSE2 __attribute__((target("sse2")))
+#define AUDACITY_TARGET_AVX __attribute__((target("avx")))
+#define AUDACITY_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+// MSVC accepts the intrinsics without any attribute
+#define AUDACITY_TARGET_SSE2
+#define AUDACITY_TARGET_AVX
+#define AUDACITY_TARGET_AVX2
+#endif
+
+#endif
@@ -0,0 +1,257 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MixKernels.cpp
+
+**********************************************************************/
+
+#include "MixKernels.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+
+#ifdef AUDACITY_CPU_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using AddFunction = void (*)(
+   float *, float *, size_t, const float *, size_t, float, float, float);
+using ClampFunction = void (*)(float *, size_t);
+
+// Scalar versions, also used for the remainders of the vector loops
+void AddScalar(float *output, float *meter, size_t stride,
+   const float *input, size_t start, size_t len,
+   float startGain, float deltaGain, float meterGain)
+{
+   if (meter)
+      for (size_t i = start; i < len; ++i)
+         meter[stride * i] += meterGain * input[i];
+   for (size_t i = start; i < len; ++i)
+      output[stride * i] += (startGain + deltaGain * i) * input[i];
+}
+
+void AddWithGainRampScalar(float *output, float *meter, size_t stride,
+   const float *input, size_t len,
+   float startGain, float endGain, float meterGain)
+{
+   const float deltaGain = (endGain - startGain) / len;
+   AddScalar(output, meter, stride, input, 0, len,
+      startGain, deltaGain, meterGain);
+}
+
+void ClampSamplesScalar(float *buffer, size_t len)
+{
+   for (size_t i = 0; i < len; ++i)
+      buffer[i] = std::clamp(buffer[i], -1.0f, 1.0f);
+}
+
+#ifdef AUDACITY_CPU_X86
+
+AUDACITY_TARGET_SSE2
+void AddWithGainRampSSE2(float *output, float *meter, size_t stride,
+   const float *input, size_t len,
+   float startGain, float endGain, float meterGain)
+{
+   const float deltaGain = (endGain - startGain) / len;
+   if (stride > 2) {
+      AddScalar(output, meter, stride, input, 0, len,
+         startGain, deltaGain, meterGain);
+      return;
+   }
+
+   const auto vStart = _mm_set1_ps(startGain);
+   const auto vDelta = _mm_set1_ps(deltaGain);
+   const auto vMeterGain = _mm_set1_ps(meterGain);
+   const auto vStep = _mm_set1_ps(4.0f);
+   // Adding -0.0 leaves every value of the other channel as it was
+   const auto vZero = _mm_set1_ps(-0.0f);
+   auto vIndex = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+   // Interleaved vectors of the second channel reach one float past the
+   // last frame, so leave the last frame to the scalar loop
+   const size_t blocked = (stride == 2 ? len - 1 : len) & ~size_t(3);
+   for (size_t i = 0; i < blocked; i += 4) {
+      const auto in = _mm_loadu_ps(input + i);
+      const auto gain = _mm_add_ps(vStart, _mm_mul_ps(vDelta, vIndex));
+      const auto product = _mm_mul_ps(gain, in);
+      vIndex = _mm_add_ps(vIndex, vStep);
+      if (stride == 1) {
+         auto pOut = output + i;
+         _mm_storeu_ps(pOut, _mm_add_ps(_mm_loadu_ps(pOut), product));
+         if (meter) {
+            auto pMeter = meter + i;
+            _mm_storeu_ps(pMeter, _mm_add_ps(_mm_loadu_ps(pMeter),
+               _mm_mul_ps(vMeterGain, in)));
+         }
+      }
+      else {
+         // Interleave with -0.0, leaving the other channel unchanged
+         auto pOut = output + 2 * i;
+         _mm_storeu_ps(pOut, _mm_add_ps(_mm_loadu_ps(pOut),
+            _mm_unpacklo_ps(product, vZero)));
+         _mm_storeu_ps(pOut + 4, _mm_add_ps(_mm_loadu_ps(pOut + 4),
+            _mm_unpackhi_ps(product, vZero)));
+         if (meter) {
+            const auto metered = _mm_mul_ps(vMeterGain, in);
+            auto pMeter = meter + 2 * i;
+            _mm_storeu_ps(pMeter, _mm_add_ps(_mm_loadu_ps(pMeter),
+               _mm_unpacklo_ps(metered, vZero)));
+            _mm_storeu_ps(pMeter + 4, _mm_add_ps(_mm_loadu_ps(pMeter + 4),
+               _mm_unpackhi_ps(metered, vZero)));
+         }
+      }
+   }
+
+   AddScalar(output, meter, stride, input, blocked, len,
+      startGain, deltaGain, meterGain);
+}
+
+AUDACITY_TARGET_SSE2
+void ClampSamplesSSE2(float *buffer, size_t len)
+{
+   const auto vMin = _mm_set1_ps(-1.0f);
+   const auto vMax = _mm_set1_ps(1.0f);
+   const size_t blocked = len & ~size_t(3);
+   for (size_t i = 0; i < blocked; i += 4) {
+      const auto value = _mm_loadu_ps(buffer + i);
+      _mm_storeu_ps(buffer + i,
+         _mm_min_ps(_mm_max_ps(value, vMin), vMax));
+   }
+   ClampSamplesScalar(buffer + blocked, len - blocked);
+}
+
+// Unpacking works within 128 bit lanes, so the halves are then exchanged
+AUDACITY_TARGET_AVX
+inline void InterleaveWithZeroes(
+   __m256 values, __m256 zero, __m256 &first, __m256 &second)
+{
+   const auto lo = _mm256_unpacklo_ps(values, zero);
+   const auto hi = _mm256_unpackhi_ps(values, zero);
+   first = _mm256_permute2f128_ps(lo, hi, 0x20);
+   second = _mm256_permute2f128_ps(lo, hi, 0x31);
+}
+
+AUDACITY_TARGET_AVX
+void AddWithGainRampAVX(float *output, float *meter, size_t stride,
+   const float *input, size_t len,
+   float startGain, float endGain, float meterGain)
+{
+   const float deltaGain = (endGain - startGain) / len;
+   if (stride > 2) {
+      AddScalar(output, meter, stride, input, 0, len,
+         startGain, deltaGain, meterGain);
+      return;
+   }
+
+   const auto vStart = _mm256_set1_ps(startGain);
+   const auto vDelta = _mm256_set1_ps(deltaGain);
+   const auto vMeterGain = _mm256_set1_ps(meterGain);
+   const auto vStep = _mm256_set1_ps(8.0f);
+   // Adding -0.0 leaves every value of the other channel as it was
+   const auto vZero = _mm256_set1_ps(-0.0f);
+   auto vIndex =
+      _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+
+   // As for SSE2, leave the last frame of the second channel to the
+   // scalar loop
+   const size_t blocked = (stride == 2 ? len - 1 : len) & ~size_t(7);
+   for (size_t i = 0; i < blocked; i += 8) {
+      const auto in = _mm256_loadu_ps(input + i);
+      const auto gain = _mm256_add_ps(vStart, _mm256_mul_ps(vDelta, vIndex));
+      const auto product = _mm256_mul_ps(gain, in);
+      vIndex = _mm256_add_ps(vIndex, vStep);
+      if (stride == 1) {
+         auto pOut = output + i;
+         _mm256_storeu_ps(pOut,
+            _mm256_add_ps(_mm256_loadu_ps(pOut), product));
+         if (meter) {
+            auto pMeter = meter + i;
+            _mm256_storeu_ps(pMeter, _mm256_add_ps(_mm256_loadu_ps(pMeter),
+               _mm256_mul_ps(vMeterGain, in)));
+         }
+      }
+      else {
+         __m256 first, second;
+         InterleaveWithZeroes(product, vZero, first, second);
+         auto pOut = output + 2 * i;
+         _mm256_storeu_ps(pOut,
+            _mm256_add_ps(_mm256_loadu_ps(pOut), first));
+         _mm256_storeu_ps(pOut + 8,
+            _mm256_add_ps(_mm256_loadu_ps(pOut + 8), second));
+         if (meter) {
+            InterleaveWithZeroes(
+               _mm256_mul_ps(vMeterGain, in), vZero, first, second);
+            auto pMeter = meter + 2 * i;
+            _mm256_storeu_ps(pMeter,
+               _mm256_add_ps(_mm256_loadu_ps(pMeter), first));
+            _mm256_storeu_ps(pMeter + 8,
+               _mm256_add_ps(_mm256_loadu_ps(pMeter + 8), second));
+         }
+      }
+   }
+
+   AddScalar(output, meter, stride, input, blocked, len,
+      startGain, deltaGain, meterGain);
+}
+
+AUDACITY_TARGET_AVX
+void ClampSamplesAVX(float *buffer, size_t len)
+{
+   const auto vMin = _mm256_set1_ps(-1.0f);
+   const auto vMax = _mm256_set1_ps(1.0f);
+   const size_t blocked = len & ~size_t(7);
+   for (size_t i = 0; i < blocked; i += 8) {
+      const auto value = _mm256_loadu_ps(buffer + i);
+      _mm256_storeu_ps(buffer + i,
+         _mm256_min_ps(_mm256_max_ps(value, vMin), vMax));
+   }
+   ClampSamplesScalar(buffer + blocked, len - blocked);
+}
+
+#endif
+
+AddFunction ChooseAdd()
+{
+#ifdef AUDACITY_CPU_X86
+   const auto &features = GetCpuFeatures();
+   if (features.avx)
+      return AddWithGainRampAVX;
+   if (features.sse2)
+      return AddWithGainRampSSE2;
+#endif
+   return AddWithGainRampScalar;
+}
+
+ClampFunction ChooseClamp()
+{
+#ifdef AUDACITY_CPU_X86
+   const auto &features = GetCpuFeatures();
+   if (features.avx)
+      return ClampSamplesAVX;
+   if (features.sse2)
+      return ClampSamplesSSE2;
+#endif
+   return ClampSamplesScalar;
+}
+
+}
+
+void AddWithGainRamp(
+   float *output, float *meter, size_t stride,
+   const float *input, size_t len,
+   float startGain, float endGain, float meterGain)
+{
+   static const auto function = ChooseAdd();
+   if (len > 0)
+      function(output, meter, stride, input, len,
+         startGain, endGain, meterGain);
+}
+
+void ClampSamples(float *buffer, size_t len)
+{
+   static const auto function = ChooseClamp();
+   function(buffer, len);
+}
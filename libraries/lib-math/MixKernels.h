@@ -0,0 +1,34 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MixKernels.h
+
+  Inner loops for mixing samples, with SIMD implementations chosen at
+  run time.
+
+**********************************************************************/
+
+#ifndef __AUDACITY_MIX_KERNELS__
+#define __AUDACITY_MIX_KERNELS__
+
+#include <cstddef>
+
+//! Accumulate samples into one channel of an interleaved buffer, with a gain ramp
+/*!
+ For each 0 <= i < len:
+ - output[stride * i] += (startGain + i * ((endGain - startGain) / len)) * input[i]
+ - if meter is not null, meter[stride * i] += meterGain * input[i]
+
+ The results are the same as those of the equivalent scalar loop.  Strides of
+ one and two (mono and stereo output) are vectorized.
+ */
+MATH_API void AddWithGainRamp(
+   float *output, float *meter, size_t stride,
+   const float *input, size_t len,
+   float startGain, float endGain, float meterGain);
+
+//! Limit samples to -1.0..+1.0
+MATH_API void ClampSamples(float *buffer, size_t len);
+
+#endif
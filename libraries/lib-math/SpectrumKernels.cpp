@@ -0,0 +1,239 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrumKernels.cpp
+
+**********************************************************************/
+
+#include "SpectrumKernels.h"
+#include "CpuFeatures.h"
+#include "RealFFTf.h"
+
+#include <vector>
+
+#ifdef AUDACITY_CPU_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using LanesFunction = void (*)(float *, const FFTParam &);
+
+// Scalar version, transforming the lanes one by one
+void RealFFTfLanesScalar(float *buffer, const FFTParam &hFFT)
+{
+   const auto size = 2 * hFFT.Points;
+   std::vector<float> lane(size);
+   for (size_t k = 0; k < FFTLanes; ++k) {
+      for (size_t i = 0; i < size; ++i)
+         lane[i] = buffer[FFTLanes * i + k];
+      RealFFTf(lane.data(), &hFFT);
+      for (size_t i = 0; i < size; ++i)
+         buffer[FFTLanes * i + k] = lane[i];
+   }
+}
+
+#ifdef AUDACITY_CPU_X86
+
+static_assert(FFTLanes == 4);
+
+// The steps of RealFFTf, each applied to all lanes; the operations are the
+// same, so are the results.  Not AVX, with eight lanes: one kernel can't be
+// shared among instruction sets, and SSE2 already does most of the good.
+AUDACITY_TARGET_SSE2
+void RealFFTfLanesSSE2(float *buffer, const FFTParam &hFFT)
+{
+   const auto points = hFFT.Points;
+   const auto at = [buffer](size_t i){ return buffer + FFTLanes * i; };
+   const auto two = _mm_set1_ps(2), half = _mm_set1_ps(0.5f);
+
+   // Butterflies
+   for (auto perGroup = points / 2; perGroup > 0; perGroup >>= 1) {
+      const auto groupSize = perGroup * 2;
+      auto sptr = hFFT.SinTable.get();
+      for (size_t a0 = 0; a0 < 2 * points; a0 += 2 * groupSize, sptr += 2) {
+         const auto sin = _mm_set1_ps(sptr[0]), cos = _mm_set1_ps(sptr[1]);
+         for (size_t a = a0, b = a0 + groupSize; a < a0 + groupSize;
+            a += 2, b += 2) {
+            const auto ar = _mm_loadu_ps(at(a)), ai = _mm_loadu_ps(at(a + 1));
+            const auto br = _mm_loadu_ps(at(b)), bi = _mm_loadu_ps(at(b + 1));
+            const auto v1 =
+               _mm_add_ps(_mm_mul_ps(br, cos), _mm_mul_ps(bi, sin));
+            const auto v2 =
+               _mm_sub_ps(_mm_mul_ps(br, sin), _mm_mul_ps(bi, cos));
+            const auto newBr = _mm_add_ps(ar, v1);
+            const auto newBi = _mm_sub_ps(ai, v2);
+            _mm_storeu_ps(at(b), newBr);
+            _mm_storeu_ps(at(a), _mm_sub_ps(newBr, _mm_mul_ps(two, v1)));
+            _mm_storeu_ps(at(b + 1), newBi);
+            _mm_storeu_ps(at(a + 1), _mm_add_ps(newBi, _mm_mul_ps(two, v2)));
+         }
+      }
+   }
+
+   // Massage output to get the output for a real input sequence
+   auto br1 = hFFT.BitReversed.get() + 1;
+   auto br2 = hFFT.BitReversed.get() + points - 1;
+   for (; br1 < br2; ++br1, --br2) {
+      const auto sin = _mm_set1_ps(hFFT.SinTable[*br1]);
+      const auto cos = _mm_set1_ps(hFFT.SinTable[*br1 + 1]);
+      const auto a = at(*br1), b = at(*br2);
+      const auto ar = _mm_loadu_ps(a), ai = _mm_loadu_ps(a + FFTLanes);
+      const auto br = _mm_loadu_ps(b), bi = _mm_loadu_ps(b + FFTLanes);
+      const auto hrMinus = _mm_sub_ps(ar, br);
+      const auto hrPlus = _mm_add_ps(hrMinus, _mm_mul_ps(br, two));
+      const auto hiMinus = _mm_sub_ps(ai, bi);
+      const auto hiPlus = _mm_add_ps(hiMinus, _mm_mul_ps(bi, two));
+      const auto v1 =
+         _mm_sub_ps(_mm_mul_ps(sin, hrMinus), _mm_mul_ps(cos, hiPlus));
+      const auto v2 =
+         _mm_add_ps(_mm_mul_ps(cos, hrMinus), _mm_mul_ps(sin, hiPlus));
+      const auto newAr = _mm_mul_ps(_mm_add_ps(hrPlus, v1), half);
+      const auto newAi = _mm_mul_ps(_mm_add_ps(hiMinus, v2), half);
+      _mm_storeu_ps(a, newAr);
+      _mm_storeu_ps(b, _mm_sub_ps(newAr, v1));
+      _mm_storeu_ps(a + FFTLanes, newAi);
+      _mm_storeu_ps(b + FFTLanes, _mm_sub_ps(newAi, hiMinus));
+   }
+
+   // Conjugate the center bin, flipping the sign bits
+   const auto center = at(*br1 + 1);
+   _mm_storeu_ps(center,
+      _mm_xor_ps(_mm_loadu_ps(center), _mm_set1_ps(-0.0f)));
+
+   // Put the Fs/2 value into the imaginary part of the DC bin
+   const auto b0 = _mm_loadu_ps(at(0)), b1 = _mm_loadu_ps(at(1));
+   _mm_storeu_ps(at(0), _mm_add_ps(b0, b1));
+   _mm_storeu_ps(at(1), _mm_sub_ps(b0, b1));
+}
+
+#endif
+
+LanesFunction ChooseLanes()
+{
+#ifdef AUDACITY_CPU_X86
+   if (GetCpuFeatures().sse2)
+      return RealFFTfLanesSSE2;
+#endif
+   return RealFFTfLanesScalar;
+}
+
+using MultiplyFunction = void (*)(const int *, const float *, float *,
+   const float *, const float *, size_t);
+
+// Scalar version, also used for the remainders of the vector loops
+void MultiplyScalar(const int *bitReversed, const float *input,
+   float *output, const float *responseR, const float *responseI,
+   size_t start, size_t end)
+{
+   for (size_t i = start; i < end; ++i) {
+      const float re = input[bitReversed[i]];
+      const float im = input[bitReversed[i] + 1];
+      output[2 * i    ] = re * responseR[i] - im * responseI[i];
+      output[2 * i + 1] = re * responseI[i] + im * responseR[i];
+   }
+}
+
+void MultiplyFrequencyResponseScalar(const int *bitReversed,
+   const float *input, float *output,
+   const float *responseR, const float *responseI, size_t points)
+{
+   MultiplyScalar(bitReversed, input, output, responseR, responseI,
+      1, points);
+}
+
+#ifdef AUDACITY_CPU_X86
+
+AUDACITY_TARGET_SSE2
+void MultiplyFrequencyResponseSSE2(const int *bitReversed,
+   const float *input, float *output,
+   const float *responseR, const float *responseI, size_t points)
+{
+   size_t i = 1;
+   for (; i + 4 <= points; i += 4) {
+      const auto br = bitReversed + i;
+      const auto re = _mm_setr_ps(
+         input[br[0]], input[br[1]], input[br[2]], input[br[3]]);
+      const auto im = _mm_setr_ps(
+         input[br[0] + 1], input[br[1] + 1], input[br[2] + 1], input[br[3] + 1]);
+      const auto r = _mm_loadu_ps(responseR + i);
+      const auto s = _mm_loadu_ps(responseI + i);
+      const auto outRe = _mm_sub_ps(_mm_mul_ps(re, r), _mm_mul_ps(im, s));
+      const auto outIm = _mm_add_ps(_mm_mul_ps(re, s), _mm_mul_ps(im, r));
+      _mm_storeu_ps(output + 2 * i, _mm_unpacklo_ps(outRe, outIm));
+      _mm_storeu_ps(output + 2 * i + 4, _mm_unpackhi_ps(outRe, outIm));
+   }
+   MultiplyScalar(bitReversed, input, output, responseR, responseI,
+      i, points);
+}
+
+// Only AVX, not AVX2: its gathers would help little, and with FMA enabled
+// the compiler may fuse the multiplications and additions, changing the
+// results in the last bit
+AUDACITY_TARGET_AVX
+void MultiplyFrequencyResponseAVX(const int *bitReversed,
+   const float *input, float *output,
+   const float *responseR, const float *responseI, size_t points)
+{
+   size_t i = 1;
+   for (; i + 8 <= points; i += 8) {
+      const auto br = bitReversed + i;
+      const auto re = _mm256_setr_ps(
+         input[br[0]], input[br[1]], input[br[2]], input[br[3]],
+         input[br[4]], input[br[5]], input[br[6]], input[br[7]]);
+      const auto im = _mm256_setr_ps(
+         input[br[0] + 1], input[br[1] + 1], input[br[2] + 1], input[br[3] + 1],
+         input[br[4] + 1], input[br[5] + 1], input[br[6] + 1], input[br[7] + 1]);
+      const auto r = _mm256_loadu_ps(responseR + i);
+      const auto s = _mm256_loadu_ps(responseI + i);
+      const auto outRe =
+         _mm256_sub_ps(_mm256_mul_ps(re, r), _mm256_mul_ps(im, s));
+      const auto outIm =
+         _mm256_add_ps(_mm256_mul_ps(re, s), _mm256_mul_ps(im, r));
+      // Unpacking works within 128 bit lanes, so the halves are then exchanged
+      const auto lo = _mm256_unpacklo_ps(outRe, outIm);
+      const auto hi = _mm256_unpackhi_ps(outRe, outIm);
+      _mm256_storeu_ps(output + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+      _mm256_storeu_ps(output + 2 * i + 8,
+         _mm256_permute2f128_ps(lo, hi, 0x31));
+   }
+   MultiplyScalar(bitReversed, input, output, responseR, responseI,
+      i, points);
+}
+
+#endif
+
+MultiplyFunction ChooseMultiply()
+{
+#ifdef AUDACITY_CPU_X86
+   const auto &features = GetCpuFeatures();
+   if (features.avx)
+      return MultiplyFrequencyResponseAVX;
+   if (features.sse2)
+      return MultiplyFrequencyResponseSSE2;
+#endif
+   return MultiplyFrequencyResponseScalar;
+}
+
+}
+
+void MultiplyFrequencyResponse(const FFTParam &hFFT,
+   const float *input, float *output,
+   const float *responseR, const float *responseI)
+{
+   static const auto function = ChooseMultiply();
+   const auto points = hFFT.Points;
+   // DC component is purely real
+   output[0] = input[0] * responseR[0];
+   function(hFFT.BitReversed.get(), input, output,
+      responseR, responseI, points);
+   // Fs/2 component is purely real
+   output[1] = input[1] * responseR[points];
+}
+
+void RealFFTfLanes(float *buffer, const FFTParam &hFFT)
+{
+   static const auto function = ChooseLanes();
+   function(buffer, hFFT);
+}
@@ -0,0 +1,46 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrumKernels.h
+
+  Inner loops for transforms and filtering in the frequency domain, with
+  SIMD implementations chosen at run time.
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SPECTRUM_KERNELS__
+#define __AUDACITY_SPECTRUM_KERNELS__
+
+#include <cstddef>
+
+struct FFTParam;
+
+//! How many transforms RealFFTfLanes does at once
+constexpr size_t FFTLanes = 4;
+
+//! RealFFTf of FFTLanes interleaved buffers at once
+/*!
+ @param buffer 2 * hFFT.Points groups of FFTLanes floats: element i of
+ transform k is buffer[FFTLanes * i + k], both before and after
+
+ The results are the same as those of RealFFTf on each transform.
+ */
+MATH_API void RealFFTfLanes(float *buffer, const FFTParam &hFFT);
+
+//! Multiply a spectrum by a frequency response, ready for InverseRealFFTf
+/*!
+ @param hFFT describes a transform of 2 * hFFT.Points real samples
+ @param input the result of RealFFTf, in bit reversed order
+ @param output receives the products in natural order; may not be input
+ @param responseR real parts of the response, hFFT.Points + 1 of them
+ @param responseI imaginary parts of the response, hFFT.Points of them; the
+ first, at dc, is ignored, and that at Fs/2 is taken to be zero
+
+ The results are the same as those of the equivalent scalar loop.
+ */
+MATH_API void MultiplyFrequencyResponse(const FFTParam &hFFT,
+   const float *input, float *output,
+   const float *responseR, const float *responseI);
+
+#endif
@@ -73,6 +73,7 @@ time warp info and AudioIOListener and whether the playback is looped.
 
 #include "AudioIOExt.h"
 #include "AudioIOListener.h"
+#include "LatencyMeasurement.h"
 
 #include "float_cast.h"
 #include "DeviceManager.h"
@@ -129,6 +130,7 @@ time warp info and AudioIOListener and whether the playback is looped.
 #include "BasicUI.h"
 
 #include "Gain.h"
+#include "MixKernels.h"
 
 #ifdef EXPERIMENTAL_AUTOMATED_INPUT_LEVEL_ADJUSTMENT
    #define LOWER_BOUND 0.0
@@ -481,7 +483,8 @@ static PaSampleFormat AudacityToPortAudioSampleFormat(sampleFormat format)
 bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
                                    unsigned int numPlaybackChannels,
                                    unsigned int numCaptureChannels,
-                                   sampleFormat captureFormat)
+                                   sampleFormat captureFormat,
+                                   unsigned long framesPerBuffer)
 {
    auto sampleRate = options.rate;
    mNumPauseFrames = 0;
@@ -530,6 +533,11 @@ bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
 
    auto latencyDuration = AudioIOLatencyDuration.Read();
 
+   // A fixed, small callback size means the caller wants the quickest
+   // turnaround from input to output, as for monitoring
+   const bool lowLatency = framesPerBuffer > 0;
+   const double lowLatencySeconds = framesPerBuffer / mRate;
+
    if( numPlaybackChannels > 0)
    {
       usePlayback = true;
@@ -549,7 +557,9 @@ bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
       playbackParameters.hostApiSpecificStreamInfo = NULL;
       playbackParameters.channelCount = mNumPlaybackChannels;
 
-      if (mSoftwarePlaythrough)
+      if (lowLatency)
+         playbackParameters.suggestedLatency = lowLatencySeconds;
+      else if (mSoftwarePlaythrough)
          playbackParameters.suggestedLatency =
             playbackDeviceInfo->defaultLowOutputLatency;
       else {
@@ -587,7 +597,9 @@ bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
       captureParameters.hostApiSpecificStreamInfo = NULL;
       captureParameters.channelCount = mNumCaptureChannels;
 
-      if (mSoftwarePlaythrough)
+      if (lowLatency)
+         captureParameters.suggestedLatency = lowLatencySeconds;
+      else if (mSoftwarePlaythrough)
          captureParameters.suggestedLatency =
             captureDeviceInfo->defaultHighInputLatency;
       else
@@ -625,7 +637,10 @@ bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
       mLastPaError = Pa_OpenStream( &mPortStreamV19,
                                     useCapture ? &captureParameters : NULL,
                                     usePlayback ? &playbackParameters : NULL,
-                                    mRate, paFramesPerBufferUnspecified,
+                                    mRate,
+                                    lowLatency
+                                       ? framesPerBuffer
+                                       : paFramesPerBufferUnspecified,
                                     paNoFlag,
                                     audacityAudioCallback, lpUserData );
       if (mLastPaError == paNoError) {
@@ -635,6 +650,15 @@ bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
       wxMilliSleep(1000);
    }
 
+   mMonitorLatency.store(0.0, std::memory_order_relaxed);
+   if (mSoftwarePlaythrough && useCapture && usePlayback &&
+       mPortStreamV19 != NULL && mLastPaError == paNoError) {
+      // A first estimate, until the callback can measure it
+      if (const auto info = Pa_GetStreamInfo(mPortStreamV19))
+         mMonitorLatency.store(info->inputLatency + info->outputLatency,
+            std::memory_order_relaxed);
+   }
+
 
 #if USE_PORTMIXER
 #ifdef __WXMSW__
@@ -706,6 +730,20 @@ void AudioIO::LoopPlayUpdate( PlayRegionEvent &evt )
    AudioIO::Get()->mPlaybackSchedule.MessageProducer( evt );
 }
 
+//! Callback size for streams with software playthrough, or zero
+/*!
+ Software playthrough gets its own small buffer size, independent of the
+ buffer length used for playback only, so that the input can be heard without
+ noticeable delay, both while monitoring and while recording
+ */
+static unsigned long PlaythroughFramesPerBuffer(double rate)
+{
+   const auto bufferDuration = AudioIOMonitorBufferDuration.Read();
+   if (bufferDuration <= 0)
+      return 0;
+   return std::max(16L, lrint(rate * bufferDuration / 1000.0));
+}
+
 void AudioIO::StartMonitoring( const AudioIOStartStreamOptions &options )
 {
    if ( mPortStreamV19 || mStreamToken )
@@ -716,16 +754,19 @@ void AudioIO::StartMonitoring( const AudioIOStartStreamOptions &options )
    auto captureChannels = AudioIORecordChannels.Read();
    gPrefs->Read(wxT("/AudioIO/SWPlaythrough"), &mSoftwarePlaythrough, false);
    int playbackChannels = 0;
+   unsigned long framesPerBuffer = 0;
 
-   if (mSoftwarePlaythrough)
+   if (mSoftwarePlaythrough) {
       playbackChannels = 2;
+      framesPerBuffer = PlaythroughFramesPerBuffer(options.rate);
+   }
 
    // FIXME: TRAP_ERR StartPortAudioStream (a PaError may be present)
    // but StartPortAudioStream function only returns true or false.
    mUsingAlsa = false;
    success = StartPortAudioStream(options, (unsigned int)playbackChannels,
                                   (unsigned int)captureChannels,
-                                  captureFormat);
+                                  captureFormat, framesPerBuffer);
 
    auto pOwningProject = mOwningProject.lock();
    if (!success) {
@@ -738,6 +779,16 @@ void AudioIO::StartMonitoring( const AudioIOStartStreamOptions &options )
       return;
    }
 
+   // Realtime effects may be applied to the monitored input only.
+   // The processor is added as group 0 with two channels, because
+   // DoPlaythrough always produces stereo.
+   mMonitorEffects = mSoftwarePlaythrough && AudioIOMonitorEffects.Read();
+   if (mMonitorEffects) {
+      auto & em = RealtimeEffectManager::Get();
+      em.RealtimeInitialize(mRate);
+      em.RealtimeAddProcessor(0, mNumPlaybackChannels, mRate);
+   }
+
    wxCommandEvent e(EVT_AUDIOIO_MONITOR);
    e.SetEventObject( pOwningProject.get() );
    e.SetInt(true);
@@ -757,6 +808,58 @@ void AudioIO::StartMonitoring( const AudioIOStartStreamOptions &options )
    }
 }
 
+std::optional<double> AudioIO::MeasureLatency(
+   const AudioIOStartStreamOptions &options )
+{
+   if ( mPortStreamV19 || mStreamToken )
+      return {};
+
+   // Play stereo and record the selected number of channels, as for
+   // recording, but without playthrough and always in float.  The buffer
+   // size is as for recording, because it changes the round trip.
+   bool playthrough;
+   gPrefs->Read(wxT("/AudioIO/SWPlaythrough"), &playthrough, false);
+   mSoftwarePlaythrough = false;
+   mMonitorEffects = false;
+   mUsingAlsa = false;
+   AudioIOStartStreamOptions measureOptions{ options.pProject, options.rate };
+   if (!StartPortAudioStream(measureOptions, 2,
+         (unsigned int)AudioIORecordChannels.Read(), floatSample,
+         playthrough ? PlaythroughFramesPerBuffer(options.rate) : 0))
+      return {};
+
+   LatencyMeasurement measurement{ mRate };
+   mLatencyMeasurement.store(&measurement, std::memory_order_release);
+
+   auto cleanup = finally([&]{
+      if (mPortStreamV19) {
+         Pa_AbortStream( mPortStreamV19 );
+         Pa_CloseStream( mPortStreamV19 );
+         mPortStreamV19 = NULL;
+      }
+      mLatencyMeasurement.store(nullptr, std::memory_order_release);
+#if (defined(__WXMAC__) || defined(__WXMSW__)) && wxCHECK_VERSION(3,1,0)
+      wxPowerResource::Release(wxPOWER_RESOURCE_SCREEN);
+#endif
+      mUpdateMeters = false;
+      mNumCaptureChannels = 0;
+      mNumPlaybackChannels = 0;
+      ResetOwningProject();
+   });
+
+   mLastPaError = Pa_StartStream( mPortStreamV19 );
+   if (mLastPaError != paNoError)
+      return {};
+
+   // Allow generously for the stream to start up
+   const auto timeout =
+      ::wxGetUTCTimeMillis() + lrint(1000 * measurement.GetDuration()) + 2000;
+   while (!measurement.IsComplete() && ::wxGetUTCTimeMillis() < timeout)
+      wxMilliSleep( 50 );
+
+   return measurement.Estimate();
+}
+
 int AudioIO::StartStream(const TransportTracks &tracks,
                          double t0, double t1,
                          const AudioIOStartStreamOptions &options)
@@ -824,6 +927,10 @@ int AudioIO::StartStream(const TransportTracks &tracks,
    mRecordingSchedule.mPreRoll = preRoll;
    mRecordingSchedule.mLatencyCorrection =
       AudioIOLatencyCorrection.Read() / 1000.0;
+   // A round trip measured for the selected devices takes precedence
+   if (AudioIOUseMeasuredLatency.Read())
+      if (auto measured = LatencyMeasurement::Lookup())
+         mRecordingSchedule.mLatencyCorrection = -*measured / 1000.0;
    mRecordingSchedule.mDuration = t1 - t0;
    if (options.pCrossfadeData)
       mRecordingSchedule.mCrossfadeData.swap( *options.pCrossfadeData );
@@ -891,10 +998,17 @@ int AudioIO::StartStream(const TransportTracks &tracks,
          pListener->OnAudioIOStartRecording();
    }
 
+   // Overdubbing with software playthrough needs the same quick turnaround
+   // as monitoring
+   unsigned long framesPerBuffer = 0;
+   if (mSoftwarePlaythrough && captureChannels > 0)
+      framesPerBuffer = PlaythroughFramesPerBuffer(options.rate);
+
    bool successAudio;
 
    successAudio = StartPortAudioStream(options, playbackChannels,
-                                       captureChannels, captureFormat);
+                                       captureChannels, captureFormat,
+                                       framesPerBuffer);
 
    // Call this only after reassignment of mRate that might happen in the
    // previous call.
@@ -1587,6 +1701,8 @@ void AudioIO::StopStream()
 
    mNumCaptureChannels = 0;
    mNumPlaybackChannels = 0;
+   mMonitorEffects = false;
+   mMonitorLatency.store(0.0, std::memory_order_relaxed);
 
    mPlaybackTracks.clear();
    mCaptureTracks.clear();
@@ -1843,13 +1959,26 @@ void AudioIO::FillPlayBuffers()
          // warping
          if (frames > 0)
          {
+            auto &mixer = *mPlaybackMixers[i];
+            auto &ringBuffer = *mPlaybackBuffers[i];
+
+            // Mix directly into the ring buffer, in two pieces if its free
+            // space wraps around
             size_t produced = 0;
-            if ( toProduce )
-               produced = mPlaybackMixers[i]->Process( toProduce );
+            while ( produced < toProduce ) {
+               const auto [buffer, space] = ringBuffer.GetUnwrappedPutBuffer();
+               const auto wanted = std::min( space, toProduce - produced );
+               if ( wanted == 0 )
+                  break;
+               const auto mixed = mixer.Process( wanted, &buffer );
+               ringBuffer.Commit( mixed );
+               produced += mixed;
+               if ( mixed < wanted )
+                  break;
+            }
             //wxASSERT(produced <= toProduce);
-            auto warpedSamples = mPlaybackMixers[i]->GetBuffer();
-            const auto put = mPlaybackBuffers[i]->Put(
-               warpedSamples, floatSample, produced, frames - produced);
+            const auto put = produced + ringBuffer.Put(
+               nullptr, floatSample, 0, frames - produced);
             // wxASSERT(put == frames);
             // but we can't assert in this thread
             wxUnusedVar(put);
@@ -1937,7 +2066,9 @@ void AudioIO::DrainRecordBuffers()
                   // Rightward shift
                   // Once only (per track per recording), insert some initial
                   // silence.
-                  size_t size = floor( correction * mRate * mFactor);
+                  // Round rather than truncate, so that a measured
+                  // latency is compensated to the nearest sample
+                  size_t size = lrint( correction * mRate * mFactor);
                   SampleBuffer temp(size, trackFormat);
                   ClearSamples(temp.ptr(), trackFormat, 0, size);
                   mCaptureTracks[i]->Append(temp.ptr(), trackFormat, size, 1);
@@ -1945,7 +2076,7 @@ void AudioIO::DrainRecordBuffers()
                else {
                   // Leftward shift
                   // discard some samples from the ring buffers.
-                  size_t size = floor(
+                  size_t size = lrint(
                      mRecordingSchedule.ToDiscard() * mRate );
 
                   // The ring buffer might have grown concurrently -- don't discard more
@@ -2338,10 +2469,7 @@ void AudioIoCallback::AddToOutputChannel( unsigned int chan,
 
    // Output volume emulation: possibly copy meter samples, then
    // apply volume, then copy to the output buffer
-   if (outputMeterFloats != outputFloats)
-      for ( unsigned i = 0; i < len; ++i)
-         outputMeterFloats[numPlaybackChannels*i+chan] +=
-            gain*tempBuf[i];
+   const float meterGain = gain;
 
    // DV: We use gain to emulate panning.
    // Let's keep the old behavior for panning.
@@ -2355,16 +2483,16 @@ void AudioIoCallback::AddToOutputChannel( unsigned int chan,
       oldGain =gain;
    wxASSERT(len > 0);
 
-   // Linear interpolate.
-   float deltaGain = (gain - oldGain) / len;
-   for (unsigned i = 0; i < len; i++)
-      outputFloats[numPlaybackChannels*i+chan] += (oldGain + deltaGain * i) *tempBuf[i];
+   // Linear interpolate, and accumulate the meter samples in the same pass.
+   AddWithGainRamp( outputFloats + chan,
+      (outputMeterFloats != outputFloats)
+         ? outputMeterFloats + chan : nullptr,
+      numPlaybackChannels, tempBuf, len, oldGain, gain, meterGain );
 };
 
 // Limit values to -1.0..+1.0
 void ClampBuffer(float * pBuffer, unsigned long len){
-   for(unsigned i = 0; i < len; i++)
-      pBuffer[i] = wxClip( pBuffer[i], -1.0f, 1.0f);
+   ClampSamples( pBuffer, len );
 };
 
 
@@ -2766,6 +2894,31 @@ void AudioIoCallback::DoPlaythrough(
       DoSoftwarePlaythrough(inputBuffer, mCaptureFormat,
                               numCaptureChannels,
                               outputBuffer, framesPerBuffer);
+
+      // When only monitoring, there are no tracks to mix in after this,
+      // so realtime effects are applied to the input itself.  While
+      // recording, the effects belong to the groups of the playback tracks,
+      // so the input is heard without them.
+      if (mMonitorEffects && mStreamToken <= 0) {
+         float **tempBufs =
+            (float **) alloca(numPlaybackChannels * sizeof(float *));
+         for (unsigned c = 0; c < numPlaybackChannels; c++) {
+            tempBufs[c] = (float *) alloca(framesPerBuffer * sizeof(float));
+            for (unsigned i = 0; i < framesPerBuffer; i++)
+               tempBufs[c][i] = outputFloats[numPlaybackChannels*i+c];
+         }
+
+         auto & em = RealtimeEffectManager::Get();
+         em.RealtimeProcessStart();
+         em.RealtimeProcess(0, numPlaybackChannels, tempBufs, framesPerBuffer);
+         em.RealtimeProcessEnd();
+
+         for (unsigned c = 0; c < numPlaybackChannels; c++)
+            for (unsigned i = 0; i < framesPerBuffer; i++)
+               outputFloats[numPlaybackChannels*i+c] = tempBufs[c][i];
+
+         ClampBuffer( outputFloats, framesPerBuffer*numPlaybackChannels );
+      }
    }
 
    // Copy the results to outputMeterFloats if necessary
@@ -2933,6 +3086,15 @@ int AudioIoCallback::AudioCallback(
    const PaStreamCallbackTimeInfo *timeInfo,
    const PaStreamCallbackFlags statusFlags, void * WXUNUSED(userData) )
 {
+   // While measuring latency, exchange the test signal and nothing else
+   if (auto pMeasurement =
+          mLatencyMeasurement.load(std::memory_order_acquire)) {
+      pMeasurement->Process(
+         reinterpret_cast<const float*>(inputBuffer), mNumCaptureChannels,
+         outputBuffer, mNumPlaybackChannels, framesPerBuffer);
+      return paContinue;
+   }
+
    // Poll tracks for change of state.  User might click mute and solo buttons.
    mbHasSoloTracks = CountSoloingTracks() > 0 ;
    mCallbackReturn = paContinue;
@@ -3000,6 +3162,16 @@ int AudioIoCallback::AudioCallback(
          framesPerBuffer);
    }
 
+   // Measure the round trip of software playthrough, when PortAudio
+   // supplies the time stamps of the sound card buffers
+   if (mSoftwarePlaythrough &&
+       inputBuffer && outputBuffer && timeInfo &&
+       timeInfo->inputBufferAdcTime > 0 &&
+       timeInfo->outputBufferDacTime > timeInfo->inputBufferAdcTime)
+      mMonitorLatency.store(
+         timeInfo->outputBufferDacTime - timeInfo->inputBufferAdcTime,
+         std::memory_order_relaxed);
+
    // Even when paused, we do playthrough.
    // Initialise output buffer to zero or to playthrough data.
    // Initialise output meter values.
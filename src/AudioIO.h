@@ -21,6 +21,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <utility>
 #include <wx/atomic.h> // member variable
 
@@ -36,6 +37,7 @@ class RingBuffer;
 class Mixer;
 class Resample;
 class AudioThread;
+class LatencyMeasurement;
 class PlayRegionEvent;
 
 class AudacityProject;
@@ -274,6 +276,14 @@ public:
 
    double              mMinCaptureSecsToCopy;
    bool                mSoftwarePlaythrough;
+   /// True if realtime effects are applied to software playthrough while
+   /// only monitoring
+   bool                mMonitorEffects{ false };
+   /// Most recent round-trip latency of software playthrough, in seconds
+   std::atomic<double> mMonitorLatency{ 0.0 };
+   /// Non-null only while MeasureLatency() runs; then the callback does
+   /// nothing else
+   std::atomic<LatencyMeasurement*> mLatencyMeasurement{ nullptr };
    /// True if Sound Activated Recording is enabled
    bool                mPauseRec;
    float               mSilenceLevel;
@@ -371,6 +381,15 @@ public:
     * the output device in stereo to play the data through */
    void StartMonitoring( const AudioIOStartStreamOptions &options );
 
+   /** \brief Measure the round-trip latency of the selected devices
+    *
+    * Plays a test signal while recording, and blocks until the recording is
+    * long enough to find the signal again.  The result, in seconds, is not
+    * stored; see LatencyMeasurement::Store.  Returns nullopt if the stream
+    * could not be opened or the signal was not found in the recording. */
+   std::optional<double> MeasureLatency(
+      const AudioIOStartStreamOptions &options );
+
    /** \brief Start recording or playing back audio
     *
     * Allocates buffers for recording and playback, gets the Audio thread to
@@ -432,6 +451,14 @@ public:
     * soundcard mixer (driven by PortMixer) */
    wxArrayString GetInputSourceNames();
 
+   /** \brief Round-trip latency of software playthrough
+    *
+    * Measured from the PortAudio time stamps of input and output buffers
+    * in the callback, or the stream's reported latencies until the first
+    * callback supplies them.  Zero when there is no software playthrough. */
+   double GetMonitorLatency() const
+   { return mMonitorLatency.load(std::memory_order_relaxed); }
+
    sampleFormat GetCaptureFormat() { return mCaptureFormat; }
    unsigned GetNumPlaybackChannels() const { return mNumPlaybackChannels; }
    unsigned GetNumCaptureChannels() const { return mNumCaptureChannels; }
@@ -503,12 +530,15 @@ private:
     * currently in use (for many reasons). The number of Capture and Playback
     * channels requested includes an allocation for doing software playthrough
     * if necessary. The captureFormat is used for recording only, the playback
-    * being floating point always. Returns true if the stream opened successfully
-    * and false if it did not. */
+    * being floating point always. A nonzero framesPerBuffer requests a fixed
+    * callback size and a matching low suggested latency, as used for
+    * monitoring; zero lets PortAudio choose. Returns true if the stream opened
+    * successfully and false if it did not. */
    bool StartPortAudioStream(const AudioIOStartStreamOptions &options,
                              unsigned int numPlaybackChannels,
                              unsigned int numCaptureChannels,
-                             sampleFormat captureFormat);
+                             sampleFormat captureFormat,
+                             unsigned long framesPerBuffer = 0);
 
    void SetOwningProject( const std::shared_ptr<AudacityProject> &pProject );
    void ResetOwningProject();
@@ -18,6 +18,8 @@ of sample block storage.
 
 #include "Benchmark.h"
 
+#include <algorithm>
+#include <cmath>
 #include <wx/app.h>
 #include <wx/log.h>
 #include <wx/textctrl.h>
@@ -32,7 +34,15 @@ of sample block storage.
 #include <wx/valgen.h>
 #include <wx/valtext.h>
 #include <wx/intl.h>
-
+#include <wx/textfile.h>
+#include <wx/dcmemory.h>
+#include <wx/pen.h>
+
+#include "AColor.h"
+#include "LabelTrack.h"
+#include "LatencyMeasurement.h"
+#include "MixKernels.h"
+#include "ParallelFor.h"
 #include "SampleBlock.h"
 #include "ShuttleGui.h"
 #include "Project.h"
@@ -42,6 +52,10 @@ of sample block storage.
 #include "Prefs.h"
 #include "ProjectRate.h"
 #include "ViewInfo.h"
+#include "effects/Biquad.h"
+#include "RealFFTf.h"
+#include "SpectrumKernels.h"
+#include "tracks/playabletrack/wavetrack/ui/WaveRaster.h"
 
 #include "FileNames.h"
 #include "SelectFile.h"
@@ -572,6 +586,461 @@ void BenchmarkDialog::OnRun( wxCommandEvent & WXUNUSED(event))
    Printf( XO("At 44100 Hz, %d bytes per sample, the estimated number of\n simultaneous tracks that could be played at once: %.1f\n" )
       .Format( SAMPLE_SIZE(SampleFormat), (nChunks*chunkSize/44100.0)/(elapsed/1000.0) ) );
 
+   {
+      // Two tracks mixed into each channel and clipped, as by the audio
+      // callback, into mono and stereo buffers of odd lengths, by the scalar
+      // loops and by the kernels chosen for this processor
+      const size_t lengths[] = { 1, 3, 7, 257, 1023, 4095 };
+      const int nTracks = 2, nBuffers = 2000;
+      const float startGains[] = { 0.25f, 1.5f }, endGains[] = { 1.5f, 0.5f };
+      const float meterGain = 0.75f;
+      Printf( XO("Mixing %d buffers of each of %d lengths...\n")
+         .Format( nBuffers, (int)(sizeof(lengths) / sizeof(*lengths)) ) );
+      wxTheApp->Yield();
+      FlushPrint();
+
+      for (size_t stride = 1; stride <= 2; ++stride) {
+         long elapsedScalar = 0;
+         elapsed = 0;
+         for (auto len : lengths) {
+            const auto size = stride * len;
+            Floats input{ len };
+            for (size_t i = 0; i < len; ++i)
+               input[i] = 2.0f * rand() / RAND_MAX - 1.0f;
+            Floats scalar{ size }, scalarMeter{ size },
+               kernel{ size }, kernelMeter{ size };
+
+            timer.Start();
+            for (int n = 0; n < nBuffers; ++n) {
+               std::fill(scalar.get(), scalar.get() + size, 0.0f);
+               std::fill(scalarMeter.get(), scalarMeter.get() + size, 0.0f);
+               for (int t = 0; t < nTracks; ++t)
+                  for (size_t c = 0; c < stride; ++c) {
+                     const float deltaGain =
+                        (endGains[t] - startGains[t]) / len;
+                     for (size_t i = 0; i < len; ++i)
+                        scalarMeter[stride * i + c] += meterGain * input[i];
+                     for (size_t i = 0; i < len; ++i)
+                        scalar[stride * i + c] +=
+                           (startGains[t] + deltaGain * i) * input[i];
+                  }
+               for (size_t i = 0; i < size; ++i)
+                  scalar[i] = std::clamp(scalar[i], -1.0f, 1.0f);
+            }
+            elapsedScalar += timer.Time();
+
+            timer.Start();
+            for (int n = 0; n < nBuffers; ++n) {
+               std::fill(kernel.get(), kernel.get() + size, 0.0f);
+               std::fill(kernelMeter.get(), kernelMeter.get() + size, 0.0f);
+               for (int t = 0; t < nTracks; ++t)
+                  for (size_t c = 0; c < stride; ++c)
+                     AddWithGainRamp( &kernel[c], &kernelMeter[c], stride,
+                        input.get(), len, startGains[t], endGains[t],
+                        meterGain );
+               ClampSamples( kernel.get(), size );
+            }
+            elapsed += timer.Time();
+
+            if (!std::equal(scalar.get(), scalar.get() + size,
+                   kernel.get()) ||
+                !std::equal(scalarMeter.get(), scalarMeter.get() + size,
+                   kernelMeter.get())) {
+               Printf( XO("Mixing results differ for %d channels of %d samples.\n")
+                  .Format( (int)stride, (int)len ) );
+               goto fail;
+            }
+         }
+         Printf( XO("Time to mix %d channels: %ld ms by scalar loops, %ld ms by kernels\n")
+            .Format( (int)stride, elapsedScalar, elapsed ) );
+      }
+   }
+
+   {
+      // Overlap-add filtering of a minute at 44100 Hz as in the Equalization
+      // effect: one lump at a time with the scalar multiplication by the
+      // response, as before, and lumps in parallel with
+      // MultiplyFrequencyResponse, on one thread and on all
+      const size_t windowSize = 16384, filterLen = 44100 * 60;
+      const size_t filterLengths[] = { 21, 1001, 8191 };
+      const size_t blockSizes[] = { 1, 65536, 1048576 };
+      const auto hFFT = GetFFT(windowSize);
+      const auto points = hFFT->Points;
+      Floats responseR{ points + 1 }, responseI{ points };
+      for (size_t i = 0; i <= points; ++i)
+         responseR[i] = rand() / (float)RAND_MAX - 0.5f;
+      for (size_t i = 0; i < points; ++i)
+         responseI[i] = rand() / (float)RAND_MAX - 0.5f;
+      Floats input{ filterLen };
+      for (size_t i = 0; i < filterLen; ++i)
+         input[i] = rand() / (float)RAND_MAX - 0.5f;
+
+      // As EffectEqualization::Filter did before
+      const auto scalarFilter = [&](float *buffer, float *scratch){
+         RealFFTf(buffer, hFFT.get());
+         scratch[0] = buffer[0] * responseR[0];
+         for (size_t i = 1; i < points; ++i) {
+            const float re = buffer[hFFT->BitReversed[i]];
+            const float im = buffer[hFFT->BitReversed[i] + 1];
+            scratch[2 * i    ] = re * responseR[i] - im * responseI[i];
+            scratch[2 * i + 1] = re * responseI[i] + im * responseR[i];
+         }
+         scratch[1] = buffer[1] * responseR[points];
+         InverseRealFFTf(scratch, hFFT.get());
+         ReorderToTime(hFFT.get(), scratch, buffer);
+      };
+      const auto filter = [&](float *buffer, float *scratch){
+         RealFFTf(buffer, hFFT.get());
+         MultiplyFrequencyResponse(*hFFT, buffer, scratch,
+            responseR.get(), responseI.get());
+         InverseRealFFTf(scratch, hFFT.get());
+         ReorderToTime(hFFT.get(), scratch, buffer);
+      };
+
+      // As EffectEqualization::ProcessOne does, with nThreads 0 for the
+      // scalar filter on the calling thread
+      const auto process = [&](size_t M, size_t blockLen, unsigned nThreads,
+         float *output){
+         const size_t L = windowSize - (M - 1);
+         if (blockLen % L != 0)
+            blockLen += L - blockLen % L;
+         const auto maxLumps = blockLen / L;
+         Floats windows{ (maxLumps + 1) * windowSize };
+         Floats scratch{ std::max(1u, nThreads) * windowSize };
+         float *thisWindow = windows.get();
+         float *lastWindow = windows.get();
+         std::fill(lastWindow, lastWindow + windowSize, 0.0f);
+         size_t wcopy = 0;
+         for (size_t s = 0; s < filterLen; s += blockLen) {
+            const auto block = std::min(blockLen, filterLen - s);
+            if (lastWindow != windows.get()) {
+               std::copy(lastWindow, lastWindow + windowSize, windows.get());
+               lastWindow = windows.get();
+            }
+            const auto nLumps = (block + L - 1) / L;
+            const auto nRanges =
+               std::max<size_t>(1, std::min<size_t>(nThreads, nLumps));
+            const auto filterRange = [&](size_t range){
+               const auto pScratch = scratch.get() + range * windowSize;
+               const auto end = nLumps * (range + 1) / nRanges;
+               for (auto lump = nLumps * range / nRanges; lump < end; ++lump) {
+                  const auto window = windows.get() + (lump + 1) * windowSize;
+                  const auto n = std::min(L, block - lump * L);
+                  std::copy(&input[s + lump * L], &input[s + lump * L] + n,
+                     window);
+                  std::fill(window + n, window + windowSize, 0.0f);
+                  if (nThreads == 0)
+                     scalarFilter(window, pScratch);
+                  else
+                     filter(window, pScratch);
+               }
+            };
+            if (nThreads == 0)
+               filterRange(0);
+            else
+               ParallelFor(nRanges, filterRange, nRanges);
+
+            for (size_t lump = 0; lump < nLumps; ++lump) {
+               const auto i = s + lump * L;
+               thisWindow = windows.get() + (lump + 1) * windowSize;
+               wcopy = std::min(L, block - lump * L);
+               for (size_t j = 0; (j < M - 1) && (j < wcopy); j++)
+                  output[i + j] = thisWindow[j] + lastWindow[L + j];
+               for (size_t j = M - 1; j < wcopy; j++)
+                  output[i + j] = thisWindow[j];
+               std::swap(thisWindow, lastWindow);
+            }
+         }
+         // The tail
+         size_t j = 0;
+         if (wcopy < M - 1)
+            for (; j < M - 1 - wcopy; j++)
+               output[filterLen + j] =
+                  lastWindow[wcopy + j] + thisWindow[L + wcopy + j];
+         for (; j < M - 1; j++)
+            output[filterLen + j] = lastWindow[wcopy + j];
+      };
+
+      const auto nThreads = ParallelConcurrency();
+      Printf( XO("Equalizing 60 seconds at 44100 Hz on up to %d threads...\n")
+         .Format( (int)nThreads ) );
+      wxTheApp->Yield();
+      FlushPrint();
+
+      for (auto M : filterLengths) {
+         const auto outputLen = filterLen + M - 1;
+         Floats scalar{ outputLen }, parallel{ outputLen };
+         timer.Start();
+         process(M, blockSizes[1], 0, scalar.get());
+         const auto elapsedScalar = timer.Time();
+         for (auto blockLen : blockSizes) {
+            long elapsedOne = 0;
+            for (auto threads = 1u;; threads = nThreads) {
+               std::fill(parallel.get(), parallel.get() + outputLen, 0.0f);
+               timer.Start();
+               process(M, blockLen, threads, parallel.get());
+               elapsed = timer.Time();
+               if (threads == 1)
+                  elapsedOne = elapsed;
+               if (!std::equal(scalar.get(), scalar.get() + outputLen,
+                      parallel.get())) {
+                  Printf( XO("Equalization results differ for filter length %d, block %d, %d threads.\n")
+                     .Format( (int)M, (int)blockLen, (int)threads ) );
+                  goto fail;
+               }
+               if (threads == nThreads)
+                  break;
+            }
+            Printf( XO("Filter length %d, block %d: %ld ms scalar, %ld ms on 1 thread, %ld ms on %d threads\n")
+               .Format( (int)M, (int)blockLen, elapsedScalar, elapsedOne,
+                  elapsed, (int)nThreads ) );
+         }
+      }
+   }
+
+   {
+      // Filters as in the Classic Filters effect, one biquad at a time and
+      // all as a cascade, in blocks as effects process them
+      const size_t filterLen = 44100 * 60, filterBlock = 4096;
+      const int order = Biquad::MAX_Order;
+      const size_t nBiquads = (order + 1) / 2;
+      Floats input{ filterLen }, separate{ filterLen }, cascade{ filterLen };
+      for (size_t i = 0; i < filterLen; ++i)
+         input[i] = rand() / (float)RAND_MAX - 0.5f;
+      std::copy(input.get(), input.get() + filterLen, separate.get());
+
+      Printf( XO("Filtering 60 seconds at 44100 Hz with an order %d filter...\n")
+         .Format( order ) );
+      wxTheApp->Yield();
+      FlushPrint();
+
+      auto biquads = Biquad::CalcButterworthFilter(
+         order, 22050, 1000, Biquad::kLowPass);
+      timer.Start();
+      for (size_t i = 0; i < filterLen; i += filterBlock) {
+         const auto len = std::min(filterBlock, filterLen - i);
+         for (size_t k = 0; k < nBiquads; ++k)
+            biquads[k].Process(&separate[i], &separate[i], len);
+      }
+      elapsed = timer.Time();
+      Printf( XO("Time to filter with one biquad at a time: %ld ms\n")
+         .Format( elapsed ) );
+
+      biquads = Biquad::CalcButterworthFilter(
+         order, 22050, 1000, Biquad::kLowPass);
+      timer.Start();
+      for (size_t i = 0; i < filterLen; i += filterBlock) {
+         const auto len = std::min(filterBlock, filterLen - i);
+         Biquad::ProcessCascade(biquads.get(), nBiquads,
+            &input[i], &cascade[i], len);
+      }
+      elapsed = timer.Time();
+      Printf( XO("Time to filter with a cascade of biquads: %ld ms\n")
+         .Format( elapsed ) );
+
+      if (!std::equal(separate.get(), separate.get() + filterLen,
+         cascade.get())) {
+         Printf( XO("Filter results differ.\n") );
+         goto fail;
+      }
+   }
+
+   {
+      // Spectrogram columns for a minute at 44100 Hz and 100 pixels per
+      // second, one transform at a time and in lanes
+      const size_t nColumns = 6000;
+      Printf( XO("Transforming %d spectrogram columns...\n")
+         .Format( (int)nColumns ) );
+      wxTheApp->Yield();
+      FlushPrint();
+
+      for (size_t windowSize = 256; windowSize <= 32768; windowSize *= 4) {
+         const auto hFFT = GetFFT(windowSize);
+         Floats input{ windowSize * FFTLanes },
+            single{ windowSize * FFTLanes }, lanes{ windowSize * FFTLanes };
+         for (size_t i = 0; i < windowSize * FFTLanes; ++i)
+            input[i] = rand() / (float)RAND_MAX - 0.5f;
+
+         timer.Start();
+         for (size_t x = 0; x < nColumns; x += FFTLanes)
+            for (size_t k = 0; k < FFTLanes; ++k) {
+               float *const buffer = &single[windowSize * k];
+               std::copy(&input[windowSize * k],
+                  &input[windowSize * (k + 1)], buffer);
+               RealFFTf(buffer, hFFT.get());
+            }
+         const auto elapsedSingle = timer.Time();
+
+         timer.Start();
+         for (size_t x = 0; x < nColumns; x += FFTLanes) {
+            for (size_t k = 0; k < FFTLanes; ++k)
+               for (size_t i = 0; i < windowSize; ++i)
+                  lanes[FFTLanes * i + k] = input[windowSize * k + i];
+            RealFFTfLanes(lanes.get(), *hFFT);
+         }
+         elapsed = timer.Time();
+         Printf( XO("Window size %d: %ld ms one at a time, %ld ms in lanes\n")
+            .Format( (int)windowSize, elapsedSingle, elapsed ) );
+
+         for (size_t k = 0; k < FFTLanes; ++k)
+            for (size_t i = 0; i < windowSize; ++i)
+               if (lanes[FFTLanes * i + k] != single[windowSize * k + i]) {
+                  Printf( XO("Transform results differ.\n") );
+                  goto fail;
+               }
+      }
+   }
+
+   {
+      // Labels of ten hours of transcription, imported in no order, then
+      // looked up in windows of the timeline by scanning and by the index
+      const int nLabels = 100000, nQueries = 1000;
+      const double length = 36000.0, window = 10.0;
+      Printf( XO("Importing and finding %d labels...\n").Format( nLabels ) );
+      wxTheApp->Yield();
+      FlushPrint();
+
+      wxTextFile file;
+      for (int i = 0; i < nLabels; ++i) {
+         const double t0 = length * rand() / RAND_MAX;
+         const double t1 = t0 + 5.0 * rand() / RAND_MAX;
+         LabelStruct{ SelectedRegion{ t0, t1 },
+            wxString::Format( wxT("Label %d"), i ) }.Export( file );
+      }
+
+      auto labelTrack = std::make_shared<LabelTrack>();
+      timer.Start();
+      labelTrack->Import( file );
+      elapsed = timer.Time();
+      Printf( XO("Time to import %d labels: %ld ms\n")
+         .Format( nLabels, elapsed ) );
+
+      const auto &labels = labelTrack->GetLabels();
+      std::vector<double> starts( nQueries );
+      for (auto &t : starts)
+         t = (length - window) * rand() / RAND_MAX;
+
+      long found = 0;
+      timer.Start();
+      for (auto t : starts)
+         for (const auto &label : labels)
+            if (label.getT0() <= t + window && label.getT1() >= t)
+               ++found;
+      const auto elapsedScan = timer.Time();
+
+      long foundIndexed = 0;
+      timer.Start();
+      for (auto t : starts) {
+         const auto range = labelTrack->FindLabels( t, t + window );
+         for (auto i = range.first; i < range.second; ++i) {
+            const auto &label = labels[i];
+            if (label.getT0() <= t + window && label.getT1() >= t)
+               ++foundIndexed;
+         }
+      }
+      elapsed = timer.Time();
+      Printf( XO("Time to find labels in %d windows: %ld ms scanning, %ld ms indexed\n")
+         .Format( nQueries, elapsedScan, elapsed ) );
+
+      if (found != foundIndexed) {
+         Printf( XO("Label lookups differ.\n") );
+         goto fail;
+      }
+   }
+
+   {
+      // Min-max columns of a screen of tracks, painted a line at a time as
+      // before, and through the raster that WaveformView now uses
+      const int nTracks = 100, width = 1000, height = 150;
+      Printf( XO("Painting waveforms of %d tracks...\n").Format( nTracks ) );
+      wxTheApp->Yield();
+      FlushPrint();
+
+      std::vector<std::pair<int, int>> spans( width );
+      for (auto &span : spans) {
+         span.first = rand() % height;
+         span.second = rand() % height;
+      }
+
+      wxBitmap bitmap{ width, height };
+      wxMemoryDC dc{ bitmap };
+      const wxPen pen{ *wxBLUE };
+
+      timer.Start();
+      for (int i = 0; i < nTracks; ++i) {
+         dc.SetPen( pen );
+         for (int x = 0; x < width; ++x)
+            AColor::Line( dc, x, spans[x].first, x, spans[x].second );
+      }
+      const auto elapsedLines = timer.Time();
+
+      const WaveRaster::Colour colour{ pen };
+      timer.Start();
+      for (int i = 0; i < nTracks; ++i) {
+         WaveRaster raster{ width, height };
+         for (int x = 0; x < width; ++x)
+            raster.Span( x, spans[x].first, spans[x].second, colour );
+         raster.Draw( dc, 0, 0 );
+      }
+      elapsed = timer.Time();
+      Printf( XO("Time to paint %d waveforms: %ld ms by lines, %ld ms by raster\n")
+         .Format( nTracks, elapsedLines, elapsed ) );
+   }
+
+   {
+      // Round trips through a simulated device that returns the output a
+      // buffer later, delayed by a known number of samples more, adding
+      // noise as loud as the test signal in alternate trials; the last trial
+      // records noise only
+      const double rate = 44100;
+      const size_t bufferSize = 512;
+      const size_t delays[] = { 0, 1, 441, 2205, 12345, 30000 };
+      const int nTrials = sizeof(delays) / sizeof(*delays) + 1;
+      Printf( XO("Measuring latency of %d simulated devices...\n")
+         .Format( nTrials ) );
+      wxTheApp->Yield();
+      FlushPrint();
+
+      timer.Start();
+      for (int i = 0; i < nTrials; ++i) {
+         const bool silent = i == nTrials - 1;
+         const auto delay = silent ? 0 : bufferSize + delays[i];
+         const float noise = (silent || i % 2) ? 0.25f : 0.0f;
+
+         LatencyMeasurement measurement{ rate };
+         std::vector<float> played, input( bufferSize ), output( bufferSize );
+         while (!measurement.IsComplete()) {
+            const auto position = played.size();
+            for (size_t j = 0; j < bufferSize; ++j) {
+               const auto pos = position + j;
+               input[j] = noise * (2.0f * rand() / RAND_MAX - 1.0f);
+               if (!silent && pos >= delay)
+                  input[j] += played[pos - delay];
+            }
+            measurement.Process(
+               input.data(), 1, output.data(), 1, bufferSize );
+            played.insert( played.end(), output.begin(), output.end() );
+         }
+
+         const auto estimate = measurement.Estimate();
+         if (silent) {
+            if (estimate) {
+               Printf( XO("Latency of %f s found in noise only.\n")
+                  .Format( *estimate ) );
+               goto fail;
+            }
+         }
+         else if (!estimate || lrint(*estimate * rate) != long(delay)) {
+            Printf( XO("Latency of %d samples with noise %f measured as %f s.\n")
+               .Format( int(delay), noise, estimate ? *estimate : -1.0 ) );
+            goto fail;
+         }
+      }
+      elapsed = timer.Time();
+      Printf( XO("Time to measure latency %d times: %ld ms\n")
+         .Format( nTrials, elapsed ) );
+   }
+
    goto success;
 
  fail:
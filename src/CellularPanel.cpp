@@ -1200,8 +1200,15 @@ std::shared_ptr<TrackPanelCell> CellularPanel::LastCell() const
 }
 
 void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses )
+{
+   Draw( context, nPasses, GetClientRect() );
+}
+
+void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses,
+   const wxRect &area )
 {
    const auto panelRect = GetClientRect();
+   const auto drawRect = panelRect.Intersect( area );
    auto lastCell = LastCell();
    for ( unsigned iPass = 0; iPass < nPasses; ++iPass ) {
 
@@ -1210,7 +1217,7 @@ void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses )
          // Draw the node
          const auto newRect = node.DrawingArea(
             context, rect, panelRect, iPass );
-         if ( newRect.Intersects( panelRect ) )
+         if ( newRect.Intersects( drawRect ) )
             node.Draw( context, newRect, iPass );
 
          // Draw the current handle if it is associated with the node
@@ -1219,7 +1226,7 @@ void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses )
             if ( target ) {
                const auto targetRect =
                   target->DrawingArea( context, rect, panelRect, iPass );
-               if ( targetRect.Intersects( panelRect ) )
+               if ( targetRect.Intersects( drawRect ) )
                   target->Draw( context, targetRect, iPass );
             }
          }
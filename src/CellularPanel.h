@@ -115,6 +115,10 @@ public:
    // and of all groups of cells,
    // repeatedly with a pass count from 0 to nPasses - 1
    void Draw( TrackPanelDrawingContext &context, unsigned nPasses );
+   // The same, but only for drawing areas that intersect area; the caller
+   // should clip the device context to it
+   void Draw( TrackPanelDrawingContext &context, unsigned nPasses,
+      const wxRect &area );
    
 protected:
    bool HasEscape();
@@ -78,7 +78,10 @@ public:
       InsertSampleBlock,
       DeleteSampleBlock,
       GetSampleBlockSize,
-      GetAllSampleBlocksSize
+      GetAllSampleBlocksSize,
+      GetSpectrogramTile,
+      InsertSpectrogramTile,
+      InsertSpectrogramTileBlock
    };
    sqlite3_stmt *Prepare(enum StatementID id, const char *sql);
 
@@ -136,7 +136,13 @@ void LabelTrack::SetLabel( size_t iLabel, const LabelStruct &newLabel )
       wxASSERT( false );
       mLabels.resize( iLabel + 1 );
    }
-   mLabels[ iLabel ] = newLabel;
+   auto &label = mLabels[ iLabel ];
+   const bool retitled = label.title != newLabel.title;
+   label = newLabel;
+   if (retitled)
+      // Measure the text again when next drawn
+      label.widthGeneration = 0;
+   LabelsChanged();
 }
 
 LabelTrack::~LabelTrack()
@@ -147,6 +153,7 @@ void LabelTrack::SetOffset(double dOffset)
 {
    for (auto &labelStruct: mLabels)
       labelStruct.selectedRegion.move(dOffset);
+   LabelsChanged();
 }
 
 void LabelTrack::Clear(double b, double e)
@@ -171,6 +178,7 @@ void LabelTrack::Clear(double b, double e)
       else if (relation == LabelStruct::WITHIN_LABEL)
          labelStruct.selectedRegion.moveT1( - (e-b));
    }
+   LabelsChanged();
 }
 
 #if 0
@@ -209,6 +217,7 @@ void LabelTrack::ShiftLabelsOnInsert(double length, double pt)
       else if (relation == LabelStruct::WITHIN_LABEL)
          labelStruct.selectedRegion.moveT1(length);
    }
+   LabelsChanged();
 }
 
 void LabelTrack::ChangeLabelsOnReverse(double b, double e)
@@ -233,6 +242,7 @@ void LabelTrack::ScaleLabels(double b, double e, double change)
          AdjustTimeStampOnScale(labelStruct.getT0(), b, e, change),
          AdjustTimeStampOnScale(labelStruct.getT1(), b, e, change));
    }
+   LabelsChanged();
 }
 
 double LabelTrack::AdjustTimeStampOnScale(double t, double b, double e, double change)
@@ -563,7 +573,13 @@ void LabelTrack::Import(wxTextFile & in)
    }
    if (error)
       ::AudacityMessageBox( XO("One or more saved labels could not be read.") );
-   SortLabels();
+
+   // Sort all at once, not one disorder at a time as SortLabels does.  All
+   // labels were replaced, so no listener keeps indices to permute.
+   std::stable_sort( mLabels.begin(), mLabels.end(),
+      []( const LabelStruct &a, const LabelStruct &b ){
+         return a.getT0() < b.getT0(); } );
+   LabelsChanged();
 }
 
 bool LabelTrack::HandleXMLTag(const wxChar *tag, const wxChar **attrs)
@@ -605,6 +621,7 @@ bool LabelTrack::HandleXMLTag(const wxChar *tag, const wxChar **attrs)
 
       LabelStruct l { selectedRegion, title };
       mLabels.push_back(l);
+      LabelsChanged();
 
       return true;
    }
@@ -630,6 +647,7 @@ bool LabelTrack::HandleXMLTag(const wxChar *tag, const wxChar **attrs)
             }
             mLabels.clear();
             mLabels.reserve(nValue);
+            LabelsChanged();
          }
       }
 
@@ -745,12 +763,13 @@ Track::Holder LabelTrack::Copy(double t0, double t1, bool) const
 bool LabelTrack::PasteOver(double t, const Track * src)
 {
    auto result = src->TypeSwitch< bool >( [&](const LabelTrack *sl) {
-      int len = mLabels.size();
-      int pos = 0;
-
-      while (pos < len && mLabels[pos].getT0() < t)
-         pos++;
+      // Insert after the labels starting before t, all at once
+      const auto pos = std::lower_bound( mLabels.begin(), mLabels.end(), t,
+         []( const LabelStruct &label, double time ){
+            return label.getT0() < time; } );
 
+      LabelArray pasted;
+      pasted.reserve(sl->mLabels.size());
       for (auto &labelStruct: sl->mLabels) {
          LabelStruct l {
             labelStruct.selectedRegion,
@@ -758,8 +777,10 @@ bool LabelTrack::PasteOver(double t, const Track * src)
             labelStruct.getT1() + t,
             labelStruct.title
          };
-         mLabels.insert(mLabels.begin() + pos++, l);
+         pasted.push_back(l);
       }
+      mLabels.insert(pos, pasted.begin(), pasted.end());
+      LabelsChanged();
 
       return true;
    } );
@@ -836,6 +857,7 @@ bool LabelTrack::Repeat(double t0, double t1, int n)
 
       // Other cases have already been handled by ShiftLabelsOnInsert()
    }
+   LabelsChanged();
 
    return true;
 }
@@ -916,6 +938,7 @@ void LabelTrack::InsertSilence(double t, double len)
          t1 += len;
       labelStruct.selectedRegion.setTimes(t0, t1);
    }
+   LabelsChanged();
 }
 
 int LabelTrack::GetNumLabels() const
@@ -933,13 +956,14 @@ int LabelTrack::AddLabel(const SelectedRegion &selectedRegion,
 {
    LabelStruct l { selectedRegion, title };
 
-   int len = mLabels.size();
-   int pos = 0;
-
-   while (pos < len && mLabels[pos].getT0() < selectedRegion.t0())
-      pos++;
+   // Insert after the labels starting earlier
+   const int pos = std::lower_bound( mLabels.begin(), mLabels.end(),
+      selectedRegion.t0(),
+      []( const LabelStruct &label, double time ){
+         return label.getT0() < time; } ) - mLabels.begin();
 
    mLabels.insert(mLabels.begin() + pos, l);
+   LabelsChanged();
 
    LabelTrackEvent evt{
       EVT_LABELTRACK_ADDITION, SharedPointer<LabelTrack>(), title, -1, pos
@@ -955,6 +979,7 @@ void LabelTrack::DeleteLabel(int index)
    auto iter = mLabels.begin() + index;
    const auto title = iter->title;
    mLabels.erase(iter);
+   LabelsChanged();
 
    LabelTrackEvent evt{
       EVT_LABELTRACK_DELETION, SharedPointer<LabelTrack>(), title, index, -1
@@ -968,6 +993,9 @@ void LabelTrack::DeleteLabel(int index)
 /// sort (with a linear search) is a reasonable choice.
 void LabelTrack::SortLabels()
 {
+   // Callers sort after changing times
+   LabelsChanged();
+
    const auto begin = mLabels.begin();
    const auto nn = (int)mLabels.size();
    int i = 1;
@@ -1001,12 +1029,45 @@ void LabelTrack::SortLabels()
    }
 }
 
+std::pair<size_t, size_t> LabelTrack::FindLabels(double t0, double t1) const
+{
+   const auto nn = mLabels.size();
+   if (mMaxEnds.size() != nn) {
+      mMaxEnds.clear();
+      mMaxEnds.reserve(nn);
+      mSorted = true;
+      double maxEnd = -DBL_MAX;
+      for (size_t ii = 0; ii < nn; ++ii) {
+         const auto &labelStruct = mLabels[ii];
+         if (ii > 0 && labelStruct.getT0() < mLabels[ii - 1].getT0())
+            mSorted = false;
+         maxEnd = std::max(maxEnd, labelStruct.getT1());
+         mMaxEnds.push_back(maxEnd);
+      }
+   }
+   if (!mSorted)
+      return { 0, nn };
+
+   // Skip the leading labels that all end before t0
+   const size_t first =
+      std::lower_bound(mMaxEnds.begin(), mMaxEnds.end(), t0)
+         - mMaxEnds.begin();
+   // Stop at the first label starting after t1
+   const size_t last = std::upper_bound(
+      mLabels.begin() + first, mLabels.end(), t1,
+      []( double time, const LabelStruct &label ){
+         return time < label.getT0(); } ) - mLabels.begin();
+   return { first, last };
+}
+
 wxString LabelTrack::GetTextOfLabels(double t0, double t1) const
 {
    bool firstLabel = true;
    wxString retVal;
 
-   for (auto &labelStruct: mLabels) {
+   const auto range = FindLabels(t0, t1);
+   for (auto ii = range.first; ii < range.second; ++ii) {
+      auto &labelStruct = mLabels[ii];
       if (labelStruct.getT0() >= t0 &&
           labelStruct.getT1() <= t1)
       {
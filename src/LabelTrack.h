@@ -70,6 +70,8 @@ public:
    SelectedRegion selectedRegion;
    wxString title; /// Text of the label.
    mutable int width{}; /// width of the text in pixels.
+   /// Generation of the label font when width was found; zero if never.
+   mutable unsigned widthGeneration{};
 
 // Working storage for on-screen layout.
    mutable int x{};     /// Pixel position of left hand glyph
@@ -129,6 +131,14 @@ public:
    const LabelStruct *GetLabel(int index) const;
    const LabelArray &GetLabels() const { return mLabels; }
 
+   //! Range of indices of labels, including all that overlap t0 ... t1
+   /*!
+    Found in logarithmic time, from an index made again on demand after the
+    labels change.  Labels in the range may still end before t0, and the
+    range is all labels while they are out of order.
+    */
+   std::pair<size_t, size_t> FindLabels(double t0, double t1) const;
+
    void OnLabelAdded( const wxString &title, int pos );
    //This returns the index of the label we just added.
    int AddLabel(const SelectedRegion &region, const wxString &title);
@@ -172,8 +182,17 @@ public:
  private:
    TrackKind GetKind() const override { return TrackKind::Label; }
 
+   //! Discard the index of labels after they change
+   void LabelsChanged() { mMaxEnds.clear(); }
+
    LabelArray mLabels;
 
+   //! Latest end time of the labels up to and including each, or empty when
+   //! not found since the labels changed
+   mutable std::vector<double> mMaxEnds;
+   //! Whether the labels were in order of start time when mMaxEnds was found
+   mutable bool mSorted{ true };
+
    // Set in copied label tracks
    double mClipLen;
 
@@ -0,0 +1,195 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LatencyMeasurement.cpp
+
+*******************************************************************//**
+
+\class LatencyMeasurement
+\brief Plays a burst of pseudo-random noise and finds it again in the
+recording, by cross-correlation computed with RealFFTf.
+
+The result is kept in preferences for each combination of host, playback
+and recording device, so that it can replace the fixed latency
+compensation when recording.
+
+*//*******************************************************************/
+
+#include "LatencyMeasurement.h"
+
+#include <algorithm>
+#include <cmath>
+#include <wx/crt.h>
+
+#include "AudioIOBase.h"
+#include "RealFFTf.h"
+
+namespace {
+
+//! Duration of the noise burst in seconds
+constexpr double SignalDuration = 0.5;
+//! Level of the noise burst, well below full scale
+constexpr float SignalLevel = 0.25f;
+//! Duration of the fades at each end of the burst in seconds
+constexpr double FadeDuration = 0.005;
+//! How much the correlation peak must stand above its RMS
+constexpr double MinimumProminence = 8.0;
+
+wxString DevicePairKey()
+{
+   wxString key = AudioIOHost.Read()
+      + wxT("_") + AudioIOPlaybackDevice.Read()
+      + wxT("_") + AudioIORecordingDevice.Read();
+   for (size_t ii = 0; ii < key.length(); ++ii)
+      if (!wxIsalnum(key[ii]))
+         key[ii] = wxT('_');
+   return wxT("/AudioIO/MeasuredLatency/") + key;
+}
+
+}
+
+BoolSetting AudioIOUseMeasuredLatency{
+   L"/AudioIO/UseMeasuredLatency", true };
+
+LatencyMeasurement::LatencyMeasurement(double rate, double maxLatency)
+   : mRate{ rate }
+{
+   const auto signalLength = static_cast<size_t>(lrint(rate * SignalDuration));
+   const auto fadeLength = std::max<size_t>(1, lrint(rate * FadeDuration));
+   mSignal.resize(signalLength);
+
+   // A fixed seed makes every measurement use the same signal
+   unsigned int seed = 1;
+   for (size_t ii = 0; ii < signalLength; ++ii) {
+      seed = seed * 1103515245u + 12345u;
+      auto value = ((seed >> 8) & 0xffff) / 32768.0f - 1.0f;
+      if (ii < fadeLength)
+         value *= float(ii) / fadeLength;
+      else if (signalLength - ii < fadeLength)
+         value *= float(signalLength - ii) / fadeLength;
+      mSignal[ii] = SignalLevel * value;
+   }
+
+   mCaptured.resize(
+      signalLength + static_cast<size_t>(lrint(rate * maxLatency)));
+}
+
+LatencyMeasurement::~LatencyMeasurement() = default;
+
+void LatencyMeasurement::Process(const float *input, unsigned inputChannels,
+   float *output, unsigned outputChannels, size_t frames)
+{
+   const auto position = mPosition.load(std::memory_order_relaxed);
+   const auto signalLength = mSignal.size();
+   const auto capturedLength = mCaptured.size();
+
+   for (size_t ii = 0; ii < frames; ++ii) {
+      const auto pos = position + ii;
+      if (output) {
+         const auto value = pos < signalLength ? mSignal[pos] : 0.0f;
+         for (unsigned cc = 0; cc < outputChannels; ++cc)
+            output[outputChannels * ii + cc] = value;
+      }
+      if (input && pos < capturedLength)
+         mCaptured[pos] = input[inputChannels * ii];
+   }
+
+   mPosition.store(std::min(capturedLength, position + frames),
+      std::memory_order_release);
+}
+
+bool LatencyMeasurement::IsComplete() const
+{
+   return mPosition.load(std::memory_order_acquire) >= mCaptured.size();
+}
+
+double LatencyMeasurement::GetDuration() const
+{
+   return mCaptured.size() / mRate;
+}
+
+std::optional<double> LatencyMeasurement::Estimate() const
+{
+   if (!IsComplete())
+      return {};
+   const auto lag = FindLag(
+      mSignal.data(), mSignal.size(), mCaptured.data(), mCaptured.size());
+   if (!lag)
+      return {};
+   return *lag / mRate;
+}
+
+std::optional<size_t> LatencyMeasurement::FindLag(
+   const float *reference, size_t referenceLength,
+   const float *captured, size_t capturedLength)
+{
+   if (referenceLength == 0 || capturedLength < referenceLength)
+      return {};
+
+   // Zero-pad to a power of two long enough that the circular correlation
+   // does not wrap around
+   size_t length = 2;
+   while (length < capturedLength + referenceLength)
+      length *= 2;
+
+   auto hFFT = GetFFT(length);
+   std::vector<float> ref(length, 0.0f), cap(length, 0.0f), product(length);
+   std::copy(reference, reference + referenceLength, ref.begin());
+   std::copy(captured, captured + capturedLength, cap.begin());
+   RealFFTf(ref.data(), hFFT.get());
+   RealFFTf(cap.data(), hFFT.get());
+
+   // Multiply the captured spectrum by the conjugate of the reference
+   // DC and Fs/2 components are purely real
+   product[0] = cap[0] * ref[0];
+   product[1] = cap[1] * ref[1];
+   for (size_t ii = 1; ii < length / 2; ++ii) {
+      const auto index = hFFT->BitReversed[ii];
+      const auto cr = cap[index], ci = cap[index + 1];
+      const auto rr = ref[index], ri = ref[index + 1];
+      product[2 * ii    ] = cr * rr + ci * ri;
+      product[2 * ii + 1] = ci * rr - cr * ri;
+   }
+
+   InverseRealFFTf(product.data(), hFFT.get());
+   std::vector<float> correlation(length);
+   ReorderToTime(hFFT.get(), product.data(), correlation.data());
+
+   // Search only lags at which all of the reference was captured.
+   // Take absolute values, because the round trip might invert polarity.
+   const auto nLags = capturedLength - referenceLength + 1;
+   size_t best = 0;
+   double peak = 0, sumSquares = 0;
+   for (size_t ii = 0; ii < nLags; ++ii) {
+      const double value = fabs(correlation[ii]);
+      sumSquares += value * value;
+      if (value > peak)
+         peak = value, best = ii;
+   }
+
+   const auto rms = sqrt(sumSquares / nLags);
+   if (peak == 0 || peak < MinimumProminence * rms)
+      return {};
+   return best;
+}
+
+std::optional<double> LatencyMeasurement::Lookup()
+{
+   double milliseconds;
+   if (gPrefs->Read(DevicePairKey(), &milliseconds))
+      return milliseconds;
+   return {};
+}
+
+void LatencyMeasurement::Store(double milliseconds)
+{
+   gPrefs->Write(DevicePairKey(), milliseconds);
+   gPrefs->Flush();
+}
+
+void LatencyMeasurement::Forget()
+{
+   gPrefs->DeleteEntry(DevicePairKey());
+   gPrefs->Flush();
+}
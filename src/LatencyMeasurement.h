@@ -0,0 +1,85 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LatencyMeasurement.h
+
+  Measure the round-trip latency of a pair of audio devices, by playing
+  a known test signal and cross-correlating what is recorded back.
+
+**********************************************************************/
+
+#ifndef __AUDACITY_LATENCY_MEASUREMENT__
+#define __AUDACITY_LATENCY_MEASUREMENT__
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+#include "Prefs.h"
+
+//! Produces a test signal and collects the recorded return, for one measurement
+/*!
+ Process() does no allocation and no locking, so it may be called from the
+ PortAudio callback.  It knows nothing about devices, so a measurement may
+ also be run offline, by feeding back the output with a known delay, as a
+ simulated device would.
+ */
+class AUDACITY_DLL_API LatencyMeasurement final
+{
+public:
+   /*!
+    @param rate of the stream
+    @param maxLatency longest round trip (in seconds) that can be detected
+    */
+   LatencyMeasurement(double rate, double maxLatency = 1.0);
+   ~LatencyMeasurement();
+
+   //! Exchange one buffer of samples with the devices
+   /*!
+    @param input interleaved float samples recorded, or null
+    @param inputChannels channels in input; only the first is analysed
+    @param output interleaved float samples to be played, which are all
+       overwritten
+    @param outputChannels channels in output; all receive the test signal
+    */
+   void Process(const float *input, unsigned inputChannels,
+      float *output, unsigned outputChannels, size_t frames);
+
+   //! Whether enough has been recorded to call Estimate()
+   bool IsComplete() const;
+
+   //! Total duration of the measurement in seconds
+   double GetDuration() const;
+
+   //! Round trip latency in seconds, or nullopt if the test signal was not
+   //! clearly found in the recording
+   std::optional<double> Estimate() const;
+
+   //! Find the lag of reference within captured, by FFT cross-correlation
+   /*!
+    @return lag in samples, or nullopt if the correlation peak is not
+    sufficiently prominent
+    */
+   static std::optional<size_t> FindLag(
+      const float *reference, size_t referenceLength,
+      const float *captured, size_t capturedLength);
+
+   //! Latency in milliseconds measured for the selected host and devices
+   static std::optional<double> Lookup();
+   //! Store latency in milliseconds for the selected host and devices
+   static void Store(double milliseconds);
+   //! Forget the latency for the selected host and devices
+   static void Forget();
+
+private:
+   const double mRate;
+   std::vector<float> mSignal;
+   std::vector<float> mCaptured;
+   std::atomic<size_t> mPosition{ 0 };
+};
+
+//! Whether a stored measurement overrides the fixed latency compensation
+extern AUDACITY_DLL_API BoolSetting AudioIOUseMeasuredLatency;
+
+#endif
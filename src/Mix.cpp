@@ -24,6 +24,7 @@
 
 #include "Mix.h"
 
+#include <algorithm>
 #include <math.h>
 
 #include <wx/textctrl.h>
@@ -234,6 +235,217 @@ Mixer::WarpOptions::WarpOptions(double min, double max)
    }
 }
 
+//! Passes the output of a track from a constant rate resampler to a variable
+//! rate one without a break, when the ratio starts to vary
+/*!
+ Flushing the constant rate resampler pads its input with zeros, and a new
+ resampler starts from silence, so the output would fade out and in.
+ Instead the new resampler is first given input that the old one has already
+ consumed, and is lined up with the latest output of the old one.  Both then
+ take the same input at the old ratio, until the output of the old one has
+ been crossfaded into that of the new one.
+ */
+struct Mixer::Handover
+{
+   //! Input kept, several filter lengths of soxr's variable rate mode
+   static constexpr size_t HistoryLength = 4096;
+   //! Output kept, to line up the new resampler with
+   static constexpr size_t RecentLength = 1024;
+   //! Least output compared when lining up
+   static constexpr long MinOverlap = 64;
+   //! Most output samples by which the new resampler may be moved
+   static constexpr long MaxLag = 16;
+   static constexpr size_t FadeLength = 512;
+
+   //! Whether the old resampler still runs
+   bool Active() const { return pOld != nullptr; }
+
+   //! Keep what the constant rate resampler consumed and produced
+   void Consumed(const float *input, size_t used,
+      const float *output, size_t produced);
+   //! Bring the new resampler to the state of the old one
+   void Start(std::unique_ptr<Resample> pOldResample,
+      Resample &replacement, double oldFactor);
+   //! Resample by both resamplers at the old ratio, as Resample::Process()
+   std::pair<size_t, size_t> Process(float *input, size_t len, bool last,
+      float *buffer, size_t bufferLen);
+   //! Copy out output made already, crossfading while the old resampler runs
+   size_t Drain(float *buffer, size_t len);
+
+   //! Ratio of the old resampler
+   double factor{ 0 };
+   std::unique_ptr<Resample> pOld;
+   Resample *pNew{};
+
+   std::vector<float> history;
+   std::vector<float> recent;
+   size_t nConsumed{ 0 };
+   size_t nProduced{ 0 };
+
+   //! Output of each resampler not yet copied out; both start at the same
+   //! time
+   std::vector<float> oldOutput, newOutput;
+   //! Output of the new resampler still to be dropped
+   size_t skip{ 0 };
+   size_t faded{ 0 };
+   std::vector<float> scratch;
+
+private:
+   void Feed(float *input, size_t len);
+};
+
+namespace {
+//! Copy into a ring buffer, at position in the whole stream
+void CopyToRing(std::vector<float> &ring, size_t position,
+   const float *src, size_t len)
+{
+   const auto size = ring.size();
+   if (len > size) {
+      src += len - size;
+      position += len - size;
+      len = size;
+   }
+   const auto offset = position % size;
+   const auto first = std::min(len, size - offset);
+   std::copy(src, src + first, ring.begin() + offset);
+   std::copy(src + first, src + len, ring.begin());
+}
+}
+
+void Mixer::Handover::Consumed(const float *input, size_t used,
+   const float *output, size_t produced)
+{
+   if (history.empty()) {
+      history.resize(HistoryLength);
+      recent.resize(RecentLength);
+   }
+   CopyToRing(history, nConsumed, input, used);
+   CopyToRing(recent, nProduced, output, produced);
+   nConsumed += used;
+   nProduced += produced;
+}
+
+void Mixer::Handover::Start(std::unique_ptr<Resample> pOldResample,
+   Resample &replacement, double oldFactor)
+{
+   factor = oldFactor;
+   pOld = std::move(pOldResample);
+   pNew = &replacement;
+   scratch.resize(HistoryLength * std::max(1.0, oldFactor) + RecentLength);
+
+   // Start from an input sample that falls on an output sample of the old
+   // resampler, or nearly
+   size_t start = 0;
+   if (nConsumed > HistoryLength) {
+      double best = 1;
+      for (auto ii = nConsumed - HistoryLength;
+           ii < nConsumed - HistoryLength / 2; ++ii) {
+         const auto where = ii * oldFactor;
+         const auto offset = fabs(where - floor(where + 0.5));
+         if (offset < best)
+            best = offset, start = ii;
+      }
+   }
+   std::vector<float> input(nConsumed - start);
+   for (size_t ii = 0; ii < input.size(); ++ii)
+      input[ii] = history[(start + ii) % HistoryLength];
+   newOutput.clear();
+   skip = 0;
+   Feed(input.data(), input.size());
+
+   // Drop what the old resampler produced already.  The variable rate
+   // resampler lags a little, by an amount that depends on the ratios, so
+   // find where its output best matches the latest of the old one.
+   const long nominal = long(nProduced) - lrint(start * oldFactor);
+   const long nRecent = long(std::min(nProduced, RecentLength));
+   long lag = nominal;
+   double leastError = -1;
+   for (long step = 0; step <= 2 * MaxLag; ++step) {
+      const auto trial = nominal + ((step % 2) ? -(step + 1) / 2 : step / 2);
+      const auto begin = std::max(0L, trial - nRecent);
+      const auto end = std::min(trial, long(newOutput.size()));
+      if (end - begin < MinOverlap)
+         continue;
+      double error = 0;
+      for (auto ii = begin; ii < end; ++ii) {
+         const double difference = newOutput[ii] -
+            recent[(nProduced - (trial - ii)) % RecentLength];
+         error += difference * difference;
+      }
+      error /= end - begin;
+      if (leastError < 0 || error < leastError)
+         leastError = error, lag = trial;
+   }
+   skip = std::max(0L, lag);
+   const auto dropped = std::min(skip, newOutput.size());
+   newOutput.erase(newOutput.begin(), newOutput.begin() + dropped);
+   skip -= dropped;
+
+   oldOutput.clear();
+   faded = 0;
+   history = {};
+   recent = {};
+   nConsumed = nProduced = 0;
+}
+
+void Mixer::Handover::Feed(float *input, size_t len)
+{
+   for (size_t used = 0; used < len;) {
+      const auto results = pNew->Process(factor,
+         input + used, len - used, false, scratch.data(), scratch.size());
+      if (results.first == 0 && results.second == 0)
+         break;
+      used += results.first;
+      const auto dropped = std::min(skip, results.second);
+      skip -= dropped;
+      newOutput.insert(newOutput.end(),
+         scratch.begin() + dropped, scratch.begin() + results.second);
+   }
+}
+
+std::pair<size_t, size_t> Mixer::Handover::Process(
+   float *input, size_t len, bool last, float *buffer, size_t bufferLen)
+{
+   // The old resampler takes as much input as it would have alone
+   const auto results = pOld->Process(
+      factor, input, len, last, scratch.data(), scratch.size());
+   oldOutput.insert(oldOutput.end(),
+      scratch.begin(), scratch.begin() + results.second);
+   Feed(input, results.first);
+   if (last) {
+      // Nothing follows to fade into
+      newOutput = std::move(oldOutput);
+      oldOutput = {};
+      pOld.reset();
+   }
+   return { results.first, Drain(buffer, bufferLen) };
+}
+
+size_t Mixer::Handover::Drain(float *buffer, size_t len)
+{
+   size_t count = 0;
+   if (pOld) {
+      // Crossfade where both resamplers have output
+      const auto most = std::min({ len, oldOutput.size(), newOutput.size() });
+      for (; count < most && faded < FadeLength; ++count, ++faded) {
+         const auto weight = float(FadeLength - faded) / (FadeLength + 1);
+         buffer[count] =
+            weight * oldOutput[count] + (1 - weight) * newOutput[count];
+      }
+      oldOutput.erase(oldOutput.begin(), oldOutput.begin() + count);
+      newOutput.erase(newOutput.begin(), newOutput.begin() + count);
+      if (faded < FadeLength)
+         return count;
+      pOld.reset();
+      oldOutput = {};
+   }
+
+   const auto rest = std::min(len - count, newOutput.size());
+   std::copy(newOutput.begin(), newOutput.begin() + rest, buffer + count);
+   newOutput.erase(newOutput.begin(), newOutput.begin() + rest);
+   return count + rest;
+}
+
 Mixer::Mixer(const WaveTrackConstArray &inputTracks,
              bool mayThrow,
              const WarpOptions &warpOptions,
@@ -270,6 +482,20 @@ Mixer::Mixer(const WaveTrackConstArray &inputTracks,
       mSamplePos[i] = inputTracks[i]->TimeToLongSamples(startTime);
    }
    mEnvelope = warpOptions.envelope;
+   mConstantWarp = 0;
+   mRatioVaried = false;
+   if (mEnvelope) {
+      // A time track that was never edited does not really vary the rate
+      const auto nPoints = mEnvelope->GetNumberOfPoints();
+      const auto value = nPoints > 0
+         ? (*mEnvelope)[0].GetVal()
+         : mEnvelope->GetValue(startTime);
+      bool constant = value > 0;
+      for (size_t i = 1; constant && i < nPoints; ++i)
+         constant = ((*mEnvelope)[i].GetVal() == value);
+      if (constant)
+         mConstantWarp = value;
+   }
    mT0 = startTime;
    mT1 = stopTime;
    mTime = startTime;
@@ -292,9 +518,11 @@ Mixer::Mixer(const WaveTrackConstArray &inputTracks,
    }
 
    mBuffer.reinit(mNumBuffers);
+   mBufferPointers.resize(mNumBuffers);
    mTemp.reinit(mNumBuffers);
    for (unsigned int c = 0; c < mNumBuffers; c++) {
       mBuffer[c].Allocate(mInterleavedBufferSize, mFormat);
+      mBufferPointers[c] = mBuffer[c].ptr();
       mTemp[c].reinit(mInterleavedBufferSize);
    }
    // PRL:  Bug2536: see other comments below
@@ -311,6 +539,8 @@ Mixer::Mixer(const WaveTrackConstArray &inputTracks,
    // For each queue, the number of available samples after the queue start.
    mQueueLen.reinit(mNumInputTracks);
    mResample.reinit(mNumInputTracks);
+   mResampleFactor.resize(mNumInputTracks);
+   mHandovers.resize(mNumInputTracks);
    mMinFactor.resize(mNumInputTracks);
    mMaxFactor.resize(mNumInputTracks);
    for (size_t i = 0; i<mNumInputTracks; i++) {
@@ -349,8 +579,42 @@ Mixer::~Mixer()
 
 void Mixer::MakeResamplers()
 {
-   for (size_t i = 0; i < mNumInputTracks; i++)
-      mResample[i] = std::make_unique<Resample>(mHighQuality, mMinFactor[i], mMaxFactor[i]);
+   // They are made on demand by GetResampler(), when the ratio is known
+   for (size_t i = 0; i < mNumInputTracks; i++) {
+      mResample[i].reset();
+      mResampleFactor[i] = 0;
+      mHandovers[i] = {};
+   }
+}
+
+Resample &Mixer::GetResampler(size_t iTrack, double factor)
+{
+   auto &pResample = mResample[iTrack];
+   auto &resampleFactor = mResampleFactor[iTrack];
+   if (pResample && (resampleFactor == 0 || resampleFactor == factor))
+      return *pResample;
+
+   std::unique_ptr<Resample> pOld;
+   if (pResample) {
+      // The ratio changed
+      pOld = std::move(pResample);
+      mRatioVaried = true;
+   }
+
+   const bool constant = !mbVariableRates ||
+      (!mRatioVaried && (!mEnvelope || mConstantWarp > 0));
+   if (constant) {
+      pResample = std::make_unique<Resample>(mHighQuality, factor, factor);
+      resampleFactor = factor;
+   }
+   else {
+      pResample = std::make_unique<Resample>(
+         mHighQuality, mMinFactor[iTrack], mMaxFactor[iTrack]);
+      if (pOld)
+         mHandovers[iTrack].Start(std::move(pOld), *pResample, resampleFactor);
+      resampleFactor = 0;
+   }
+   return *pResample;
 }
 
 void Mixer::Clear()
@@ -410,7 +674,7 @@ double ComputeWarpFactor(const Envelope &env, double t0, double t1)
 size_t Mixer::MixVariableRates(int *channelFlags, WaveTrackCache &cache,
                                     sampleCount *pos, float *queue,
                                     int *queueStart, int *queueLen,
-                                    Resample * pResample)
+                                    size_t iTrack)
 {
    const WaveTrack *const track = cache.GetTrack().get();
    const double trackRate = track->GetRate();
@@ -502,7 +766,9 @@ size_t Mixer::MixVariableRates(int *channelFlags, WaveTrackCache &cache,
       }
 
       double factor = initialWarp;
-      if (mEnvelope)
+      if (mConstantWarp > 0)
+         factor /= mConstantWarp;
+      else if (mEnvelope)
       {
          //TODO-MB: The end time is wrong when the resampler doesn't use all input samples,
          //         as a result of this the warp factor may be slightly wrong, so AudioIO will stop too soon
@@ -517,21 +783,36 @@ size_t Mixer::MixVariableRates(int *channelFlags, WaveTrackCache &cache,
                t, t + (double)thisProcessLen / trackRate);
       }
 
-      auto results = pResample->Process(factor,
-         &queue[*queueStart],
-         thisProcessLen,
-         last,
-         // PRL:  Bug2536: crash in soxr happened on Mac, sometimes, when
-         // mMaxOut - out == 1 and &mFloatBuffer[out + 1] was an unmapped
-         // address, because soxr, strangely, fetched an 8-byte (misaligned!)
-         // value from &mFloatBuffer[out], but did nothing with it anyway,
-         // in soxr_output_no_callback.
-         // Now we make the bug go away by allocating a little more space in
-         // the buffer than we need.
-         &mFloatBuffer[out],
-         mMaxOut - out);
+      auto &resample = GetResampler(iTrack, factor);
+      auto &handover = mHandovers[iTrack];
+      // Output left from the replacement of a resampler comes first
+      out += handover.Drain(&mFloatBuffer[out], mMaxOut - out);
+      if (out >= mMaxOut)
+         break;
+
+      // While the old resampler is faded out, it runs beside the new one
+      auto results = handover.Active()
+         ? handover.Process(&queue[*queueStart], thisProcessLen, last,
+            &mFloatBuffer[out], mMaxOut - out)
+         : resample.Process(factor,
+            &queue[*queueStart],
+            thisProcessLen,
+            last,
+            // PRL:  Bug2536: crash in soxr happened on Mac, sometimes, when
+            // mMaxOut - out == 1 and &mFloatBuffer[out + 1] was an unmapped
+            // address, because soxr, strangely, fetched an 8-byte
+            // (misaligned!) value from &mFloatBuffer[out], but did nothing
+            // with it anyway, in soxr_output_no_callback.
+            // Now we make the bug go away by allocating a little more space
+            // in the buffer than we need.
+            &mFloatBuffer[out],
+            mMaxOut - out);
 
       const auto input_used = results.first;
+      if (mbVariableRates && mResampleFactor[iTrack] > 0)
+         // Keep what a variable rate resampler would need to take over
+         handover.Consumed(&queue[*queueStart], input_used,
+            &mFloatBuffer[out], results.second);
       *queueStart += input_used;
       *queueLen -= input_used;
       out += results.second;
@@ -626,6 +907,13 @@ size_t Mixer::MixSameRate(int *channelFlags, WaveTrackCache &cache,
 
 size_t Mixer::Process(size_t maxToProcess)
 {
+   return Process(maxToProcess, mBufferPointers.data());
+}
+
+size_t Mixer::Process(size_t maxToProcess, const samplePtr *buffers)
+{
+   wxASSERT(maxToProcess <= mBufferSize);
+
    // MB: this is wrong! mT represented warped time, and mTime is too inaccurate to use
    // it here. It's also unnecessary I think.
    //if (mT >= mT1)
@@ -669,7 +957,7 @@ size_t Mixer::Process(size_t maxToProcess)
          maxOut = std::max(maxOut,
             MixVariableRates(channelFlags.get(), mInputTrack[i],
                &mSamplePos[i], mSampleQueue[i].get(),
-               &mQueueStart[i], &mQueueLen[i], mResample[i].get()));
+               &mQueueStart[i], &mQueueLen[i], i));
       else
          maxOut = std::max(maxOut,
             MixSameRate(channelFlags.get(), mInputTrack[i], &mSamplePos[i]));
@@ -686,7 +974,7 @@ size_t Mixer::Process(size_t maxToProcess)
       for(size_t c=0; c<mNumChannels; c++) {
          CopySamples((constSamplePtr)(mTemp[0].get() + c),
             floatSample,
-            mBuffer[0].ptr() + (c * SAMPLE_SIZE(mFormat)),
+            buffers[0] + (c * SAMPLE_SIZE(mFormat)),
             mFormat,
             maxOut,
             mHighQuality ? gHighQualityDither : gLowQualityDither,
@@ -698,7 +986,7 @@ size_t Mixer::Process(size_t maxToProcess)
       for(size_t c=0; c<mNumBuffers; c++) {
          CopySamples((constSamplePtr)mTemp[c].get(),
             floatSample,
-            mBuffer[c].ptr(),
+            buffers[c],
             mFormat,
             maxOut,
             mHighQuality ? gHighQualityDither : gLowQualityDither);
@@ -805,6 +1093,15 @@ void Mixer::SetSpeedForKeyboardScrubbing(double speed, double startTime)
    mSpeed = fabs(speed);
 }
 
+void Mixer::ReplaceInputTracks(const WaveTrackConstArray &inputTracks)
+{
+   wxASSERT(inputTracks.size() == mNumInputTracks);
+   // Positions and queued samples stay as they were; only the caches
+   // are reset
+   for (size_t i = 0; i < mNumInputTracks; i++)
+      mInputTrack[i].SetTrack(inputTracks[i]);
+}
+
 MixerSpec::MixerSpec( unsigned numTracks, unsigned maxNumChannels )
 {
    mNumTracks = mNumChannels = numTracks;
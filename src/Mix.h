@@ -119,6 +119,13 @@ class AUDACITY_DLL_API Mixer {
    /// more samples that must be processed.
    size_t Process(size_t maxSamples);
 
+   /// As above, but put the samples directly into the given buffers instead,
+   /// so that GetBuffer() need not be copied.  There is one buffer if the
+   /// output is interleaved, else one for each channel.  Each has room for
+   /// 'maxSamples' samples (of each channel) in the output format, and
+   /// 'maxSamples' is no more than the buffer size given to the constructor.
+   size_t Process(size_t maxSamples, const samplePtr *buffers);
+
    /// Restart processing at beginning of buffer next time
    /// Process() is called.
    void Restart();
@@ -133,6 +140,11 @@ class AUDACITY_DLL_API Mixer {
    void SetSpeedForPlayAtSpeed(double speed);
    void SetSpeedForKeyboardScrubbing(double speed, double startTime);
 
+   //! Continue from the same position with other input tracks, such as
+   //! copies of the previous ones to which more samples were appended
+   /*! There must be as many as before, with the same rates */
+   void ReplaceInputTracks(const WaveTrackConstArray &inputTracks);
+
    /// Current time in seconds (unwarped, i.e. always between startTime and stopTime)
    /// This value is not accurate, it's useful for progress bars and indicators, but nothing else.
    double MixGetCurrentTime();
@@ -152,10 +164,21 @@ class AUDACITY_DLL_API Mixer {
    size_t MixVariableRates(int *channelFlags, WaveTrackCache &cache,
                                 sampleCount *pos, float *queue,
                                 int *queueStart, int *queueLen,
-                                Resample * pResample);
+                                size_t iTrack);
 
    void MakeResamplers();
 
+   //! Get the resampler for a track, making it if needed
+   /*!
+    A constant rate resampler is made whenever the ratio is not expected to
+    vary, which is much cheaper than soxr's variable rate mode.  If the ratio
+    changes after all, a variable rate resampler takes over, by way of a
+    Handover.
+    */
+   Resample &GetResampler(size_t iTrack, double factor);
+
+   struct Handover;
+
  private:
 
     // Input
@@ -170,6 +193,14 @@ class AUDACITY_DLL_API Mixer {
    double           mT1; // Stop time (none if mT0==mT1)
    double           mTime;  // Current time (renamed from mT to mTime for consistency with AudioIO - mT represented warped time there)
    ArrayOf<std::unique_ptr<Resample>> mResample;
+   // For each track, the ratio of mResample if it is constant rate, else 0
+   std::vector<double> mResampleFactor;
+   std::vector<Handover> mHandovers;
+   // Value of mEnvelope if it is the same at all times, else 0
+   double           mConstantWarp;
+   // Whether the ratio was seen to change while mixing; if so, variable rate
+   // resamplers are made from then on
+   bool             mRatioVaried;
    const size_t     mQueueMaxLen;
    FloatBuffers     mSampleQueue;
    ArrayOf<int>     mQueueStart;
@@ -187,6 +218,7 @@ class AUDACITY_DLL_API Mixer {
    const sampleFormat mFormat;
    bool             mInterleaved;
    ArrayOf<SampleBuffer> mBuffer;
+   std::vector<samplePtr> mBufferPointers;
    ArrayOf<Floats>  mTemp;
    Floats           mFloatBuffer;
    const double     mRate;
@@ -28,6 +28,7 @@
 #if defined(USE_MIDI)
 #include "../lib-src/header-substitutes/allegro.h"
 
+#include <algorithm>
 #include <sstream>
 
 #define ROUND(x) ((int) ((x) + 0.5))
@@ -164,6 +165,92 @@ Alg_seq &NoteTrack::GetSeq() const
    return *mSeq;
 }
 
+//! Notes of the sequence, by pitch
+struct NoteTrack::NoteIndex
+{
+   struct Entry
+   {
+      //! Seconds from the start of the sequence
+      double start, end;
+      //! Place of the note among the events of the sequence
+      size_t order;
+      Alg_note *note;
+   };
+   struct Bucket
+   {
+      //! In order of start
+      std::vector<Entry> entries;
+      //! Latest end of the entries up to and including each
+      std::vector<double> maxEnds;
+   };
+
+   explicit NoteIndex(Alg_seq &seq);
+
+   //! Detects a sequence made at the address of a destroyed one
+   const Alg_seq *const pSeq;
+   Bucket buckets[MaxPitch - MinPitch + 1];
+};
+
+NoteTrack::NoteIndex::NoteIndex(Alg_seq &seq)
+   : pSeq{ &seq }
+{
+   seq.convert_to_seconds();
+   // The iterator gives events in order of time
+   Alg_iterator iter(&seq, false);
+   iter.begin();
+   Alg_event_ptr event;
+   for (size_t order = 0; 0 != (event = iter.next()); ++order) {
+      if (!event->is_note())
+         continue;
+      const auto note = static_cast<Alg_note_ptr>(event);
+      const auto pitch =
+         std::clamp<int>(ROUND(note->pitch), MinPitch, MaxPitch);
+      auto &bucket = buckets[pitch - MinPitch];
+      const auto end = note->time + note->dur;
+      bucket.maxEnds.push_back(bucket.maxEnds.empty()
+         ? end : std::max(end, bucket.maxEnds.back()));
+      bucket.entries.push_back({ note->time, end, order, note });
+   }
+   iter.end();
+}
+
+std::vector<Alg_note*> NoteTrack::FindNotes(double t0, double t1,
+   int bottomPitch, int topPitch) const
+{
+   auto &seq = GetSeq();
+   if (!mNoteIndex || mNoteIndex->pSeq != &seq)
+      mNoteIndex = std::make_unique<NoteIndex>(seq);
+
+   const auto offset = GetOffset();
+   t0 -= offset;
+   t1 -= offset;
+   bottomPitch = std::max<int>(bottomPitch, MinPitch);
+   topPitch = std::min<int>(topPitch, MaxPitch);
+
+   std::vector<const NoteIndex::Entry*> found;
+   for (auto pitch = bottomPitch; pitch <= topPitch; ++pitch) {
+      const auto &bucket = mNoteIndex->buckets[pitch - MinPitch];
+      const auto &entries = bucket.entries;
+      const auto &maxEnds = bucket.maxEnds;
+      // Skip the leading entries that all end by t0
+      auto ii = std::upper_bound(maxEnds.begin(), maxEnds.end(), t0)
+         - maxEnds.begin();
+      for (const auto nn = entries.size();
+           ii < nn && entries[ii].start < t1; ++ii)
+         if (entries[ii].end > t0)
+            found.push_back(&entries[ii]);
+   }
+
+   std::sort(found.begin(), found.end(),
+      [](auto pEntry1, auto pEntry2){
+         return pEntry1->order < pEntry2->order; });
+   std::vector<Alg_note*> result;
+   result.reserve(found.size());
+   for (auto pEntry : found)
+      result.push_back(pEntry->note);
+   return result;
+}
+
 Track::Holder NoteTrack::Clone() const
 {
    auto duplicate = std::make_shared<NoteTrack>();
@@ -254,6 +341,7 @@ void NoteTrack::WarpAndTransposeNotes(double t0, double t1,
    }
    // about to redisplay, so might as well convert back to time now
    seq.convert_to_seconds();
+   NotesChanged();
 }
 
 // Draws the midi channel toggle buttons within the given rect.
@@ -386,6 +474,7 @@ bool NoteTrack::LabelClick(const wxRect &rect, int mx, int my, bool right)
 void NoteTrack::SetSequence(std::unique_ptr<Alg_seq> &&seq)
 {
    mSeq = std::move(seq);
+   NotesChanged();
 }
 
 void NoteTrack::PrintSequence()
@@ -464,6 +553,7 @@ Track::Holder NoteTrack::Cut(double t0, double t1)
    auto &seq = GetSeq();
    seq.convert_to_seconds();
    newTrack->mSeq.reset(seq.cut(t0 - GetOffset(), len, false));
+   NotesChanged();
    newTrack->SetOffset(0);
 
    // Not needed
@@ -514,6 +604,7 @@ bool NoteTrack::Trim(double t0, double t1)
    seq.clear(t1 - GetOffset(), seq.get_dur() + 10000.0, false);
    // Now that stuff beyond selection is cleared, clear before selection:
    seq.clear(0.0, t0 - GetOffset(), false);
+   NotesChanged();
    // want starting time to be t0
    SetOffset(t0);
 
@@ -532,6 +623,7 @@ void NoteTrack::Clear(double t0, double t1)
    double len = t1-t0;
 
    auto &seq = GetSeq();
+   NotesChanged();
 
    auto offset = GetOffset();
    auto start = t0 - offset;
@@ -596,6 +688,7 @@ void NoteTrack::Paste(double t, const Track *src)
       //delta += other->GetSeq().get_real_dur();
 
       seq.paste(t - GetOffset(), &other->GetSeq());
+      NotesChanged();
 
       AddToDuration( delta );
 
@@ -620,6 +713,7 @@ void NoteTrack::Silence(double t0, double t1)
    // If it's set, then it seems like notes are silenced if they start or end in the range,
    // otherwise only if they start in the range. --Poke
    seq.silence(t0 - GetOffset(), len, false);
+   NotesChanged();
 }
 
 void NoteTrack::InsertSilence(double t, double len)
@@ -630,6 +724,7 @@ void NoteTrack::InsertSilence(double t, double len)
    auto &seq = GetSeq();
    seq.convert_to_seconds();
    seq.insert_silence(t - GetOffset(), len);
+   NotesChanged();
 
    // is this needed?
    // AddToDuration( len );
@@ -671,6 +766,7 @@ bool NoteTrack::Shift(double t) // t is always seconds
    } else { // offset is zero, no modifications
       return false;
    }
+   NotesChanged();
    return true;
 }
 
@@ -724,6 +820,7 @@ bool NoteTrack::StretchRegion
    auto &seq = GetSeq();
    bool result = seq.stretch_region( t0.second, t1.second, newDur );
    if (result) {
+      NotesChanged();
       const auto oldDur = t1.first - t0.first;
       AddToDuration( newDur - oldDur );
    }
@@ -934,6 +1031,7 @@ bool NoteTrack::HandleXMLTag(const wxChar *tag, const wxChar **attrs)
              std::string s(strValue.mb_str(wxConvUTF8));
              std::istringstream data(s);
              mSeq = std::make_unique<Alg_seq>(data, false);
+             NotesChanged();
          }
       } // while
       return true;
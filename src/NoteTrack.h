@@ -16,6 +16,7 @@
 
 
 #include <utility>
+#include <vector>
 #include "Prefs.h"
 #include "Track.h"
 
@@ -48,6 +49,7 @@ class wxDC;
 class wxRect;
 
 class Alg_seq;   // from "allegro.h"
+class Alg_note;  // from "allegro.h"
 
 using NoteTrackBase =
 #ifdef EXPERIMENTAL_MIDI_OUT
@@ -81,6 +83,18 @@ public:
 
    Alg_seq &GetSeq() const;
 
+   //! Notes of the sequence that sound at some time in (t0, t1)
+   /*!
+    Times include the offset.  Notes are found by pitch, rounded, and pitches
+    beyond MinPitch and MaxPitch count as those.  The result is in the order
+    of the sequence, and is valid until the track is next edited.
+
+    Notes are looked up in an index, made again on demand after each edit, so
+    that drawing or hit testing takes time for the notes in the window only.
+    */
+   std::vector<Alg_note*> FindNotes(double t0, double t1,
+      int bottomPitch = MinPitch, int topPitch = MaxPitch) const;
+
    void WarpAndTransposeNotes(double t0, double t1,
                               const TimeWarper &warper, double semitones);
 
@@ -197,6 +211,10 @@ public:
 
    void AddToDuration( double delta );
 
+   struct NoteIndex;
+   //! Discard the index of notes after the sequence changes
+   void NotesChanged() { mNoteIndex.reset(); }
+
    // These are mutable to allow NoteTrack to switch details of representation
    // in logically const methods
    // At most one of the two pointers is not null at any time.
@@ -204,6 +222,8 @@ public:
    mutable std::unique_ptr<Alg_seq> mSeq;
    mutable std::unique_ptr<char[]> mSerializationBuffer;
    mutable long mSerializationLength;
+   //! Null until notes are first looked up after construction or an edit
+   mutable std::unique_ptr<NoteIndex> mNoteIndex;
 
 #ifdef EXPERIMENTAL_MIDI_OUT
    float mVelocity; // velocity offset
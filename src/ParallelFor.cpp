@@ -0,0 +1,72 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ParallelFor.cpp
+
+**********************************************************************/
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+IntSetting EffectsMaxThreads{ L"/Effects/MaxThreads", 0 };
+
+unsigned ParallelConcurrency()
+{
+   static const unsigned processors =
+      std::max(1u, std::thread::hardware_concurrency());
+   const auto limit = EffectsMaxThreads.Read();
+   return limit > 0 ? std::min<unsigned>(processors, limit) : processors;
+}
+
+void ParallelFor(size_t count,
+   const std::function<void(size_t)> &body, unsigned maxThreads)
+{
+   if (maxThreads == 0)
+      maxThreads = ParallelConcurrency();
+   const auto nThreads = std::min<size_t>(maxThreads, count);
+   if (nThreads <= 1) {
+      for (size_t ii = 0; ii < count; ++ii)
+         body(ii);
+      return;
+   }
+
+   std::atomic<size_t> next{ 0 };
+   std::atomic<bool> failed{ false };
+   std::exception_ptr exception;
+   std::mutex exceptionMutex;
+
+   auto work = [&]{
+      try {
+         while (!failed.load(std::memory_order_relaxed)) {
+            const auto ii = next.fetch_add(1);
+            if (ii >= count)
+               break;
+            body(ii);
+         }
+      }
+      catch (...) {
+         std::lock_guard<std::mutex> guard{ exceptionMutex };
+         if (!exception)
+            exception = std::current_exception();
+         failed.store(true);
+      }
+   };
+
+   std::vector<std::thread> threads;
+   threads.reserve(nThreads - 1);
+   for (size_t ii = 1; ii < nThreads; ++ii)
+      threads.emplace_back(work);
+   work();
+   for (auto &thread : threads)
+      thread.join();
+
+   if (exception)
+      std::rethrow_exception(exception);
+}
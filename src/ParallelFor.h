@@ -0,0 +1,39 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ParallelFor.h
+
+  Run independent pieces of work on several threads.
+
+**********************************************************************/
+
+#ifndef __AUDACITY_PARALLEL_FOR__
+#define __AUDACITY_PARALLEL_FOR__
+
+#include <cstddef>
+#include <functional>
+#include "Prefs.h"
+
+//! Number of threads worth using for computation on this machine, at least 1
+/*! Limited by EffectsMaxThreads.  Call only on the main thread. */
+AUDACITY_DLL_API unsigned ParallelConcurrency();
+
+//! Call body(ii) for each 0 <= ii < count, in no particular order
+/*!
+ The calling thread takes a share of the work, and returns when all is done.
+ If any call throws, the remaining work is abandoned and the first exception
+ is rethrown in the calling thread.
+
+ The calls must not touch the project database or the user interface.
+
+ @param maxThreads limits the number of threads including the calling one;
+ 0 means ParallelConcurrency()
+ */
+AUDACITY_DLL_API void ParallelFor(size_t count,
+   const std::function<void(size_t)> &body, unsigned maxThreads = 0);
+
+//! Most threads that processing may use; 0 for as many as there are processors
+extern AUDACITY_DLL_API IntSetting EffectsMaxThreads;
+
+#endif
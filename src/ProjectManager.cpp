@@ -25,6 +25,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "ProjectFileIO.h"
 #include "ProjectFileManager.h"
 #include "ProjectHistory.h"
+#include "ProjectOverview.h"
 #include "ProjectSelectionManager.h"
 #include "ProjectWindows.h"
 #include "ProjectRate.h"
@@ -466,6 +467,15 @@ void InitProjectWindow( ProjectWindow &window )
       bs->Add(hs.release(), 1, wxEXPAND | wxALIGN_LEFT | wxALIGN_TOP);
    }
 
+   {
+      // Overview of the project, under the tracks
+      auto hs = std::make_unique<wxBoxSizer>(wxHORIZONTAL);
+      hs->Add(viewInfo.GetLeftOffset() - 1, 0);
+      hs->Add(&ProjectOverview::Get( project ), 1, wxEXPAND);
+      hs->Add(vsBar->GetSize().GetWidth(), 0);
+      bs->Add(hs.release(), 0, wxEXPAND | wxALIGN_LEFT);
+   }
+
    {
       // Bottom horizontal grouping
       auto hs = std::make_unique<wxBoxSizer>(wxHORIZONTAL);
@@ -778,6 +788,7 @@ void ProjectManager::OnCloseWindow(wxCloseEvent & event)
    // before the TrackPanel is destroyed. This change was needed to stop Audacity
    // crashing when running with Jaws on Windows 10 1703.
    AdornedRulerPanel::Destroy( project );
+   ProjectOverview::Destroy( project );
 
    // Destroy the TrackPanel early so it's not around once we start
    // deleting things like tracks and such out from underneath it.
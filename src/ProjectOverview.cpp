@@ -0,0 +1,453 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ProjectOverview.cpp
+
+**********************************************************************/
+
+#include "ProjectOverview.h"
+
+#include <algorithm>
+#include <cmath>
+#include <wx/app.h>
+#include <wx/dcclient.h>
+#include <wx/dcmemory.h>
+
+#include "AllThemeResources.h"
+#include "AudioIO.h"
+#include "Project.h"
+#include "ProjectAudioIO.h"
+#include "ProjectWindow.h"
+#include "ProjectWindows.h"
+#include "Theme.h"
+#include "UndoManager.h"
+#include "ViewInfo.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+#include "prefs/ThemePrefs.h"
+
+BoolSetting ShowProjectOverview{ L"/GUI/ShowOverview", false };
+
+int ShowOverviewPrefsID()
+{
+   static int value = wxNewId();
+   return value;
+}
+
+namespace {
+
+//! Duration of the cells of a new summary
+constexpr double MinCellDuration = 1.0 / 64;
+
+constexpr int OverviewHeight = 40;
+
+}
+
+struct ProjectOverview::Summary
+{
+   //! What was summarized of a clip
+   struct ClipState
+   {
+      const WaveClip *clip;
+      double sequenceStart;
+      double trimLeft;
+      double trimRight;
+      std::vector<SampleBlockID> blockIDs;
+   };
+
+   //! Minimum and maximum; empty cells have the minimum above the maximum
+   using Cell = std::pair<float, float>;
+
+   //! @return whether the cells changed
+   bool Update(const WaveTrack &leader);
+
+   //! Add blocks of the clip from index first on
+   void AddBlocks(const WaveClip &clip, size_t first);
+   void Add(double t0, double t1, float min, float max);
+   //! Double the cell duration
+   void Coarsen();
+
+   //! The leader track in the project's list
+   std::weak_ptr<const Track> track;
+   //! Clips of all channels
+   std::vector<ClipState> clips;
+   double cellDuration{ MinCellDuration };
+   std::vector<Cell> cells;
+};
+
+bool ProjectOverview::Summary::Update(const WaveTrack &leader)
+{
+   std::vector<std::shared_ptr<const WaveClip>> holders;
+   for (auto channel : TrackList::Channels(&leader)) {
+      // Recording appends to the pending copy of the track
+      const auto pTrack = std::static_pointer_cast<const WaveTrack>(
+         channel->SubstitutePendingChangedTrack());
+      for (const auto &pClip : pTrack->GetClips())
+         holders.push_back(pClip);
+   }
+
+   // Compare with the blocks in place, so that checking an unchanged track
+   // copies nothing
+   const auto sameID = [](SampleBlockID id, const SeqBlock &block){
+      return id == block.sb->GetBlockID(); };
+   const auto unchanged = [&](const ClipState &old, const BlockArray &blocks){
+      return blocks.size() == old.blockIDs.size() &&
+         (blocks.empty() || sameID(old.blockIDs.back(), blocks.back()));
+   };
+
+   // Were blocks only appended, perhaps replacing the last block?
+   bool appended = holders.size() == clips.size();
+   bool same = appended;
+   for (size_t ii = 0; appended && ii < holders.size(); ++ii) {
+      const auto &old = clips[ii];
+      const auto &clip = *holders[ii];
+      const auto &blocks = *clip.GetSequenceBlockArray();
+      const auto kept = std::max<size_t>(old.blockIDs.size(), 1) - 1;
+      appended = &clip == old.clip &&
+         clip.GetSequenceStartTime() == old.sequenceStart &&
+         clip.GetTrimLeft() == old.trimLeft &&
+         clip.GetTrimRight() == old.trimRight &&
+         blocks.size() >= old.blockIDs.size() &&
+         std::equal(old.blockIDs.begin(), old.blockIDs.begin() + kept,
+            blocks.begin(), sameID);
+      same = appended && same && unchanged(old, blocks);
+   }
+   if (same)
+      return false;
+
+   if (!appended) {
+      cells.clear();
+      cellDuration = MinCellDuration;
+      clips.clear();
+   }
+   clips.resize(holders.size());
+   for (size_t ii = 0; ii < holders.size(); ++ii) {
+      const auto &clip = *holders[ii];
+      const auto &blocks = *clip.GetSequenceBlockArray();
+      auto &state = clips[ii];
+      size_t first = 0;
+      if (appended) {
+         if (unchanged(state, blocks))
+            continue;
+         first = std::max<size_t>(state.blockIDs.size(), 1) - 1;
+      }
+      state.clip = &clip;
+      state.sequenceStart = clip.GetSequenceStartTime();
+      state.trimLeft = clip.GetTrimLeft();
+      state.trimRight = clip.GetTrimRight();
+      state.blockIDs.resize(first);
+      for (auto jj = first; jj < blocks.size(); ++jj)
+         state.blockIDs.push_back(blocks[jj].sb->GetBlockID());
+      AddBlocks(clip, first);
+   }
+   return true;
+}
+
+void ProjectOverview::Summary::AddBlocks(const WaveClip &clip, size_t first)
+{
+   const auto &blocks = *clip.GetSequenceBlockArray();
+   const double rate = clip.GetRate();
+   const double start = clip.GetSequenceStartTime();
+   const double playStart = clip.GetPlayStartTime();
+   const double playEnd = clip.GetPlayEndTime();
+   for (auto ii = first; ii < blocks.size(); ++ii) {
+      const auto &block = blocks[ii];
+      const double t0 = start + block.start.as_double() / rate;
+      const double t1 = t0 + block.sb->GetSampleCount() / rate;
+      // The summary that the block keeps; no samples are read
+      const auto results = block.sb->GetMinMaxRMS(false);
+      Add(std::max(t0, playStart), std::min(t1, playEnd),
+         results.min, results.max);
+   }
+}
+
+void ProjectOverview::Summary::Add(
+   double t0, double t1, float min, float max)
+{
+   t0 = std::max(t0, 0.0);
+   if (t1 <= t0)
+      return;
+   while (t1 > cellDuration * MaxCells)
+      Coarsen();
+   const auto first = size_t(t0 / cellDuration);
+   const auto end = std::min(MaxCells,
+      std::max(first + 1, size_t(std::ceil(t1 / cellDuration))));
+   if (cells.size() < end)
+      cells.resize(end, { 1.0f, -1.0f });
+   for (auto ii = first; ii < end; ++ii) {
+      auto &cell = cells[ii];
+      if (cell.first > cell.second)
+         cell = { min, max };
+      else
+         cell = { std::min(cell.first, min), std::max(cell.second, max) };
+   }
+}
+
+void ProjectOverview::Summary::Coarsen()
+{
+   const auto size = (cells.size() + 1) / 2;
+   for (size_t ii = 0; ii < size; ++ii) {
+      auto cell = cells[2 * ii];
+      if (2 * ii + 1 < cells.size()) {
+         const auto &next = cells[2 * ii + 1];
+         if (cell.first > cell.second)
+            cell = next;
+         else if (next.first <= next.second)
+            cell = { std::min(cell.first, next.first),
+               std::max(cell.second, next.second) };
+      }
+      cells[ii] = cell;
+   }
+   cells.resize(size);
+   cellDuration *= 2;
+}
+
+static AttachedWindows::RegisteredFactory sKey{
+   []( AudacityProject &project ) -> wxWeakRef< wxWindow > {
+      auto &window = ProjectWindow::Get( project );
+      return safenew ProjectOverview( project, window.GetMainPage() );
+   }
+};
+
+ProjectOverview &ProjectOverview::Get( AudacityProject &project )
+{
+   return GetAttachedWindows(project).Get< ProjectOverview >( sKey );
+}
+
+void ProjectOverview::Destroy( AudacityProject &project )
+{
+   auto *pPanel = GetAttachedWindows(project).Find( sKey );
+   if (pPanel) {
+      pPanel->wxWindow::Destroy();
+      GetAttachedWindows(project).Assign( sKey, nullptr );
+   }
+}
+
+BEGIN_EVENT_TABLE(ProjectOverview, wxPanelWrapper)
+   EVT_PAINT(ProjectOverview::OnPaint)
+   EVT_SIZE(ProjectOverview::OnSize)
+   EVT_MOUSE_EVENTS(ProjectOverview::OnMouse)
+END_EVENT_TABLE()
+
+ProjectOverview::ProjectOverview( AudacityProject &project, wxWindow *parent )
+   : wxPanelWrapper( parent, wxID_ANY, wxDefaultPosition,
+      wxSize( -1, OverviewHeight ), wxNO_BORDER, XO("Project Overview") )
+   , mProject{ project }
+{
+   SetBackgroundStyle(wxBG_STYLE_PAINT);
+   SetMinSize( { -1, OverviewHeight } );
+   Show( ShowProjectOverview.Read() );
+
+   wxTheApp->Bind(EVT_THEME_CHANGE, &ProjectOverview::OnThemeChange, this);
+
+   project.Bind(EVT_TRACK_PANEL_TIMER, &ProjectOverview::OnTimer, this);
+
+   project.Bind(EVT_UNDO_PUSHED, &ProjectOverview::OnUndo, this);
+   project.Bind(EVT_UNDO_MODIFIED, &ProjectOverview::OnUndo, this);
+   project.Bind(EVT_UNDO_OR_REDO, &ProjectOverview::OnUndo, this);
+   project.Bind(EVT_UNDO_RESET, &ProjectOverview::OnUndo, this);
+
+   auto &tracks = TrackList::Get( project );
+   tracks.Bind(EVT_TRACKLIST_ADDITION,
+      &ProjectOverview::OnTrackListChange, this);
+   tracks.Bind(EVT_TRACKLIST_DELETION,
+      &ProjectOverview::OnTrackListChange, this);
+   tracks.Bind(EVT_TRACKLIST_PERMUTED,
+      &ProjectOverview::OnTrackListChange, this);
+}
+
+void ProjectOverview::UpdatePrefs()
+{
+   UpdateSelectedPrefs( ShowOverviewPrefsID() );
+}
+
+void ProjectOverview::UpdateSelectedPrefs( int id )
+{
+   if (id != ShowOverviewPrefsID())
+      return;
+   const bool show = ShowProjectOverview.Read();
+   if (show != IsShown()) {
+      Show( show );
+      GetParent()->Layout();
+   }
+}
+
+void ProjectOverview::OnThemeChange(wxCommandEvent &evt)
+{
+   evt.Skip();
+   mBitmapValid = false;
+   Refresh(false);
+}
+
+void ProjectOverview::OnTimer(wxCommandEvent &event)
+{
+   event.Skip();
+   if (!IsShown())
+      return;
+
+   // Recording appends to the pending tracks without any notification
+   if (ProjectAudioIO::Get( mProject ).IsAudioActive() &&
+       AudioIO::Get()->GetNumCaptureChannels() > 0)
+      mTracksChanged = true;
+
+   if (mTracksChanged) {
+      mTracksChanged = false;
+      if (UpdateSummaries())
+         mBitmapValid = false;
+   }
+   if (!mBitmapValid || VisibleSpan() != mLastVisible)
+      Refresh(false);
+}
+
+void ProjectOverview::OnUndo(wxCommandEvent &event)
+{
+   event.Skip();
+   // Any edit of the tracks ends in a change of the undo history
+   mTracksChanged = true;
+}
+
+void ProjectOverview::OnTrackListChange(TrackListEvent &event)
+{
+   event.Skip();
+   mTracksChanged = true;
+}
+
+bool ProjectOverview::UpdateSummaries()
+{
+   std::vector<Summary> summaries;
+   bool changed = false;
+   double length = 0;
+   for (auto pTrack : TrackList::Get( mProject ).Leaders<const WaveTrack>()) {
+      // Reuse the summary of the track, if it has one
+      const auto iter = std::find_if(mSummaries.begin(), mSummaries.end(),
+         [pTrack](const Summary &summary){
+            return summary.track.lock().get() == pTrack; });
+      // Tracks added, removed or reordered before this one?
+      if (iter - mSummaries.begin() != std::ptrdiff_t(summaries.size()))
+         changed = true;
+      Summary summary;
+      if (iter != mSummaries.end())
+         summary = std::move(*iter);
+      else
+         summary.track = pTrack->SharedPointer();
+      if (summary.Update(*pTrack))
+         changed = true;
+      summaries.push_back(std::move(summary));
+
+      for (auto channel : TrackList::Channels(pTrack))
+         length = std::max(length,
+            channel->SubstitutePendingChangedTrack()->GetEndTime());
+   }
+   if (summaries.size() != mSummaries.size() || length != mLength)
+      changed = true;
+   mSummaries.swap(summaries);
+   mLength = length;
+   return changed;
+}
+
+void ProjectOverview::DrawSummaries()
+{
+   const auto size = GetClientSize();
+   const int width = std::max(1, size.x), height = std::max(1, size.y);
+   if (!mBitmap.IsOk() ||
+       mBitmap.GetWidth() != width || mBitmap.GetHeight() != height)
+      mBitmap.Create(width, height);
+
+   wxMemoryDC dc;
+   dc.SelectObject(mBitmap);
+   dc.SetBackground(wxBrush(theTheme.Colour( clrTrackInfo )));
+   dc.Clear();
+
+   const auto nRows = mSummaries.size();
+   if (nRows == 0 || mLength <= 0)
+      return;
+
+   dc.SetPen(wxPen(theTheme.Colour( clrSample )));
+   for (size_t row = 0; row < nRows; ++row) {
+      const auto &summary = mSummaries[row];
+      const auto &cells = summary.cells;
+      // Rows may overlap when there are more tracks than pixels
+      const int top = height * row / nRows;
+      const int bottom = std::max(top + 1, int(height * (row + 1) / nRows));
+      const double middle = (top + bottom) / 2.0;
+      const double half = (bottom - top) / 2.0;
+      const double cellsPerPixel = mLength / width / summary.cellDuration;
+      for (int x = 0; x < width; ++x) {
+         const auto first = size_t(x * cellsPerPixel);
+         if (first >= cells.size())
+            break;
+         const auto end = std::min(cells.size(),
+            std::max(first + 1, size_t((x + 1) * cellsPerPixel)));
+         float min = 1.0f, max = -1.0f;
+         for (auto ii = first; ii < end; ++ii) {
+            const auto &cell = cells[ii];
+            if (cell.first > cell.second)
+               continue;
+            if (min > max)
+               min = cell.first, max = cell.second;
+            else
+               min = std::min(min, cell.first), max = std::max(max, cell.second);
+         }
+         if (min > max)
+            continue;
+         const int y0 = std::clamp(int(middle - max * half), top, bottom - 1);
+         const int y1 = std::clamp(int(middle - min * half), top, bottom - 1);
+         dc.DrawLine(x, y0, x, y1 + 1);
+      }
+   }
+}
+
+std::pair<int, int> ProjectOverview::VisibleSpan() const
+{
+   const auto width = GetClientSize().x;
+   if (mLength <= 0)
+      return { 0, width };
+   const auto &viewInfo = ViewInfo::Get( mProject );
+   const auto position = [&](double t){
+      return std::clamp(int(t / mLength * width), 0, width); };
+   return { position(viewInfo.h), position(viewInfo.GetScreenEndTime()) };
+}
+
+void ProjectOverview::OnPaint(wxPaintEvent &)
+{
+   wxPaintDC dc(this);
+   if (!mBitmapValid) {
+      DrawSummaries();
+      mBitmapValid = true;
+   }
+   dc.DrawBitmap(mBitmap, 0, 0);
+
+   // Outline the part that the tracks show
+   mLastVisible = VisibleSpan();
+   dc.SetBrush(*wxTRANSPARENT_BRUSH);
+   dc.SetPen(wxPen(theTheme.Colour( clrTrackPanelText )));
+   dc.DrawRectangle(mLastVisible.first, 0,
+      std::max(2, mLastVisible.second - mLastVisible.first),
+      GetClientSize().y);
+}
+
+void ProjectOverview::OnSize(wxSizeEvent &event)
+{
+   event.Skip();
+   mBitmapValid = false;
+   Refresh(false);
+}
+
+void ProjectOverview::OnMouse(wxMouseEvent &event)
+{
+   if (!(event.LeftDown() || (event.Dragging() && event.LeftIsDown()))) {
+      event.Skip();
+      return;
+   }
+
+   // Center the tracks on the time under the mouse
+   const auto width = GetClientSize().x;
+   if (width <= 0 || mLength <= 0)
+      return;
+   const auto &viewInfo = ViewInfo::Get( mProject );
+   const double screen = viewInfo.GetScreenEndTime() - viewInfo.h;
+   const double t = std::clamp(event.GetX(), 0, width) * mLength / width;
+   ProjectWindow::Get( mProject ).TP_ScrollWindow(t - screen / 2);
+   Refresh(false);
+}
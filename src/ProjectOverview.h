@@ -0,0 +1,93 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ProjectOverview.h
+
+  A strip under the tracks showing all of the project at once, drawn from
+  the summaries that sample blocks keep.
+
+**********************************************************************/
+
+#ifndef __AUDACITY_PROJECT_OVERVIEW__
+#define __AUDACITY_PROJECT_OVERVIEW__
+
+#include <vector>
+#include <wx/bitmap.h> // member variable
+
+#include "Prefs.h"
+#include "widgets/wxPanelWrapper.h"
+
+class AudacityProject;
+struct TrackListEvent;
+
+//! Whether project windows show the overview
+extern AUDACITY_DLL_API BoolSetting ShowProjectOverview;
+
+//! Broadcast when ShowProjectOverview changes
+AUDACITY_DLL_API int ShowOverviewPrefsID();
+
+//! Minimum and maximum of all wave tracks over the length of the project,
+//! with the visible part outlined; clicking or dragging scrolls the tracks
+/*!
+ Each track is summarized from the minimum and maximum that each of its
+ sample blocks keeps, so samples are never read.  A summary has at most
+ MaxCells cells, each a power of two seconds long, doubling as the project
+ grows, so that drawing takes the same time however long the project is.
+
+ Summaries are checked against the blocks of the clips when the undo history
+ or the list of tracks changes, and on each tick of the track panel timer
+ while recording.  Blocks appended to clips, as in recording, are added to
+ the cells; other changes summarize the track again; unchanged tracks are
+ skipped.
+ */
+class AUDACITY_DLL_API ProjectOverview final
+   : public wxPanelWrapper
+   , private PrefsListener
+{
+public:
+   static ProjectOverview &Get( AudacityProject &project );
+   static void Destroy( AudacityProject &project );
+
+   //! Most cells in the summary of a track
+   static constexpr size_t MaxCells = 2048;
+
+   ProjectOverview( AudacityProject &project, wxWindow *parent );
+
+private:
+   struct Summary;
+
+   void UpdatePrefs() override;
+   void UpdateSelectedPrefs( int id ) override;
+
+   void OnThemeChange(wxCommandEvent &evt);
+   void OnTimer(wxCommandEvent &event);
+   void OnUndo(wxCommandEvent &event);
+   void OnTrackListChange(TrackListEvent &event);
+   void OnPaint(wxPaintEvent &event);
+   void OnSize(wxSizeEvent &event);
+   void OnMouse(wxMouseEvent &event);
+
+   //! @return whether any summary changed, or tracks were added, removed or
+   //! reordered
+   bool UpdateSummaries();
+   void DrawSummaries();
+   //! Horizontal extent of the visible part of the tracks
+   std::pair<int, int> VisibleSpan() const;
+
+   AudacityProject &mProject;
+   std::vector<Summary> mSummaries;
+
+   //! The summaries as drawn, for the length mLength
+   wxBitmap mBitmap;
+   bool mBitmapValid{ false };
+   double mLength{ 0 };
+
+   //! Whether the summaries need checking against the tracks
+   bool mTracksChanged{ true };
+   std::pair<int, int> mLastVisible{ -1, -1 };
+
+   DECLARE_EVENT_TABLE()
+};
+
+#endif
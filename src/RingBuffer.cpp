@@ -134,6 +134,22 @@ size_t RingBuffer::Clear(sampleFormat format, size_t samplesToClear)
    return cleared;
 }
 
+std::pair<samplePtr, size_t> RingBuffer::GetUnwrappedPutBuffer()
+{
+   auto start = mStart.load( std::memory_order_acquire );
+   auto end = mEnd.load( std::memory_order_relaxed );
+   const auto free = std::min( Free( start, end ), mBufferSize - end );
+   return { mBuffer.ptr() + end * SAMPLE_SIZE(mFormat), free };
+}
+
+void RingBuffer::Commit(size_t samples)
+{
+   auto end = mEnd.load( std::memory_order_relaxed );
+
+   // Release, as in Put()
+   mEnd.store((end + samples) % mBufferSize, std::memory_order_release);
+}
+
 //
 // For the reader only:
 // Only reader writes the start, so it can read it again relaxed
@@ -13,6 +13,7 @@
 
 #include "SampleFormat.h"
 #include <atomic>
+#include <utility>
 
 class RingBuffer final : public NonInterferingBase {
  public:
@@ -30,6 +31,14 @@ class RingBuffer final : public NonInterferingBase {
               size_t padding = 0);
    size_t Clear(sampleFormat format, size_t samples);
 
+   //! Get contiguous free space, in the format of the buffer, for writing
+   //! samples in place; follow with Commit()
+   /*! The length may be less than AvailForPut() when the free space wraps
+    around the end of the buffer */
+   std::pair<samplePtr, size_t> GetUnwrappedPutBuffer();
+   //! Make samples written in place available to the reader
+   void Commit(size_t samples);
+
    //
    // For the reader only:
    //
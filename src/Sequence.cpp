@@ -42,6 +42,7 @@
 
 #include "SampleBlock.h"
 #include "InconsistencyException.h"
+#include "WaveformTileCache.h"
 #include "widgets/AudacityMessageBox.h"
 
 size_t Sequence::sMaxDiskBlockSize = 1048576;
@@ -1229,7 +1230,6 @@ struct MinMaxSumsq
       while (count--) {
          float v;
          switch (divisor) {
-         default:
          case 1:
             // array holds samples
             v = *pv++;
@@ -1239,8 +1239,7 @@ struct MinMaxSumsq
                max = v;
             sumsq += v * v;
             break;
-         case 256:
-         case 65536:
+         default:
             // array holds triples of min, max, and rms values
             v = *pv++;
             if (v < min)
@@ -1331,13 +1330,18 @@ bool Sequence::GetWaveDisplay(float *min, float *max, float *rms, int* bl,
       if (nextPixel == len)
          whereNext = s1;
 
-      // Decide the summary level
+      // Decide the summary level:  the coarsest with at least four summaries
+      // to a column, but none longer than a block
       const double samplesPerPixel =
          (whereNext - whereNow).as_double() / (nextPixel - pixel);
-      const int divisor =
-           (samplesPerPixel >= 65536) ? 65536
-         : (samplesPerPixel >= 256) ? 256
-         : 1;
+      unsigned level = 0;
+      if (samplesPerPixel >= (1 << WaveformTileCache::MinLevel)) {
+         level = WaveformTileCache::MinLevel;
+         while ((4 << level) <= samplesPerPixel &&
+                (size_t(2) << level) <= mMaxSamples)
+            ++level;
+      }
+      const int divisor = 1 << level;
 
       int blockStatus = b;
 
@@ -1364,25 +1368,15 @@ bool Sequence::GetWaveDisplay(float *min, float *max, float *rms, int* bl,
       }
 
       // Read from the block file or its summary
-      switch (divisor) {
-      default:
-      case 1:
+      if (divisor == 1)
          // Read samples
          // no-throw for display operations!
          Read((samplePtr)temp.get(), floatSample, seqBlock, startPosition, num, false);
-         break;
-      case 256:
-         // Read triples
-         // Ignore the return value.
-         // This function fills with zeroes if read fails
-         seqBlock.sb->GetSummary256(temp.get(), startPosition, num);
-         break;
-      case 65536:
-         // Read triples
-         // Ignore the return value.
-         // This function fills with zeroes if read fails
-         seqBlock.sb->GetSummary64k(temp.get(), startPosition, num);
-         break;
+      else {
+         // Read triples, summarized once for all clips sharing the block
+         // This has zeroes if read fails
+         const auto pTile = WaveformTileCache::Get().Lookup(seqBlock.sb, level);
+         std::copy_n(pTile->data() + 3 * startPosition, 3 * num, temp.get());
       }
       
       auto filePosition = startPosition;
@@ -0,0 +1,199 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrogramTileStore.cpp
+
+**********************************************************************/
+
+#include "SpectrogramTileStore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sqlite3.h>
+#include <wx/log.h>
+
+#include "AudacityException.h"
+#include "Project.h"
+
+BoolSetting SpectrumCacheInProject{
+   L"/Spectrum/CacheInProject", false };
+
+namespace {
+
+//! Steps of the stored values, per dB
+constexpr float Resolution = 64.0f;
+
+// Rows are immutable, as for sampleblocks.  A tile has a row in
+// spectrogramtileblocks for each block that it reads, and goes when any of
+// them is gone.
+const char *const Schema =
+   "CREATE TABLE IF NOT EXISTS spectrogramtiles"
+   "("
+   "  key                  BLOB PRIMARY KEY,"
+   "  spectrum             BLOB"
+   ");"
+   "CREATE TABLE IF NOT EXISTS spectrogramtileblocks"
+   "("
+   "  tilekey              BLOB,"
+   "  blockid              INTEGER,"
+   "  PRIMARY KEY (tilekey, blockid)"
+   ");"
+   "DELETE FROM spectrogramtiles"
+   "  WHERE key IN (SELECT tilekey FROM spectrogramtileblocks"
+   "    WHERE blockid > 0"
+   "    AND blockid NOT IN (SELECT blockid FROM sampleblocks));"
+   "DELETE FROM spectrogramtileblocks"
+   "  WHERE tilekey NOT IN (SELECT key FROM spectrogramtiles);";
+
+}
+
+static const AudacityProject::AttachedObjects::RegisteredFactory
+sSpectrogramTileStoreKey{
+   []( AudacityProject &project ){
+      return std::make_shared< SpectrogramTileStore >( project );
+   }
+};
+
+SpectrogramTileStore &SpectrogramTileStore::Get( AudacityProject &project )
+{
+   return project.AttachedObjects::Get< SpectrogramTileStore >(
+      sSpectrogramTileStoreKey );
+}
+
+SpectrogramTileStore::SpectrogramTileStore(AudacityProject &project)
+   : mProject{ project }
+{
+}
+
+SpectrogramTileStore::~SpectrogramTileStore() = default;
+
+bool SpectrogramTileStore::IsEnabled()
+{
+   if (!SpectrumCacheInProject.Read())
+      return false;
+   auto &pConnection = ConnectionPtr::Get(mProject).mpConnection;
+   if (!pConnection)
+      return false;
+   const auto db = pConnection->DB();
+   if (db != mDB) {
+      // A new or reopened project file
+      mDB = db;
+      mUsable = Prepare(db);
+   }
+   return mUsable;
+}
+
+bool SpectrogramTileStore::Prepare(sqlite3 *db)
+{
+   char *errmsg = nullptr;
+   const auto rc = sqlite3_exec(db, Schema, nullptr, nullptr, &errmsg);
+   if (rc != SQLITE_OK) {
+      // Perhaps a read-only file; go without
+      wxLogDebug(wxT("SpectrogramTileStore - SQLITE error %s"), errmsg);
+      sqlite3_free(errmsg);
+      return false;
+   }
+   return true;
+}
+
+sqlite3_stmt *SpectrogramTileStore::Statement(
+   DBConnection::StatementID id, const char *sql)
+{
+   if (!IsEnabled())
+      return nullptr;
+   try {
+      // Prepare and cache statement...automatically finalized at DB close
+      return ConnectionPtr::Get(mProject).mpConnection->Prepare(id, sql);
+   }
+   catch (const AudacityException &) {
+      // A new database at the address of the old, perhaps after compaction,
+      // and without the table; make it next time
+      mDB = nullptr;
+      return nullptr;
+   }
+}
+
+bool SpectrogramTileStore::Load(const Key &key, std::vector<float> &values)
+{
+   sqlite3_stmt *stmt = Statement(DBConnection::GetSpectrogramTile,
+      "SELECT spectrum FROM spectrogramtiles WHERE key = ?1;");
+   if (!stmt)
+      return false;
+
+   bool found = false;
+   if (sqlite3_bind_blob(stmt, 1, key.data(), (int)key.size(), SQLITE_STATIC)
+          == SQLITE_OK &&
+       sqlite3_step(stmt) == SQLITE_ROW) {
+      const auto src =
+         static_cast<const short *>(sqlite3_column_blob(stmt, 0));
+      const auto bytes = size_t(sqlite3_column_bytes(stmt, 0));
+      if (src && bytes == values.size() * sizeof(short)) {
+         std::transform(src, src + values.size(), values.begin(),
+            [](short value){ return value / Resolution; });
+         found = true;
+      }
+   }
+
+   // Clear statement bindings and rewind statement
+   sqlite3_clear_bindings(stmt);
+   sqlite3_reset(stmt);
+
+   return found;
+}
+
+void SpectrogramTileStore::Save(const Key &key,
+   const std::vector<long long> &blockIDs, const std::vector<float> &values)
+{
+   sqlite3_stmt *blockStmt = Statement(
+      DBConnection::InsertSpectrogramTileBlock,
+      "INSERT OR IGNORE INTO spectrogramtileblocks (tilekey, blockid)"
+      "                         VALUES(?1,?2);");
+   sqlite3_stmt *stmt = Statement(DBConnection::InsertSpectrogramTile,
+      "INSERT OR REPLACE INTO spectrogramtiles (key, spectrum)"
+      "                         VALUES(?1,?2);");
+   if (!(blockStmt && stmt))
+      return;
+
+   // The blocks first, so that a tile is never kept without them; blocks
+   // without a tile are removed at the next opening
+   for (const auto blockID : blockIDs) {
+      bool ok = true;
+      if (sqlite3_bind_blob(blockStmt, 1,
+             key.data(), (int)key.size(), SQLITE_STATIC) ||
+          sqlite3_bind_int64(blockStmt, 2, blockID))
+         wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+      else if (sqlite3_step(blockStmt) != SQLITE_DONE) {
+         wxLogDebug(wxT("SpectrogramTileStore::Save - SQLITE error %s"),
+            sqlite3_errmsg(mDB));
+         ok = false;
+      }
+
+      // Clear statement bindings and rewind statement
+      sqlite3_clear_bindings(blockStmt);
+      sqlite3_reset(blockStmt);
+
+      if (!ok)
+         return;
+   }
+
+   mBuffer.resize(values.size());
+   std::transform(values.begin(), values.end(), mBuffer.begin(),
+      [](float value){
+         return static_cast<short>(std::clamp(
+            std::lround(value * Resolution), -32768L, 32767L));
+      });
+
+   if (sqlite3_bind_blob(stmt, 1, key.data(), (int)key.size(), SQLITE_STATIC) ||
+       sqlite3_bind_blob(stmt, 2, mBuffer.data(),
+          (int)(mBuffer.size() * sizeof(short)), SQLITE_STATIC))
+      wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+   else if (sqlite3_step(stmt) != SQLITE_DONE)
+      // Not worth troubling the user; the tile is computed again next time
+      wxLogDebug(wxT("SpectrogramTileStore::Save - SQLITE error %s"),
+         sqlite3_errmsg(mDB));
+
+   // Clear statement bindings and rewind statement
+   sqlite3_clear_bindings(stmt);
+   sqlite3_reset(stmt);
+}
@@ -0,0 +1,75 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrogramTileStore.h
+
+  Optional table of computed spectrogram tiles in the project file.
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SPECTROGRAM_TILE_STORE__
+#define __AUDACITY_SPECTROGRAM_TILE_STORE__
+
+#include <vector>
+
+#include "ClientData.h"
+#include "DBConnection.h"
+#include "Prefs.h"
+
+class AudacityProject;
+
+//! Whether computed spectrograms are kept in project files
+extern AUDACITY_DLL_API BoolSetting SpectrumCacheInProject;
+
+//! Spectrogram tiles of a project, so that they survive reopening, undo,
+//! and the moving of clips
+/*!
+ A key names everything that determines a tile, including the sample blocks
+ that it reads and their positions, so that reuse is exact.  Values are kept
+ to the nearest 1/64 dB.
+
+ The tables are made when first needed.  They are not copied when the
+ project is compacted or saved under another name.  Each tile is recorded
+ with every block that it reads, and is removed at the next opening when
+ any of them is gone.
+
+ Call only on the main thread.
+ */
+class AUDACITY_DLL_API SpectrogramTileStore final : public ClientData::Base
+{
+public:
+   using Key = std::vector<unsigned char>;
+
+   static SpectrogramTileStore &Get(AudacityProject &project);
+
+   explicit SpectrogramTileStore(AudacityProject &project);
+   ~SpectrogramTileStore() override;
+
+   //! Whether the preference allows the store, and the project file has it
+   bool IsEnabled();
+
+   //! @return whether all of values were found
+   bool Load(const Key &key, std::vector<float> &values);
+
+   /*!
+    @param blockIDs all of the blocks that the tile reads, so that the tile
+    can be removed with any of them
+    */
+   void Save(const Key &key, const std::vector<long long> &blockIDs,
+      const std::vector<float> &values);
+
+private:
+   //! Make the tables if needed, and remove tiles of deleted blocks
+   bool Prepare(sqlite3 *db);
+   //! Null if the store can't be used
+   sqlite3_stmt *Statement(DBConnection::StatementID id, const char *sql);
+
+   AudacityProject &mProject;
+   std::vector<short> mBuffer;
+   //! The database for which Prepare() last ran
+   sqlite3 *mDB{};
+   bool mUsable{ false };
+};
+
+#endif
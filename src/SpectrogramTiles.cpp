@@ -0,0 +1,610 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrogramTiles.cpp
+
+*******************************************************************//**
+
+\class SpectrogramTiles
+\brief Spectrogram of one clip, in tiles computed by worker threads.
+
+Worker threads read samples from a copy of the clip's block array, taken
+when the zoom level, settings or contents last changed, so that editing
+never waits for them.  All objects that the main thread shares with the
+workers are released on the main thread, only after the workers are done
+with them; so no sample block is ever destroyed by a worker.
+
+*//*******************************************************************/
+
+#include "SpectrogramTiles.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <wx/app.h>
+
+#include "ParallelFor.h"
+#include "SampleBlock.h"
+#include "Sequence.h"
+#include "SpectrogramTileStore.h"
+#include "Spectrum.h"
+#include "WaveClip.h"
+#include "prefs/SpectrogramSettings.h"
+
+wxDEFINE_EVENT(EVT_SPECTROGRAM_TILES_READY, wxCommandEvent);
+
+namespace {
+
+//! Value shown where nothing is computed yet, as for empty reassignment bins
+constexpr float Silence = -160.0f;
+
+//! Most samples that one tile reads at once
+constexpr size_t MaxTileSpan = 1 << 20;
+
+//! Added to the priorities of tiles outside the view
+constexpr long long PrefetchPriority = 1LL << 40;
+
+//! Change when computation of the columns changes, so that tiles saved in
+//! project files are not reused
+constexpr unsigned char StoreVersion = 1;
+
+long long TileOf(long long column)
+{
+   const long long width = SpectrogramTiles::TileColumns;
+   return column >= 0 ? column / width : -((width - 1 - column) / width);
+}
+
+//! A copy of settings that ignores changes of preferences, which would
+//! otherwise be made while the workers use it
+struct FrozenSettings final : SpectrogramSettings
+{
+   explicit FrozenSettings(const SpectrogramSettings &other)
+      : SpectrogramSettings{ other }
+   {}
+   void UpdatePrefs() override {}
+};
+
+struct Tile
+{
+   explicit Tile(long long index_) : index{ index_ } {}
+
+   const long long index;
+   //! Smaller is more urgent
+   std::atomic<long long> priority{ 0 };
+   //! Cleared when the view moves away before the tile is computed
+   std::atomic<bool> wanted{ true };
+   //! Set by the worker thread, after which cache is only read
+   std::atomic<bool> done{ false };
+   //! Whether the SpectrogramTileStore has it; used by the main thread only
+   bool stored{ false };
+   SpecCache cache;
+};
+
+}
+
+struct SpectrogramTiles::Generation
+{
+   Generation(const WaveClip &clip, int dirty_,
+      const SpectrogramSettings &settings_, double pixelsPerSecond);
+
+   bool Matches(const WaveClip &clip, int dirty_,
+      const SpectrogramSettings &settings_, double pixelsPerSecond,
+      long long lastColumn) const;
+
+   //! Sample count at the centre of a column, as for the cache of a clip
+   sampleCount Where(long long column) const
+   {
+      // Offset the display 1/2 sample to the left, as in GetSpectrogram()
+      return sampleCount(std::max(0.0, floor(1.0 + column * samplesPerPixel)));
+   }
+
+   //! Nearest column to a sample count
+   long long ColumnAt(sampleCount where) const
+   {
+      return (long long)floor((where.as_double() - 1.0) / samplesPerPixel + 0.5);
+   }
+
+   //! Spectrum of a column, if its tile is done
+   const float *Column(long long column) const;
+
+   //! Samples read for a tile
+   std::pair<sampleCount, sampleCount> Span(long long index) const;
+   //! Size the cache of a tile and position its columns
+   void Place(Tile &tile) const;
+
+   //! Called on worker threads
+   void Compute(Tile &tile, std::vector<float> &buffer) const;
+   void Read(sampleCount start, size_t len, std::vector<float> &buffer) const;
+
+   //! Names all that determines a tile, for the SpectrogramTileStore
+   /*! @param[out] blockIDs the blocks read */
+   SpectrogramTileStore::Key KeyOf(
+      long long index, std::vector<long long> &blockIDs) const;
+   //! Find a tile in the store, and if found, mark it done
+   bool Load(Tile &tile, SpectrogramTileStore &store);
+   void Save(Tile &tile, SpectrogramTileStore &store) const;
+
+   //! With its windows made by the main thread
+   const FrozenSettings settings;
+   const double pps;
+   const double rate;
+   const double samplesPerPixel;
+   const int dirty;
+   const sampleCount numSamples;
+   const size_t nBins;
+   //! The blocks of the sequence when the generation began
+   const std::vector<SeqBlock> blocks;
+
+   //! Used by the main thread only
+   std::map<long long, std::shared_ptr<Tile>> tiles;
+
+   //! Jobs of this generation in progress in worker threads
+   std::atomic<unsigned> running{ 0 };
+   std::atomic<unsigned> nDone{ 0 };
+};
+
+namespace {
+
+struct Job
+{
+   std::shared_ptr<SpectrogramTiles::Generation> generation;
+   std::shared_ptr<Tile> tile;
+};
+
+//! Runs the jobs of all clips, most urgent first, on as many threads as
+//! ParallelConcurrency() allows beside the main thread
+/*! Workers are started as jobs arrive, and then wait for more.  They are
+ never replaced, because the database prepares statements for each thread.
+ */
+class TileRenderer
+{
+public:
+   //! Call on the main thread
+   static TileRenderer &Get()
+   {
+      // Never destroyed, so that waiting workers never outlive it
+      static auto &instance = *new TileRenderer;
+      return instance;
+   }
+
+   void Submit(Job job)
+   {
+      {
+         std::lock_guard<std::mutex> guard{ mMutex };
+         mJobs.push_back(std::move(job));
+         if (mThreadCount < std::min<size_t>(mMaxThreads, mJobs.size())) {
+            ++mThreadCount;
+            std::thread{ [this]{ Work(); } }.detach();
+         }
+      }
+      mCondition.notify_one();
+   }
+
+   //! Remove the pending jobs of a generation
+   void Withdraw(const SpectrogramTiles::Generation &generation)
+   {
+      std::vector<Job> withdrawn;
+      {
+         std::lock_guard<std::mutex> guard{ mMutex };
+         const auto end = std::stable_partition(mJobs.begin(), mJobs.end(),
+            [&](const Job &job){ return job.generation.get() != &generation; });
+         std::move(end, mJobs.end(), std::back_inserter(withdrawn));
+         mJobs.erase(end, mJobs.end());
+      }
+      // Destroy the jobs after unlocking
+   }
+
+   //! Allow one more event when a tile is done
+   void ClearNotification() { mNotified.store(false); }
+
+private:
+   TileRenderer()
+      : mMaxThreads{ std::max(1u, ParallelConcurrency() - 1) }
+   {}
+
+   void Work()
+   {
+      std::vector<float> buffer;
+      while (true) {
+         Job job;
+         {
+            std::unique_lock<std::mutex> lock{ mMutex };
+            while (true) {
+               // Destroying these can't destroy a generation, which its
+               // owner keeps until it is withdrawn
+               mJobs.erase(std::remove_if(mJobs.begin(), mJobs.end(),
+                  [](const Job &job){ return !job.tile->wanted.load(); }),
+                  mJobs.end());
+               if (!mJobs.empty())
+                  break;
+               mCondition.wait(lock);
+            }
+            const auto best = std::min_element(mJobs.begin(), mJobs.end(),
+               [](const Job &a, const Job &b){
+                  return a.tile->priority.load() < b.tile->priority.load(); });
+            job = std::move(*best);
+            mJobs.erase(best);
+            ++job.generation->running;
+         }
+
+         const auto pGeneration = job.generation.get();
+         pGeneration->Compute(*job.tile, buffer);
+         ++pGeneration->nDone;
+         job.tile->done.store(true);
+         if (!mNotified.exchange(true))
+            if (auto app = wxTheApp)
+               app->QueueEvent(
+                  safenew wxCommandEvent{ EVT_SPECTROGRAM_TILES_READY });
+
+         // The owner keeps the generation until running falls to zero
+         job = {};
+         --pGeneration->running;
+      }
+   }
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::vector<Job> mJobs;
+   const unsigned mMaxThreads;
+   unsigned mThreadCount{ 0 };
+   std::atomic<bool> mNotified{ false };
+};
+
+}
+
+SpectrogramTiles::Generation::Generation(const WaveClip &clip, int dirty_,
+   const SpectrogramSettings &settings_, double pixelsPerSecond)
+   : settings{ settings_ }
+   , pps{ pixelsPerSecond }
+   , rate{ double(clip.GetRate()) }
+   , samplesPerPixel{ rate / pixelsPerSecond }
+   , dirty{ dirty_ }
+   , numSamples{ clip.GetSequenceSamplesCount() }
+   , nBins{ settings_.NBins() }
+   , blocks( clip.GetSequenceBlockArray()->begin(),
+      clip.GetSequenceBlockArray()->end() )
+{
+   settings.CacheWindows();
+   if (settings.algorithm == SpectrogramSettings::algPitchEAC) {
+      // The first FFT() makes tables that the workers then share
+      const auto windowSize = settings.WindowSize();
+      std::vector<float> zeroes(windowSize), out(windowSize);
+      ComputeSpectrum(zeroes.data(), windowSize, windowSize, rate,
+         out.data(), true, settings.windowType);
+   }
+}
+
+bool SpectrogramTiles::Generation::Matches(const WaveClip &clip, int dirty_,
+   const SpectrogramSettings &settings_, double pixelsPerSecond,
+   long long lastColumn) const
+{
+   // As for SpecCache::Matches, but the columns are counted from the start
+   // of the sequence
+   const bool ppsMatch =
+      fabs(1.0 / pixelsPerSecond - 1.0 / pps) * std::abs(lastColumn)
+         < (1.0 / rate);
+
+   return
+      ppsMatch &&
+      dirty == dirty_ &&
+      rate == clip.GetRate() &&
+      numSamples == clip.GetSequenceSamplesCount() &&
+      settings.windowType == settings_.windowType &&
+      settings.WindowSize() == settings_.WindowSize() &&
+      settings.ZeroPaddingFactor() == settings_.ZeroPaddingFactor() &&
+      settings.frequencyGain == settings_.frequencyGain &&
+      settings.algorithm == settings_.algorithm;
+}
+
+const float *SpectrogramTiles::Generation::Column(long long column) const
+{
+   const auto index = TileOf(column);
+   const auto iter = tiles.find(index);
+   if (iter == tiles.end() || !iter->second->done.load())
+      return nullptr;
+   const auto offset = column - index * (long long)TileColumns;
+   return &iter->second->cache.freq[nBins * offset];
+}
+
+std::pair<sampleCount, sampleCount>
+SpectrogramTiles::Generation::Span(long long index) const
+{
+   const auto first = index * (long long)TileColumns;
+   const auto windowSize = settings.WindowSize();
+   return {
+      std::max<sampleCount>(0, Where(first) - windowSize),
+      Where(first + (long long)TileColumns) + windowSize
+   };
+}
+
+void SpectrogramTiles::Generation::Place(Tile &tile) const
+{
+   const auto first = tile.index * (long long)TileColumns;
+   auto &cache = tile.cache;
+   cache.Grow(TileColumns, settings, pps, first / pps);
+   for (size_t xx = 0; xx <= TileColumns; ++xx)
+      cache.where[xx] = Where(first + (long long)xx);
+}
+
+void SpectrogramTiles::Generation::Compute(
+   Tile &tile, std::vector<float> &buffer) const
+{
+   Place(tile);
+   auto &cache = tile.cache;
+
+   // Read all the windows of the tile at once, unless they are far apart
+   const auto span = Span(tile.index);
+   const auto spanStart = span.first, spanEnd = span.second;
+   if (spanEnd - spanStart <= MaxTileSpan) {
+      Read(spanStart, (spanEnd - spanStart).as_size_t(), buffer);
+      cache.PopulateColumns(settings,
+         [&](sampleCount start, size_t) -> const float * {
+            return buffer.data() + (start - spanStart).as_size_t();
+         },
+         numSamples, rate, pps);
+   }
+   else
+      cache.PopulateColumns(settings,
+         [&](sampleCount start, size_t len) -> const float * {
+            Read(start, len, buffer);
+            return buffer.data();
+         },
+         numSamples, rate, pps);
+}
+
+void SpectrogramTiles::Generation::Read(
+   sampleCount start, size_t len, std::vector<float> &buffer) const
+{
+   buffer.resize(len);
+   auto dest = buffer.data();
+   auto iter = std::upper_bound(blocks.begin(), blocks.end(), start,
+      [](sampleCount where, const SeqBlock &block){
+         return where < block.start; });
+   if (iter != blocks.begin())
+      --iter;
+   for (; len > 0 && iter != blocks.end(); ++iter) {
+      const auto blockLen = iter->sb->GetSampleCount();
+      if (start < iter->start || start - iter->start >= blockLen)
+         break;
+      const auto offset = (start - iter->start).as_size_t();
+      const auto count = std::min(len, blockLen - offset);
+      // Don't throw in this drawing operation
+      const auto got = iter->sb->GetSamples(
+         reinterpret_cast<samplePtr>(dest), floatSample, offset, count, false);
+      std::fill(dest + got, dest + count, 0.0f);
+      dest += count;
+      start += count;
+      len -= count;
+   }
+   std::fill(dest, dest + len, 0.0f);
+}
+
+SpectrogramTileStore::Key
+SpectrogramTiles::Generation::KeyOf(
+   long long index, std::vector<long long> &blockIDs) const
+{
+   SpectrogramTileStore::Key key;
+   const auto put = [&key](auto value){
+      const auto bytes = reinterpret_cast<const unsigned char *>(&value);
+      key.insert(key.end(), bytes, bytes + sizeof(value));
+   };
+   put(StoreVersion);
+   put(settings.algorithm);
+   put(settings.windowType);
+   put(settings.WindowSize());
+   put(settings.ZeroPaddingFactor());
+   put(settings.frequencyGain);
+   put(rate);
+   put(pps);
+   put(index);
+
+   // The blocks, and where they are, in place of the samples.  Columns past
+   // the end of the sequence are zero.
+   const auto [spanStart, spanEnd] = Span(index);
+   put(std::min(spanEnd, numSamples).as_long_long());
+   blockIDs.clear();
+   auto iter = std::upper_bound(blocks.begin(), blocks.end(), spanStart,
+      [](sampleCount where, const SeqBlock &block){
+         return where < block.start; });
+   if (iter != blocks.begin())
+      --iter;
+   for (; iter != blocks.end() && iter->start < spanEnd; ++iter) {
+      const auto id = iter->sb->GetBlockID();
+      put(id);
+      put(iter->start.as_long_long());
+      blockIDs.push_back(id);
+   }
+   return key;
+}
+
+bool SpectrogramTiles::Generation::Load(
+   Tile &tile, SpectrogramTileStore &store)
+{
+   Place(tile);
+   std::vector<long long> blockIDs;
+   if (!store.Load(KeyOf(tile.index, blockIDs), tile.cache.freq))
+      return false;
+   tile.stored = true;
+   ++nDone;
+   tile.done.store(true);
+   return true;
+}
+
+void SpectrogramTiles::Generation::Save(
+   Tile &tile, SpectrogramTileStore &store) const
+{
+   std::vector<long long> blockIDs;
+   const auto key = KeyOf(tile.index, blockIDs);
+   store.Save(key, blockIDs, tile.cache.freq);
+   tile.stored = true;
+}
+
+SpectrogramTiles::SpectrogramTiles() = default;
+
+SpectrogramTiles::~SpectrogramTiles()
+{
+   Retire(mCurrent);
+   Retire(mPrevious);
+   while (!mRetired.empty()) {
+      ReleaseRetired();
+      if (!mRetired.empty())
+         std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   }
+}
+
+void SpectrogramTiles::Retire(std::shared_ptr<Generation> &pGeneration)
+{
+   if (!pGeneration)
+      return;
+   TileRenderer::Get().Withdraw(*pGeneration);
+   mRetired.push_back(std::move(pGeneration));
+   pGeneration.reset();
+}
+
+void SpectrogramTiles::ReleaseRetired()
+{
+   mRetired.erase(std::remove_if(mRetired.begin(), mRetired.end(),
+      [](const std::shared_ptr<Generation> &pGeneration){
+         return pGeneration->running.load() == 0; }),
+      mRetired.end());
+}
+
+bool SpectrogramTiles::Fill(const WaveClip &clip, AudacityProject *pProject,
+   int dirty,
+   const SpectrogramSettings &settings, double pixelsPerSecond,
+   long long firstColumn, SpecCache &cache, bool force)
+{
+   auto &renderer = TileRenderer::Get();
+   renderer.ClearNotification();
+   ReleaseRetired();
+
+   const auto width = cache.len;
+   const auto lastColumn = firstColumn + (long long)width;
+   bool changed = force;
+   int direction = 0;
+
+   if (mCurrent &&
+       mCurrent->Matches(clip, dirty, settings, pixelsPerSecond, lastColumn))
+      direction = (firstColumn > mLastFirstColumn) -
+         (firstColumn < mLastFirstColumn);
+   else {
+      // Keep whichever earlier generation has more to show meanwhile
+      if (mCurrent && mCurrent->nDone.load() > 0) {
+         Retire(mPrevious);
+         renderer.Withdraw(*mCurrent);
+         mPrevious = std::move(mCurrent);
+      }
+      else
+         Retire(mCurrent);
+      if (mPrevious && mPrevious->nBins != settings.NBins())
+         Retire(mPrevious);
+      mCurrent = std::make_shared<Generation>(
+         clip, dirty, settings, pixelsPerSecond);
+      changed = true;
+   }
+   auto &generation = *mCurrent;
+   const auto nBins = generation.nBins;
+
+   // Columns of the other algorithms are cheap, or can't be stored in tiles
+   SpectrogramTileStore *pStore = nullptr;
+   if (pProject &&
+       generation.settings.algorithm == SpectrogramSettings::algSTFT) {
+      auto &store = SpectrogramTileStore::Get(*pProject);
+      if (store.IsEnabled())
+         pStore = &store;
+   }
+
+   // Request the tiles in view, nearest the middle first, then one more
+   // width in the direction of scrolling
+   const auto firstTile = TileOf(firstColumn);
+   const auto lastTile = TileOf(std::max(firstColumn, lastColumn - 1));
+   const auto middle = (firstTile + lastTile) / 2;
+   const auto endTile =
+      TileOf(generation.ColumnAt(generation.numSamples));
+   const auto span = lastTile - firstTile + 1;
+   auto wantFirst = firstTile, wantLast = lastTile;
+   if (direction > 0)
+      wantLast += span;
+   else if (direction < 0)
+      wantFirst -= span;
+   wantFirst = std::max(wantFirst, std::min(firstTile, 0LL));
+   wantLast = std::min(wantLast, std::max(lastTile, endTile));
+
+   unsigned nDone = 0;
+   for (auto index = wantFirst; index <= wantLast; ++index) {
+      const long long priority =
+         (index < firstTile || index > lastTile ? PrefetchPriority : 0) +
+         std::abs(index - middle);
+      auto &pTile = generation.tiles[index];
+      if (!pTile) {
+         pTile = std::make_shared<Tile>(index);
+         pTile->priority.store(priority);
+         if (!(pStore && generation.Load(*pTile, *pStore)))
+            renderer.Submit({ mCurrent, pTile });
+      }
+      else
+         pTile->priority.store(priority);
+      if (index >= firstTile && index <= lastTile && pTile->done.load())
+         ++nDone;
+   }
+
+   // Keep what the workers have finished since
+   if (pStore)
+      for (auto &[index, pTile] : generation.tiles)
+         if (!pTile->stored && pTile->done.load())
+            generation.Save(*pTile, *pStore);
+
+   // Stand-ins matter only until the view is complete
+   if (mPrevious && nDone < span)
+      nDone += 1 + mPrevious->nDone.load();
+
+   // Forget tiles more than a width away, unless just scrolled past
+   for (auto iter = generation.tiles.begin();
+        iter != generation.tiles.end();) {
+      const auto index = iter->first;
+      if (index < wantFirst - span || index > wantLast + span) {
+         iter->second->wanted.store(false);
+         iter = generation.tiles.erase(iter);
+      }
+      else
+         ++iter;
+   }
+
+   if (!changed && firstColumn == mLastFirstColumn &&
+       width == mLastWidth && nDone == mLastDone)
+      return false;
+   mLastFirstColumn = firstColumn;
+   mLastWidth = width;
+   mLastDone = nDone;
+
+   // Assemble the cache from the tiles, or stand-ins
+   for (size_t xx = 0; xx <= width; ++xx)
+      cache.where[xx] = generation.Where(firstColumn + (long long)xx);
+   mComplete = true;
+   for (size_t xx = 0; xx < width; ++xx) {
+      float *const results = &cache.freq[nBins * xx];
+      auto column = generation.Column(firstColumn + (long long)xx);
+      if (!column) {
+         mComplete = false;
+         if (mPrevious)
+            column = mPrevious->Column(
+               mPrevious->ColumnAt(cache.where[xx]));
+      }
+      if (column)
+         std::copy(column, column + nBins, results);
+      else
+         std::fill(results, results + nBins, Silence);
+   }
+   if (mComplete)
+      Retire(mPrevious);
+
+   return true;
+}
@@ -0,0 +1,85 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrogramTiles.h
+
+  Columns of the spectrogram of a clip, computed by worker threads so that
+  painting never waits for the FFTs.
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SPECTROGRAM_TILES__
+#define __AUDACITY_SPECTROGRAM_TILES__
+
+#include <memory>
+#include <vector>
+#include <wx/event.h> // to declare custom event type
+
+class AudacityProject;
+class SpecCache;
+class SpectrogramSettings;
+class WaveClip;
+
+//! Sent to the application object, from any thread, when tiles requested by
+//! SpectrogramTiles::Fill() are done
+wxDECLARE_EXPORTED_EVENT(AUDACITY_DLL_API,
+                         EVT_SPECTROGRAM_TILES_READY, wxCommandEvent);
+
+//! Spectrogram of one clip, in tiles of a fixed number of pixel columns
+/*!
+ Columns are numbered from the start of the clip's sequence, so that tiles
+ remain good as the view scrolls.  Tiles are computed by worker threads,
+ those nearest the view first; painting takes whatever is done.  Until
+ replaced, the tiles for the previous zoom level or settings stand in for
+ tiles not yet computed.
+
+ Reassignment is not handled, because its columns are not independent.
+
+ Member functions must be called on the main thread.
+ */
+class AUDACITY_DLL_API SpectrogramTiles final
+{
+public:
+   //! Pixel columns in each tile
+   static constexpr size_t TileColumns = 64;
+
+   SpectrogramTiles();
+   //! Withdraws pending tiles, and waits for those in progress
+   ~SpectrogramTiles();
+
+   //! Fill cache with columns beginning at firstColumn
+   /*!
+    @param pProject if not null, tiles are also loaded from and saved to its
+    SpectrogramTileStore
+    @param cache was grown to its width for the settings and zoom
+    @param force whether to write cache even if the result is unchanged
+    @return whether cache changed
+    */
+   bool Fill(const WaveClip &clip, AudacityProject *pProject, int dirty,
+      const SpectrogramSettings &settings, double pixelsPerSecond,
+      long long firstColumn, SpecCache &cache, bool force);
+
+   //! Whether all columns of the last Fill() came from finished tiles
+   bool IsComplete() const { return mComplete; }
+
+   struct Generation;
+
+private:
+   void Retire(std::shared_ptr<Generation> &pGeneration);
+   void ReleaseRetired();
+
+   //! Tiles for the present zoom level and settings
+   std::shared_ptr<Generation> mCurrent;
+   //! Tiles for the previous ones, as stand-ins
+   std::shared_ptr<Generation> mPrevious;
+   //! Generations that worker threads may still be using
+   std::vector<std::shared_ptr<Generation>> mRetired;
+
+   long long mLastFirstColumn{ 0 };
+   size_t mLastWidth{ 0 };
+   unsigned mLastDone{ 0 };
+   bool mComplete{ false };
+};
+
+#endif
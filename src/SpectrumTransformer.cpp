@@ -12,8 +12,14 @@ Edward Hui
 
 #include <algorithm>
 #include "FFT.h"
+#include "ParallelFor.h"
 #include "WaveTrack.h"
 
+namespace {
+//! Bounds the memory used for the spectra of one batch of windows
+constexpr size_t MaxBatchSamples = 1 << 20;
+}
+
 SpectrumTransformer::SpectrumTransformer( bool needsOutput,
    eWindowFunctions inWindowType,
    eWindowFunctions outWindowType,
@@ -29,7 +35,9 @@ SpectrumTransformer::SpectrumTransformer( bool needsOutput,
 , mFFTBuffer( mWindowSize )
 , mInWaveBuffer( mWindowSize )
 , mOutOverlapBuffer( mWindowSize )
+, mOutWaveBuffer( mWindowSize )
 , mNeedsOutput{ needsOutput }
+, mConcurrency{ ParallelConcurrency() }
 {
    // Check preconditions
 
@@ -153,18 +161,17 @@ bool SpectrumTransformer::Start(size_t queueLength)
 bool SpectrumTransformer::ProcessSamples( const WindowProcessor &processor,
    const float *buffer, size_t len )
 {
-   if (buffer)
+   if (buffer) {
       mInSampleCount += len;
+      return ProcessBatches(processor, buffer, len);
+   }
+
+   // Flushing the end, one step at a time
    bool success = true;
    while (success && len &&
           mOutStepCount * static_cast<int>(mStepSize) < mInSampleCount) {
       auto avail = std::min(len, mWindowSize - mInWavePos);
-      if (buffer)
-         memmove(&mInWaveBuffer[mInWavePos], buffer, avail * sizeof(float));
-      else
-         memset(&mInWaveBuffer[mInWavePos], 0, avail * sizeof(float));
-      if (buffer)
-         buffer += avail;
+      memset(&mInWaveBuffer[mInWavePos], 0, avail * sizeof(float));
       len -= avail;
       mInWavePos += avail;
 
@@ -188,6 +195,104 @@ bool SpectrumTransformer::ProcessSamples( const WindowProcessor &processor,
    return success;
 }
 
+bool SpectrumTransformer::ProcessBatches(const WindowProcessor &processor,
+   const float *buffer, size_t len)
+{
+   // The input is what remains in mInWaveBuffer, followed by buffer.
+   // The forward transforms depend on nothing else, so a batch of them is
+   // done in parallel before the processor visits the windows in order.
+   // Then the inverse transforms of the finished windows are done in
+   // parallel, before the overlap-add, again in order.
+   const auto total = mInWavePos + len;
+   const size_t nWindows = total < mWindowSize
+      ? 0 : 1 + (total - mWindowSize) / mStepSize;
+   const auto batchSize = std::max<size_t>(1, MaxBatchSamples / mWindowSize);
+   const auto nThreads = mConcurrency;
+   if (nWindows > 0 && mScratch.size() < nThreads)
+      mScratch.resize(nThreads, FloatVector(mWindowSize));
+
+   // Call body for contiguous ranges of [0, count), one range per thread
+   const auto forRanges = [nThreads](size_t count,
+      const std::function<void(size_t, size_t, float*)> &body, auto &scratch){
+      const auto nRanges = std::min<size_t>(nThreads, count);
+      ParallelFor(nRanges, [&](size_t range){
+         body(count * range / nRanges, count * (range + 1) / nRanges,
+            scratch[range].data());
+      }, nThreads);
+   };
+
+   bool success = true;
+   for (size_t first = 0; success && first < nWindows; first += batchSize) {
+      const auto count = std::min(batchSize, nWindows - first);
+      while (mInBatch.size() < count)
+         mInBatch.push_back(std::make_unique<Window>(mWindowSize));
+      if (mNeedsOutput)
+         while (mOutBatch.size() < count) {
+            mOutBatch.push_back(std::make_unique<Window>(mWindowSize));
+            mOutWaves.emplace_back(mWindowSize);
+            mOutBatchOutputs.push_back(false);
+         }
+
+      forRanges(count, [&](size_t begin, size_t end, float *scratch){
+         for (auto ii = begin; ii < end; ++ii) {
+            const auto pos = (first + ii) * mStepSize;
+            const auto len0 = pos < mInWavePos ? mInWavePos - pos : 0;
+            ForwardTransform(len0 ? &mInWaveBuffer[pos] : nullptr, len0,
+               buffer + (pos + len0 - mInWavePos), *mInBatch[ii], scratch);
+         }
+      }, mScratch);
+
+      size_t nOut = 0;
+      for (size_t ii = 0; ii < count; ++ii) {
+         // Exchange contents with the recycled window, without copying
+         auto &newest = Newest();
+         newest.mRealFFTs.swap(mInBatch[ii]->mRealFFTs);
+         newest.mImagFFTs.swap(mInBatch[ii]->mImagFFTs);
+
+         // invoke derived method
+         if (!(success = processor(*this)))
+            break;
+
+         // The last window is finished with; save it for inverse transform
+         if (mNeedsOutput && QueueIsFull()) {
+            auto &latest = Latest();
+            latest.mRealFFTs.swap(mOutBatch[nOut]->mRealFFTs);
+            latest.mImagFFTs.swap(mOutBatch[nOut]->mImagFFTs);
+            mOutBatchOutputs[nOut] = (mOutStepCount >= 0);
+            ++nOut;
+         }
+
+         ++mOutStepCount;
+         RotateWindows();
+      }
+
+      forRanges(nOut, [&](size_t begin, size_t end, float *scratch){
+         for (auto ii = begin; ii < end; ++ii)
+            InverseTransform(*mOutBatch[ii], scratch, mOutWaves[ii].data());
+      }, mScratch);
+      for (size_t ii = 0; ii < nOut; ++ii)
+         OverlapAdd(mOutWaves[ii].data(), mOutBatchOutputs[ii]);
+   }
+
+   if (!success)
+      return false;
+
+   // Keep the samples that begin the next window
+   const auto consumed = nWindows * mStepSize;
+   if (consumed < mInWavePos) {
+      memmove(mInWaveBuffer.data(), &mInWaveBuffer[consumed],
+         (mInWavePos - consumed) * sizeof(float));
+      memmove(&mInWaveBuffer[mInWavePos - consumed], buffer,
+         len * sizeof(float));
+   }
+   else
+      memmove(mInWaveBuffer.data(), buffer + (consumed - mInWavePos),
+         (total - consumed) * sizeof(float));
+   mInWavePos = total - consumed;
+
+   return true;
+}
+
 void SpectrumTransformer::ResizeQueue(size_t queueLength)
 {
    int oldLen = mQueue.size();
@@ -199,21 +304,27 @@ void SpectrumTransformer::ResizeQueue(size_t queueLength)
 }
 
 void SpectrumTransformer::FillFirstWindow()
+{
+   ForwardTransform(mInWaveBuffer.data(), mWindowSize, nullptr,
+      Nth(0), mFFTBuffer.data());
+}
+
+void SpectrumTransformer::ForwardTransform(const float *in0, size_t len0,
+   const float *in1, Window &record, float *scratch) const
 {
    // Transform samples to frequency domain, windowed as needed
-   {
-      auto pFFTBuffer = mFFTBuffer.data(), pInWaveBuffer = mInWaveBuffer.data();
-      if (mInWindow.size() > 0) {
-         auto pInWindow = mInWindow.data();
-         for (size_t ii = 0; ii < mWindowSize; ++ii)
-            *pFFTBuffer++ = *pInWaveBuffer++ * *pInWindow++;
-      }
-      else
-         memmove(pFFTBuffer, pInWaveBuffer, mWindowSize * sizeof(float));
+   if (mInWindow.size() > 0) {
+      auto pInWindow = mInWindow.data();
+      for (size_t ii = 0; ii < len0; ++ii)
+         scratch[ii] = in0[ii] * pInWindow[ii];
+      for (size_t ii = len0; ii < mWindowSize; ++ii)
+         scratch[ii] = in1[ii - len0] * pInWindow[ii];
    }
-   RealFFTf(mFFTBuffer.data(), hFFT.get());
-
-   auto &record = Nth(0);
+   else {
+      std::copy(in0, in0 + len0, scratch);
+      std::copy(in1, in1 + (mWindowSize - len0), scratch + len0);
+   }
+   RealFFTf(scratch, hFFT.get());
 
    // Store real and imaginary parts for later inverse FFT
    {
@@ -223,14 +334,14 @@ void SpectrumTransformer::FillFirstWindow()
       const auto last = mSpectrumSize - 1;
       for (size_t ii = 1; ii < last; ++ii) {
          const int kk = *pBitReversed++;
-         *pReal++ = mFFTBuffer[kk];
-         *pImag++ = mFFTBuffer[kk + 1];
+         *pReal++ = scratch[kk];
+         *pImag++ = scratch[kk + 1];
       }
       // DC and Fs/2 bins need to be handled specially
-      const float dc = mFFTBuffer[0];
+      const float dc = scratch[0];
       record.mRealFFTs[0] = dc;
 
-      const float nyquist = mFFTBuffer[1];
+      const float nyquist = scratch[1];
       record.mImagFFTs[0] = nyquist; // For Fs/2, not really imaginary
    }
 }
@@ -281,55 +392,64 @@ void SpectrumTransformer::OutputStep()
    if (!mNeedsOutput)
       return;
    if (QueueIsFull()) {
-      const auto last = mSpectrumSize - 1;
-      Window &record = **mQueue.rbegin();
-
-      const float *pReal = &record.mRealFFTs[1];
-      const float *pImag = &record.mImagFFTs[1];
-      float *pBuffer = &mFFTBuffer[2];
-      auto nn = mSpectrumSize - 2;
-      for (; nn--;) {
-         *pBuffer++ = *pReal++;
-         *pBuffer++ = *pImag++;
-      }
-      mFFTBuffer[0] = record.mRealFFTs[0];
-      // The Fs/2 component is stored as the imaginary part of the DC component
-      mFFTBuffer[1] = record.mImagFFTs[0];
-
-      // Invert the FFT into the output buffer
-      InverseRealFFTf(mFFTBuffer.data(), hFFT.get());
-
-      // Overlap-add
-      if (mOutWindow.size() > 0) {
-         auto pOut = mOutOverlapBuffer.data();
-         auto pWindow = mOutWindow.data();
-         auto pBitReversed = &hFFT->BitReversed[0];
-         for (size_t jj = 0; jj < last; ++jj) {
-            auto kk = *pBitReversed++;
-            *pOut++ += mFFTBuffer[kk] * (*pWindow++);
-            *pOut++ += mFFTBuffer[kk + 1] * (*pWindow++);
-         }
-      }
-      else {
-         auto pOut = mOutOverlapBuffer.data();
-         auto pBitReversed = &hFFT->BitReversed[0];
-         for (size_t jj = 0; jj < last; ++jj) {
-            auto kk = *pBitReversed++;
-            *pOut++ += mFFTBuffer[kk];
-            *pOut++ += mFFTBuffer[kk + 1];
-         }
+      InverseTransform(Latest(), mFFTBuffer.data(), mOutWaveBuffer.data());
+      OverlapAdd(mOutWaveBuffer.data(), mOutStepCount >= 0);
+   }
+}
+
+void SpectrumTransformer::InverseTransform(const Window &record,
+   float *scratch, float *wave) const
+{
+   const auto last = mSpectrumSize - 1;
+
+   const float *pReal = &record.mRealFFTs[1];
+   const float *pImag = &record.mImagFFTs[1];
+   float *pBuffer = &scratch[2];
+   auto nn = mSpectrumSize - 2;
+   for (; nn--;) {
+      *pBuffer++ = *pReal++;
+      *pBuffer++ = *pImag++;
+   }
+   scratch[0] = record.mRealFFTs[0];
+   // The Fs/2 component is stored as the imaginary part of the DC component
+   scratch[1] = record.mImagFFTs[0];
+
+   // Invert the FFT into the output buffer
+   InverseRealFFTf(scratch, hFFT.get());
+
+   // Undo the bit reversal, and apply the window
+   auto pBitReversed = &hFFT->BitReversed[0];
+   if (mOutWindow.size() > 0) {
+      auto pWindow = mOutWindow.data();
+      for (size_t jj = 0; jj < last; ++jj) {
+         auto kk = *pBitReversed++;
+         *wave++ = scratch[kk] * (*pWindow++);
+         *wave++ = scratch[kk + 1] * (*pWindow++);
       }
-      auto buffer = mOutOverlapBuffer.data();
-      if (mOutStepCount >= 0) {
-         // Output the first portion of the overlap buffer, they're done
-         DoOutput(buffer, mStepSize);
+   }
+   else {
+      for (size_t jj = 0; jj < last; ++jj) {
+         auto kk = *pBitReversed++;
+         *wave++ = scratch[kk];
+         *wave++ = scratch[kk + 1];
       }
-      // Shift the remainder over.
-      memmove(buffer, buffer + mStepSize, sizeof(float)*(mWindowSize - mStepSize));
-      std::fill(buffer + mWindowSize - mStepSize, buffer + mWindowSize, 0.0f);
    }
 }
 
+void SpectrumTransformer::OverlapAdd(const float *wave, bool output)
+{
+   auto buffer = mOutOverlapBuffer.data();
+   for (size_t ii = 0; ii < mWindowSize; ++ii)
+      buffer[ii] += wave[ii];
+   if (output) {
+      // Output the first portion of the overlap buffer, they're done
+      DoOutput(buffer, mStepSize);
+   }
+   // Shift the remainder over.
+   memmove(buffer, buffer + mStepSize, sizeof(float)*(mWindowSize - mStepSize));
+   std::fill(buffer + mWindowSize - mStepSize, buffer + mWindowSize, 0.0f);
+}
+
 bool SpectrumTransformer::QueueIsFull() const
 {
    if (mLeadingPadding)
@@ -70,6 +70,8 @@ public:
 
    //! Call multiple times
    /*!
+    The FFTs of the windows of buffer are computed in batches, on several
+    threads; but the processor and DoOutput are called in order, on this one.
     @param buffer null if flushing the end
     @return success */
    bool ProcessSamples(const WindowProcessor &processor,
@@ -148,6 +150,20 @@ private:
    void RotateWindows();
    void OutputStep();
 
+   //! Window and transform mWindowSize samples into record
+   /*! The first len0 samples are at in0, and the rest at in1 */
+   void ForwardTransform(const float *in0, size_t len0, const float *in1,
+      Window &record, float *scratch) const;
+   //! Inverse transform record into mWindowSize samples of wave, windowed
+   void InverseTransform(const Window &record, float *scratch,
+      float *wave) const;
+   //! Add the result of InverseTransform to the overlap buffer, and shift it
+   void OverlapAdd(const float *wave, bool output);
+
+   //! Handle all complete windows in buffer, transforming them in batches
+   bool ProcessBatches(const WindowProcessor &processor,
+      const float *buffer, size_t len);
+
 protected:
    const size_t mWindowSize;
    const size_t mSpectrumSize;
@@ -170,11 +186,27 @@ private:
    FloatVector mFFTBuffer;
    FloatVector mInWaveBuffer;
    FloatVector mOutOverlapBuffer;
+   FloatVector mOutWaveBuffer;
    //! These have size mWindowSize, or 0 for rectangular window:
    FloatVector mInWindow;
    FloatVector mOutWindow;
 
+   //! Pooled for ProcessBatches, and grown only as needed:
+   //! Spectra transformed ahead of the processor
+   std::vector<std::unique_ptr<Window>> mInBatch;
+   //! Finished spectra waiting for the inverse transform
+   std::vector<std::unique_ptr<Window>> mOutBatch;
+   //! Inverse transforms of mOutBatch, each of size mWindowSize
+   std::vector<FloatVector> mOutWaves;
+   //! Whether each of mOutBatch produces output
+   std::vector<bool> mOutBatchOutputs;
+   //! Scratch buffers of size mWindowSize, one for each thread
+   std::vector<FloatVector> mScratch;
+
    const bool mNeedsOutput;
+   //! Threads for batches, read from preferences at construction, so that
+   //! the transformer may run in a worker thread
+   const unsigned mConcurrency;
 };
 
 class WaveTrack;
@@ -75,10 +75,12 @@ is time to refresh some aspect of the screen.
 
 #include "Prefs.h"
 #include "RefreshCode.h"
+#include "SpectrogramTiles.h"
 #include "TrackArtist.h"
 #include "TrackPanelAx.h"
 #include "TrackPanelResizerCell.h"
 #include "WaveTrack.h"
+#include "tracks/playabletrack/wavetrack/ui/WaveTrackView.h"
 
 #include "tracks/ui/TrackControls.h"
 #include "tracks/ui/TrackView.h"
@@ -321,6 +323,9 @@ TrackPanel::TrackPanel(wxWindow * parent, wxWindowID id,
    wxTheApp->Bind(EVT_AUDIOIO_CAPTURE,
                      &TrackPanel::OnAudioIO,
                      this);
+   wxTheApp->Bind(EVT_SPECTROGRAM_TILES_READY,
+                     &TrackPanel::OnSpectrogramTilesReady,
+                     this);
    UpdatePrefs();
 }
 
@@ -440,10 +445,16 @@ void TrackPanel::OnTimer(wxTimerEvent& )
       // Periodically update the display while recording
 
       if ((mTimeCount % 5) == 0) {
-         // Must tell OnPaint() to recreate the backing bitmap
-         // since we've not done a full refresh.
-         mRefreshBacking = true;
-         Refresh( false );
+         // Redraw only the tracks being recorded:  those with pending
+         // changes, and new ones, which have no id yet
+         for (auto pTrack : GetTracks()->Leaders()) {
+            const auto channels = TrackList::Channels(pTrack);
+            if (channels.any_of([](const Track *pChannel){
+                  return pChannel->GetId() == TrackId{} ||
+                     pChannel->SubstitutePendingChangedTrack().get()
+                        != pChannel; }))
+               RefreshTrack(pTrack);
+         }
       }
    }
    if(mTimeCount > 1000)
@@ -491,6 +502,7 @@ void TrackPanel::OnPaint(wxPaintEvent & /* event */)
       {
          // Reset (should a mutex be used???)
          mRefreshBacking = false;
+         mDirtyRegion.Clear();
 
          // Redraw the backing bitmap
          DrawTracks(&GetBackingDCForRepaint());
@@ -500,6 +512,17 @@ void TrackPanel::OnPaint(wxPaintEvent & /* event */)
       }
       else
       {
+         // Redraw in the backing bitmap only the cells that changed; the
+         // rest of it is good
+         if (!mDirtyRegion.IsEmpty()) {
+            auto &backingDC = GetBackingDCForRepaint();
+            {
+               wxDCClipper clipper{ backingDC, mDirtyRegion };
+               DrawTracks(&backingDC, mDirtyRegion.GetBox());
+            }
+            mDirtyRegion.Clear();
+         }
+
          // Copy full, possibly clipped, damage rectangle
          RepairBitmap(dc, box.x, box.y, box.width, box.height);
       }
@@ -780,7 +803,8 @@ void TrackPanel::RefreshTrack(Track *trk, bool refreshbacking)
    wxRect rect(left, top, width, height);
 
    if( refreshbacking )
-      mRefreshBacking = true;
+      // OnPaint() redraws this part of the backing bitmap only
+      mDirtyRegion.Union(rect);
 
    Refresh( false, &rect );
 }
@@ -818,6 +842,21 @@ void TrackPanel::OnAudioIO(wxCommandEvent & evt)
    CallAfter( [this]{ CellularPanel::HandleCursorForPresentMouseState(); } );
 }
 
+void TrackPanel::OnSpectrogramTilesReady(wxCommandEvent & evt)
+{
+   evt.Skip();
+   // Spectrograms show the tiles finished since the last paint
+   for (auto wt : GetTracks()->Leaders< WaveTrack >()) {
+      const auto displays = WaveTrackView::Get( *wt ).GetDisplays();
+      bool hasSpectrum = (displays.end() != std::find(
+         displays.begin(), displays.end(),
+         WaveTrackSubView::Type{ WaveTrackViewConstants::Spectrum, {} }
+      ) );
+      if ( hasSpectrum )
+         RefreshTrack( wt );
+   }
+}
+
 #include "TrackPanelDrawingContext.h"
 
 /// Draw the actual track areas.  We only draw the borders
@@ -825,10 +864,11 @@ void TrackPanel::OnAudioIO(wxCommandEvent & evt)
 /// actual contents of each track are drawn by the TrackArtist.
 void TrackPanel::DrawTracks(wxDC * dc)
 {
-   wxRegion region = GetUpdateRegion();
-
-   const wxRect clip = GetRect();
+   DrawTracks(dc, GetClientRect());
+}
 
+void TrackPanel::DrawTracks(wxDC * dc, const wxRect &area)
+{
    const SelectedRegion &sr = mViewInfo->selectedRegion;
    mTrackArtist->pSelectedRegion = &sr;
    mTrackArtist->pZoomInfo = mViewInfo;
@@ -864,7 +904,7 @@ void TrackPanel::DrawTracks(wxDC * dc)
    mTrackArtist->onBrushTool = brushFlag;
    mTrackArtist->hasSolo = hasSolo;
 
-   this->CellularPanel::Draw( context, TrackArtist::NPasses );
+   this->CellularPanel::Draw( context, TrackArtist::NPasses, area );
 }
 
 void TrackPanel::SetBackgroundCell
@@ -16,6 +16,7 @@
 
 #include <vector>
 
+#include <wx/region.h> // member variable
 #include <wx/setup.h> // for wxUSE_* macros
 #include <wx/timer.h> // to inherit
 
@@ -83,6 +84,7 @@ class AUDACITY_DLL_API TrackPanel final
    void UpdatePrefs() override;
 
    void OnAudioIO(wxCommandEvent & evt);
+   void OnSpectrogramTilesReady(wxCommandEvent & evt);
 
    void OnPaint(wxPaintEvent & event);
    void OnMouseEvent(wxMouseEvent & event);
@@ -174,6 +176,8 @@ public:
 
 protected:
    void DrawTracks(wxDC * dc);
+   //! Redraw only the cells that intersect area
+   void DrawTracks(wxDC * dc, const wxRect &area);
 
 public:
    // Set the object that performs catch-all event handling when the pointer
@@ -212,6 +216,8 @@ protected:
    int mTimeCount;
 
    bool mRefreshBacking;
+   //! Parts of the backing bitmap to redraw, less than the whole
+   wxRegion mDirtyRegion;
 
 
 protected:
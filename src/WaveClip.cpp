@@ -29,6 +29,8 @@
 
 #include "Sequence.h"
 #include "Spectrum.h"
+#include "SpectrumKernels.h"
+#include "SpectrogramTiles.h"
 #include "Prefs.h"
 #include "Envelope.h"
 #include "Resample.h"
@@ -118,6 +120,58 @@ static void ComputeSpectrumUsingRealFFTf
    }
 }
 
+// As ComputeSpectrumUsingRealFFTf, after the transform, for one lane of
+// RealFFTfLanes
+static void ComputeSpectrumOfLane
+   (const float * __restrict buffer, size_t lane, const FFTParam *hFFT,
+    float * __restrict out)
+{
+   const auto at = [&](size_t i){ return buffer[FFTLanes * i + lane]; };
+   // Handle the (real-only) DC
+   float power = at(0) * at(0);
+   if(power <= 0)
+      out[0] = -160.0;
+   else
+      out[0] = 10.0 * log10f(power);
+   for(size_t i = 1; i < hFFT->Points; i++) {
+      const int index = hFFT->BitReversed[i];
+      const float re = at(index), im = at(index + 1);
+      power = re * re + im * im;
+      if(power <= 0)
+         out[i] = -160.0;
+      else
+         out[i] = 10.0*log10f(power);
+   }
+}
+
+// Take a window of the track centered at from, padded with zeroes where it
+// extends beyond the clip, and also before and after for zero padding.
+// Return false if from itself is outside the clip.
+static bool ReadSpectrumWindow
+   (const SpectrumSampleReader &getFloats,
+    sampleCount from, sampleCount numSamples,
+    size_t windowSize, size_t padding, size_t fftLen, float *buffer)
+{
+   if (from < 0 || from >= numSamples)
+      return false;
+   std::fill(buffer, buffer + fftLen, 0.0f);
+   float *adj = buffer + padding;
+   auto myLen = windowSize;
+   from -= windowSize >> 1;
+   if (from < 0) {
+      adj += -from.as_long_long();
+      myLen += from.as_long_long(); // add a negative
+      from = 0;
+   }
+   if (from + myLen >= numSamples)
+      myLen = ( numSamples - from ).as_size_t();
+   if (myLen > 0) {
+      if (auto src = getFloats(from, myLen))
+         std::copy(src, src + myLen, adj);
+   }
+   return true;
+}
+
 WaveClip::WaveClip(const SampleBlockFactoryPtr &factory,
                    sampleFormat format, int rate, int colourIndex)
 {
@@ -564,9 +618,9 @@ bool SpecCache::Matches
 
 bool SpecCache::CalculateOneSpectrum
    (const SpectrogramSettings &settings,
-    WaveTrackCache &waveTrackCache,
+    const SpectrumSampleReader &getFloats,
     const int xx, const sampleCount numSamples,
-    double offset, double rate, double pixelsPerSecond,
+    double rate, double pixelsPerSecond,
     int lowerBoundX, int upperBoundX,
     const std::vector<float> &gainFactors,
     float* __restrict scratch, float* __restrict out) const
@@ -640,14 +694,7 @@ bool SpecCache::CalculateOneSpectrum
          }
 
          if (myLen > 0) {
-            useBuffer = (float*)(waveTrackCache.GetFloats(
-               sampleCount(
-                  floor(0.5 + from.as_double() + offset * rate)
-               ),
-               myLen,
-               // Don't throw in this drawing operation
-               false)
-            );
+            useBuffer = (float*)getFloats(from, myLen);
 
             if (copy) {
                if (useBuffer)
@@ -675,30 +722,30 @@ bool SpecCache::CalculateOneSpectrum
          const auto hFFT = settings.hFFT.get();
 
          float *const scratch2 = scratch + fftLen;
-         std::copy(scratch, scratch2, scratch2);
-
          float *const scratch3 = scratch + 2 * fftLen;
-         std::copy(scratch, scratch2, scratch3);
 
          {
+            // Do the three transforms at once, in lanes
+            static_assert(FFTLanes >= 3);
+            float *const lanes = scratch + 3 * fftLen;
             const float *const window = settings.window.get();
-            for (size_t ii = 0; ii < fftLen; ++ii)
-               scratch[ii] *= window[ii];
-            RealFFTf(scratch, hFFT);
-         }
-
-         {
             const float *const dWindow = settings.dWindow.get();
-            for (size_t ii = 0; ii < fftLen; ++ii)
-               scratch2[ii] *= dWindow[ii];
-            RealFFTf(scratch2, hFFT);
-         }
-
-         {
             const float *const tWindow = settings.tWindow.get();
-            for (size_t ii = 0; ii < fftLen; ++ii)
-               scratch3[ii] *= tWindow[ii];
-            RealFFTf(scratch3, hFFT);
+            for (size_t ii = 0; ii < fftLen; ++ii) {
+               float *const group = lanes + FFTLanes * ii;
+               const float sample = scratch[ii];
+               group[0] = sample * window[ii];
+               group[1] = sample * dWindow[ii];
+               group[2] = sample * tWindow[ii];
+               std::fill(group + 3, group + FFTLanes, 0.0f);
+            }
+            RealFFTfLanes(lanes, *hFFT);
+            for (size_t ii = 0; ii < fftLen; ++ii) {
+               const float *const group = lanes + FFTLanes * ii;
+               scratch[ii] = group[0];
+               scratch2[ii] = group[1];
+               scratch3[ii] = group[2];
+            }
          }
 
          for (size_t ii = 0; ii < hFFT->Points; ++ii) {
@@ -809,12 +856,32 @@ void SpecCache::Grow(size_t len_, const SpectrogramSettings& settings,
    frequencyGain = settings.frequencyGain;
 }
 
+namespace {
+
+SpectrumSampleReader TrackReader(
+   WaveTrackCache &waveTrackCache, double offset, double rate)
+{
+   return [&waveTrackCache, offset, rate](sampleCount start, size_t len){
+      return waveTrackCache.GetFloats(
+         sampleCount(
+            floor(0.5 + start.as_double() + offset * rate)
+         ),
+         len,
+         // Don't throw in this drawing operation
+         false);
+   };
+}
+
+}
+
 void SpecCache::Populate
    (const SpectrogramSettings &settings, WaveTrackCache &waveTrackCache,
     int copyBegin, int copyEnd, size_t numPixels,
     sampleCount numSamples,
     double offset, double rate, double pixelsPerSecond)
 {
+   const auto getFloats = TrackReader(waveTrackCache, offset, rate);
+
    const int &frequencyGainSetting = settings.frequencyGain;
    const size_t windowSizeSetting = settings.WindowSize();
    const bool autocorrelation =
@@ -829,7 +896,9 @@ void SpecCache::Populate
    const auto nBins = settings.NBins();
 
    const size_t bufferSize = fftLen;
-   const size_t scratchSize = reassignment ? 3 * bufferSize : bufferSize;
+   // Reassignment needs three buffers, and room for their transforms in lanes
+   const size_t scratchSize =
+      reassignment ? (3 + FFTLanes) * bufferSize : bufferSize;
    std::vector<float> scratch(scratchSize);
 
    std::vector<float> gainFactors;
@@ -865,15 +934,16 @@ void SpecCache::Populate
       {
 #ifdef _OPENMP
          tls.init(waveTrackCache, scratchSize);
-         WaveTrackCache& cache = *tls.cache;
+         const auto cacheReader = TrackReader(*tls.cache, offset, rate);
+         const auto &reader = cacheReader;
          float* buffer = &tls.scratch[0];
 #else
-         WaveTrackCache& cache = waveTrackCache;
+         const auto &reader = getFloats;
          float* buffer = &scratch[0];
 #endif
          CalculateOneSpectrum(
-            settings, cache, xx, numSamples,
-            offset, rate, pixelsPerSecond,
+            settings, reader, xx, numSamples,
+            rate, pixelsPerSecond,
             lowerBoundX, upperBoundX,
             gainFactors, buffer, &freq[0]);
       }
@@ -889,8 +959,8 @@ void SpecCache::Populate
          {
             const bool result =
                CalculateOneSpectrum(
-                  settings, waveTrackCache, --xx, numSamples,
-                  offset, rate, pixelsPerSecond,
+                  settings, getFloats, --xx, numSamples,
+                  rate, pixelsPerSecond,
                   lowerBoundX, upperBoundX,
                   gainFactors, &scratch[0], &freq[0]);
             if (!result)
@@ -902,8 +972,8 @@ void SpecCache::Populate
          {
             const bool result =
                CalculateOneSpectrum(
-                  settings, waveTrackCache, xx++, numSamples,
-                  offset, rate, pixelsPerSecond,
+                  settings, getFloats, xx++, numSamples,
+                  rate, pixelsPerSecond,
                   lowerBoundX, upperBoundX,
                   gainFactors, &scratch[0], &freq[0]);
             if (!result)
@@ -934,6 +1004,68 @@ void SpecCache::Populate
    }
 }
 
+void SpecCache::PopulateColumns
+   (const SpectrogramSettings &settings,
+    const SpectrumSampleReader &getFloats,
+    sampleCount numSamples, double rate, double pixelsPerSecond)
+{
+   wxASSERT(settings.algorithm != SpectrogramSettings::algReassignment);
+
+   const size_t fftLen = settings.WindowSize() * settings.ZeroPaddingFactor();
+   std::vector<float> scratch(fftLen);
+
+   std::vector<float> gainFactors;
+   if (settings.algorithm != SpectrogramSettings::algPitchEAC)
+      ComputeSpectrogramGainFactors(
+         fftLen, rate, settings.frequencyGain, gainFactors);
+
+   if (settings.algorithm != SpectrogramSettings::algSTFT) {
+      for (int xx = 0; xx < (int)len; ++xx)
+         CalculateOneSpectrum(
+            settings, getFloats, xx, numSamples,
+            rate, pixelsPerSecond,
+            0, (int)len,
+            gainFactors, &scratch[0], &freq[0]);
+      return;
+   }
+
+   // Transform the windows of FFTLanes columns at once
+   const auto hFFT = settings.hFFT.get();
+   const float *const window = settings.window.get();
+   const size_t windowSize = settings.WindowSize();
+   const size_t padding =
+      (windowSize * (settings.ZeroPaddingFactor() - 1)) / 2;
+   const auto nBins = settings.NBins();
+   std::vector<float> lanes(FFTLanes * fftLen);
+   for (size_t x0 = 0; x0 < len; x0 += FFTLanes) {
+      const auto count = std::min(FFTLanes, len - x0);
+      bool inside[FFTLanes]{};
+      for (size_t lane = 0; lane < FFTLanes; ++lane) {
+         inside[lane] = lane < count &&
+            ReadSpectrumWindow(getFloats, where[x0 + lane], numSamples,
+               windowSize, padding, fftLen, &scratch[0]);
+         for (size_t ii = 0; ii < fftLen; ++ii)
+            lanes[FFTLanes * ii + lane] =
+               inside[lane] ? scratch[ii] * window[ii] : 0.0f;
+      }
+      RealFFTfLanes(&lanes[0], *hFFT);
+      for (size_t lane = 0; lane < count; ++lane) {
+         float *const results = &freq[nBins * (x0 + lane)];
+         if (!inside[lane]) {
+            // Pixel column is out of bounds of the clip!  Should not happen.
+            std::fill(results, results + nBins, 0.0f);
+            continue;
+         }
+         ComputeSpectrumOfLane(&lanes[0], lane, hFFT, results);
+         if (!gainFactors.empty()) {
+            // Apply a frequency-dependent gain factor
+            for (size_t ii = 0; ii < nBins; ++ii)
+               results[ii] += gainFactors[ii];
+         }
+      }
+   }
+}
+
 bool WaveClip::GetSpectrogram(WaveTrackCache &waveTrackCache,
                               const float *& spectrogram,
                               const sampleCount *& where,
@@ -945,6 +1077,32 @@ bool WaveClip::GetSpectrogram(WaveTrackCache &waveTrackCache,
    const WaveTrack *const track = waveTrackCache.GetTrack().get();
    const SpectrogramSettings &settings = track->GetSpectrogramSettings();
 
+   if (settings.algorithm != SpectrogramSettings::algReassignment) {
+      // Columns lie on a grid fixed to the start of the sequence, so that
+      // tiles computed in the background serve at any scroll position.
+      // This moves the display by less than half a pixel.
+      const auto firstColumn = (long long)floor(0.5 + t0 * pixelsPerSecond);
+      const double start = firstColumn / pixelsPerSecond;
+      const bool match =
+         mSpecCache->len == numPixels &&
+         mSpecCache->start == start &&
+         mSpecCache->Matches(mDirty, pixelsPerSecond, settings, mRate);
+
+      mSpecCache->Grow(numPixels, settings, pixelsPerSecond, start);
+      mSpecCache->dirty = mDirty;
+      if (!mSpecTiles)
+         mSpecTiles = std::make_unique<SpectrogramTiles>();
+      const auto pList = track->GetOwner();
+      const bool updated = mSpecTiles->Fill(*this,
+         pList ? pList->GetOwner() : nullptr, mDirty,
+         settings, pixelsPerSecond, firstColumn, *mSpecCache, !match);
+
+      spectrogram = &mSpecCache->freq[0];
+      where = &mSpecCache->where[0];
+
+      return updated;
+   }
+
    //Trim offset comparison failure forces spectrogram cache rebuild 
    //and skip copying "unchanged" data after clip border was trimmed.
    bool match =
@@ -31,10 +31,15 @@ class SampleBlockFactory;
 using SampleBlockFactoryPtr = std::shared_ptr<SampleBlockFactory>;
 class Sequence;
 class SpectrogramSettings;
+class SpectrogramTiles;
 class WaveCache;
 class WaveTrackCache;
 class wxFileNameWrapper;
 
+//! Gives len samples of a clip's sequence beginning at start, or null
+using SpectrumSampleReader =
+   std::function<const float *(sampleCount start, size_t len)>;
+
 class AUDACITY_DLL_API SpecCache {
 public:
 
@@ -59,9 +64,9 @@ public:
    // Calculate one column of the spectrum
    bool CalculateOneSpectrum
       (const SpectrogramSettings &settings,
-       WaveTrackCache &waveTrackCache,
+       const SpectrumSampleReader &getFloats,
        const int xx, sampleCount numSamples,
-       double offset, double rate, double pixelsPerSecond,
+       double rate, double pixelsPerSecond,
        int lowerBoundX, int upperBoundX,
        const std::vector<float> &gainFactors,
        float* __restrict scratch,
@@ -78,6 +83,13 @@ public:
        sampleCount numSamples,
        double offset, double rate, double pixelsPerSecond);
 
+   // Calculate all columns, which must not be for reassignment; may be
+   // called on a worker thread
+   void PopulateColumns
+      (const SpectrogramSettings &settings,
+       const SpectrumSampleReader &getFloats,
+       sampleCount numSamples, double rate, double pixelsPerSecond);
+
    size_t       len { 0 }; // counts pixels, not samples
    int          algorithm;
    double       pps;
@@ -421,6 +433,7 @@ protected:
 
    mutable std::unique_ptr<WaveCache> mWaveCache;
    mutable std::unique_ptr<SpecCache> mSpecCache;
+   mutable std::unique_ptr<SpectrogramTiles> mSpecTiles;
    SampleBuffer  mAppendBuffer {};
    size_t        mAppendBufferLen { 0 };
 
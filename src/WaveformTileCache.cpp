@@ -0,0 +1,146 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveformTileCache.cpp
+
+**********************************************************************/
+
+#include "WaveformTileCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+//! Bytes of tiles kept
+constexpr size_t Budget = 64 << 20;
+
+using Tile = WaveformTileCache::Tile;
+
+//! One of the block's own summaries, for MinLevel or Level64k
+std::shared_ptr<Tile> Summarize(SampleBlock &block, unsigned level, bool &good)
+{
+   const size_t width = size_t(1) << level;
+   const auto frames = (block.GetSampleCount() + width - 1) / width;
+   auto pTile = std::make_shared<Tile>(3 * frames);
+   good = (level == WaveformTileCache::Level64k)
+      ? block.GetSummary64k(pTile->data(), 0, frames)
+      : block.GetSummary256(pTile->data(), 0, frames);
+   return pTile;
+}
+
+//! Combine pairs of groups of the next finer level
+std::shared_ptr<Tile> Coarsen(
+   const Tile &finer, size_t count, unsigned level)
+{
+   const size_t width = size_t(1) << level, half = width / 2;
+   const auto frames = (count + width - 1) / width;
+   auto pTile = std::make_shared<Tile>(3 * frames);
+   auto src = finer.data();
+   auto dest = pTile->data();
+   for (size_t ii = 0; ii < frames; ++ii, dest += 3) {
+      const auto first = ii * width;
+      // Sample counts of the halves
+      const auto n1 = std::min(half, count - first);
+      const auto n2 = count - first > half
+         ? std::min(half, count - first - half) : 0;
+      float min = src[0], max = src[1];
+      float sumsq = src[2] * src[2] * n1;
+      src += 3;
+      if (n2 > 0) {
+         min = std::min(min, src[0]);
+         max = std::max(max, src[1]);
+         sumsq += src[2] * src[2] * n2;
+         src += 3;
+      }
+      dest[0] = min;
+      dest[1] = max;
+      dest[2] = sqrt(sumsq / (n1 + n2));
+   }
+   return pTile;
+}
+
+}
+
+WaveformTileCache &WaveformTileCache::Get()
+{
+   static WaveformTileCache instance;
+   return instance;
+}
+
+WaveformTileCache::WaveformTileCache() = default;
+
+std::shared_ptr<const WaveformTileCache::Tile>
+WaveformTileCache::Lookup(const SampleBlockPtr &pBlock, unsigned level)
+{
+   level = std::max(level, MinLevel);
+   const auto base = level >= Level64k ? Level64k : MinLevel;
+
+   // Find the tile of this level, or else of the finest level to make it from
+   std::shared_ptr<const Tile> pTile;
+   auto found = level;
+   {
+      std::lock_guard<std::mutex> guard{ mMutex };
+      while (!(pTile = Find(pBlock, found)) && found > base)
+         --found;
+   }
+
+   if (!pTile) {
+      // Read outside the lock
+      bool good = true;
+      pTile = Summarize(*pBlock, base, good);
+      if (!good)
+         // Perhaps the database is busy; try again when next drawn
+         return pTile;
+      std::lock_guard<std::mutex> guard{ mMutex };
+      pTile = Keep(pBlock, base, std::move(pTile));
+   }
+
+   const auto count = pBlock->GetSampleCount();
+   while (found < level) {
+      pTile = Coarsen(*pTile, count, ++found);
+      std::lock_guard<std::mutex> guard{ mMutex };
+      pTile = Keep(pBlock, found, std::move(pTile));
+   }
+   return pTile;
+}
+
+std::shared_ptr<const WaveformTileCache::Tile>
+WaveformTileCache::Find(const SampleBlockPtr &pBlock, unsigned level)
+{
+   const auto iter = mEntries.find({ pBlock.get(), level });
+   if (iter == mEntries.end())
+      return {};
+   auto &entry = iter->second;
+   if (entry.block.lock() != pBlock) {
+      Forget(iter);
+      return {};
+   }
+   mUses.splice(mUses.end(), mUses, entry.use);
+   return entry.tile;
+}
+
+std::shared_ptr<const WaveformTileCache::Tile>
+WaveformTileCache::Keep(const SampleBlockPtr &pBlock,
+   unsigned level, std::shared_ptr<const Tile> pTile)
+{
+   if (auto pKept = Find(pBlock, level))
+      return pKept;
+
+   const Key key{ pBlock.get(), level };
+   mUses.push_back(key);
+   mEntries.emplace(key, Entry{ pBlock, pTile, std::prev(mUses.end()) });
+   mBytes += pTile->size() * sizeof(float);
+   while (mBytes > Budget && mUses.size() > 1)
+      Forget(mEntries.find(mUses.front()));
+
+   return pTile;
+}
+
+void WaveformTileCache::Forget(Entries::iterator iter)
+{
+   mBytes -= iter->second.tile->size() * sizeof(float);
+   mUses.erase(iter->second.use);
+   mEntries.erase(iter);
+}
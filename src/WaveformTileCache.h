@@ -0,0 +1,83 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WaveformTileCache.h
+
+  Summaries of sample blocks at power-of-two zoom levels, shared by all
+  clips that show the blocks.
+
+**********************************************************************/
+
+#ifndef __AUDACITY_WAVEFORM_TILE_CACHE__
+#define __AUDACITY_WAVEFORM_TILE_CACHE__
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "SampleBlock.h"
+
+//! Min, max and rms of each group of 2^level samples of a block
+/*!
+ Tiles belong to block objects, which copies of clips and undo states share,
+ so that neither zooming nor copying nor undoing summarizes a block again.
+ They are kept, least recently used first out, to a fixed number of bytes.
+
+ Tiles of Level64k and of MinLevel are made from the block's own summaries,
+ and each other tile from the tile of the next finer level.  Blocks are read
+ without holding the lock, so that one thread's read of the database does not
+ hold up another's drawing from tiles already made.
+ */
+class AUDACITY_DLL_API WaveformTileCache final
+{
+public:
+   //! Triples of min, max and rms; the last group of the block may be shorter
+   using Tile = std::vector<float>;
+
+   //! The levels of the summaries that blocks keep
+   static constexpr unsigned MinLevel = 8, Level64k = 16;
+
+   static WaveformTileCache &Get();
+
+   //! Never null
+   /*!
+    @param level is raised to MinLevel if less
+    @return zeroes, which are not kept, if the block could not be read
+    */
+   std::shared_ptr<const Tile>
+      Lookup(const SampleBlockPtr &pBlock, unsigned level);
+
+private:
+   using Key = std::pair<const SampleBlock *, unsigned>;
+   struct Entry
+   {
+      //! Detects another block made at the address of a destroyed one
+      std::weak_ptr<SampleBlock> block;
+      std::shared_ptr<const Tile> tile;
+      std::list<Key>::iterator use;
+   };
+   using Entries = std::map<Key, Entry>;
+
+   WaveformTileCache();
+
+   //! Call with mMutex locked
+   std::shared_ptr<const Tile>
+      Find(const SampleBlockPtr &pBlock, unsigned level);
+   //! Call with mMutex locked
+   /*! @return the tile kept, which is another thread's if it made one first */
+   std::shared_ptr<const Tile> Keep(const SampleBlockPtr &pBlock,
+      unsigned level, std::shared_ptr<const Tile> pTile);
+   //! Call with mMutex locked
+   void Forget(Entries::iterator iter);
+
+   std::mutex mMutex;
+   Entries mEntries;
+   //! Least recently used first
+   std::list<Key> mUses;
+   size_t mBytes{ 0 };
+};
+
+#endif
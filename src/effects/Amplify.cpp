@@ -332,6 +332,16 @@ bool EffectAmplify::TransferDataFromWindow()
    return true;
 }
 
+std::unique_ptr<Effect> EffectAmplify::CloneForParallelProcessing()
+{
+   return CloneWithSettings<EffectAmplify>();
+}
+
+std::optional<size_t> EffectAmplify::GetWarmUpLength(double)
+{
+   return 0;
+}
+
 // EffectAmplify implementation
 
 void EffectAmplify::CheckClip()
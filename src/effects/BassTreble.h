@@ -13,6 +13,7 @@
 #define __AUDACITY_EFFECT_BASS_TREBLE__
 
 #include "Effect.h"
+#include "Biquad.h"
 
 class wxSlider;
 class wxCheckBox;
@@ -27,10 +28,8 @@ public:
    double bass;
    double gain;
    double slope, hzBass, hzTreble;
-   double a0Bass, a1Bass, a2Bass, b0Bass, b1Bass, b2Bass;
-   double a0Treble, a1Treble, a2Treble, b0Treble, b1Treble, b2Treble;
-   double xn1Bass, xn2Bass, yn1Bass, yn2Bass;
-   double xn1Treble, xn2Treble, yn1Treble, yn2Treble;
+   // Low shelf, then high shelf
+   Biquad filters[2];
 };
 
 class EffectBassTreble final : public Effect
@@ -76,6 +75,9 @@ public:
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
 
+   std::unique_ptr<Effect> CloneForParallelProcessing() override;
+   std::optional<size_t> GetWarmUpLength(double sampleRate) override;
+
    bool CheckWhetherSkipEffect() override;
 
 private:
@@ -85,8 +87,7 @@ private:
    size_t InstanceProcess(EffectBassTrebleState & data, float **inBlock, float **outBlock, size_t blockLen);
 
    void Coefficients(double hz, double slope, double gain, double samplerate, int type,
-                    double& a0, double& a1, double& a2, double& b0, double& b1, double& b2);
-   float DoFilter(EffectBassTrebleState & data, float in);
+                    Biquad &filter);
 
    void OnBassText(wxCommandEvent & evt);
    void OnTrebleText(wxCommandEvent & evt);
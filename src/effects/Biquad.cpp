@@ -11,8 +11,14 @@ Max Maisel
 
 #include "Biquad.h"
 
+#include <algorithm>
 #include <cmath>
 #include <wx/utils.h>
+#include "CpuFeatures.h"
+
+#ifdef AUDACITY_CPU_X86
+#include <immintrin.h>
+#endif
 
 #define square(a) ((a)*(a))
 #define PI M_PI
@@ -39,6 +45,330 @@ void Biquad::Process(float* pfIn, float* pfOut, int iNumSamples)
 {
    for (int i = 0; i < iNumSamples; i++)
       *pfOut++ = ProcessOne(*pfIn++);
+   FlushDenormals();
+}
+
+namespace {
+
+// State below this, times any reasonable coefficient, is far below half an
+// ulp of anything else in the sum, so zeroing it can only change a zero
+// output to a zero of the other sign
+constexpr double DenormalThreshold = 1e-200;
+
+// Longest cascade run in vector lanes; longer ones are run a biquad at a
+// time
+constexpr size_t MaxPipelined = 8;
+
+// One biquad at a time over the whole block
+void CascadeScalar(Biquad *biquads, size_t count,
+   const float *pfIn, float *pfOut, size_t len)
+{
+   for (size_t k = 0; k < count; ++k) {
+      auto &biquad = biquads[k];
+      const auto in = (k == 0) ? pfIn : pfOut;
+      for (size_t i = 0; i < len; ++i)
+         pfOut[i] = biquad.ProcessOne(in[i]);
+   }
+}
+
+#ifdef AUDACITY_CPU_X86
+
+// Biquad k works Lag steps behind biquad k - 1.  A sample passes from one
+// to the next with the latency of the whole of ProcessOne, so a lag of two
+// lets consecutive steps overlap.
+constexpr size_t Lag = 2;
+
+// What each biquad made at the last Lag steps, indexed by step modulo Lag
+using CascadeHistory = float[MaxPipelined][Lag];
+
+// Steps of the pipeline while it fills and drains: at step t, biquad k
+// takes sample t - Lag * k, if there is one, from what biquad k - 1 made
+// Lag steps before
+void CascadeSteps(Biquad *biquads, size_t count,
+   const float *pfIn, float *pfOut, size_t len, CascadeHistory &history,
+   size_t tBegin, size_t tEnd)
+{
+   for (auto t = tBegin; t < tEnd; ++t)
+      // Later biquads first, so that each takes the history of the one
+      // before, before it is overwritten
+      for (auto k = count; k--;) {
+         if (t < Lag * k || t - Lag * k >= len)
+            continue;
+         const auto in = (k == 0) ? pfIn[t] : history[k - 1][t % Lag];
+         history[k][t % Lag] = biquads[k].ProcessOne(in);
+         if (k == count - 1)
+            pfOut[t - Lag * k] = history[k][t % Lag];
+      }
+}
+
+AUDACITY_TARGET_SSE2
+inline double HighLane(__m128d value)
+{
+   return _mm_cvtsd_f64(_mm_unpackhi_pd(value, value));
+}
+
+// Biquads 2j and 2j + 1 run in the two lanes of pair j, so that their
+// recursions overlap.  The arithmetic is that of Biquad::ProcessOne, in the
+// same order, so the results are the same.  The number of pairs is a
+// template parameter so that the state stays in registers.
+template<size_t nPairs> struct CascadePairs
+{
+   __m128d b0[nPairs], b1[nPairs], b2[nPairs], a1[nPairs], a2[nPairs],
+      prevIn[nPairs], prevPrevIn[nPairs], prevOut[nPairs],
+      prevPrevOut[nPairs];
+
+   //! made holds what the pairs made Lag steps before, and is overwritten;
+   //! returns what the last pair made
+   AUDACITY_TARGET_SSE2
+   inline __m128d Step(__m128d *made, float in)
+   {
+      // Later pairs first, so each takes what the one before made
+      for (auto j = nPairs; j--;) {
+         const auto from = (j == 0) ? _mm_set1_pd(in) : made[j - 1];
+         const auto x = _mm_shuffle_pd(from, made[j], 1);
+         auto out = _mm_add_pd(_mm_mul_pd(x, b0[j]),
+            _mm_mul_pd(prevIn[j], b1[j]));
+         out = _mm_add_pd(out, _mm_mul_pd(prevPrevIn[j], b2[j]));
+         out = _mm_sub_pd(out, _mm_mul_pd(prevOut[j], a1[j]));
+         out = _mm_sub_pd(out, _mm_mul_pd(prevPrevOut[j], a2[j]));
+         prevPrevIn[j] = prevIn[j];
+         prevIn[j] = x;
+         prevPrevOut[j] = prevOut[j];
+         prevOut[j] = out;
+         // ProcessOne returns float
+         made[j] = _mm_cvtps_pd(_mm_cvtpd_ps(out));
+      }
+      return made[nPairs - 1];
+   }
+};
+
+template<size_t nPairs>
+AUDACITY_TARGET_SSE2
+void CascadePairsSSE2(Biquad *biquads, size_t count,
+   const float *pfIn, float *pfOut, size_t len, CascadeHistory &history,
+   size_t tBegin)
+{
+   // The second lane of the last pair, when count is odd, runs a
+   // pass-through whose output is not used
+   Biquad unused;
+   const auto lane = [&](size_t k) -> Biquad & {
+      return k < count ? biquads[k] : unused; };
+   const auto laneHistory = [&](size_t k, size_t t) {
+      return k < count ? history[k][t % Lag] : 0.0f; };
+
+   CascadePairs<nPairs> pairs;
+   // What the pairs made at even and odd steps after tBegin
+   __m128d even[nPairs], odd[nPairs];
+   for (size_t j = 0; j < nPairs; ++j) {
+      const auto &f0 = lane(2 * j), &f1 = lane(2 * j + 1);
+      pairs.b0[j] = _mm_setr_pd(
+         f0.fNumerCoeffs[Biquad::B0], f1.fNumerCoeffs[Biquad::B0]);
+      pairs.b1[j] = _mm_setr_pd(
+         f0.fNumerCoeffs[Biquad::B1], f1.fNumerCoeffs[Biquad::B1]);
+      pairs.b2[j] = _mm_setr_pd(
+         f0.fNumerCoeffs[Biquad::B2], f1.fNumerCoeffs[Biquad::B2]);
+      pairs.a1[j] = _mm_setr_pd(
+         f0.fDenomCoeffs[Biquad::A1], f1.fDenomCoeffs[Biquad::A1]);
+      pairs.a2[j] = _mm_setr_pd(
+         f0.fDenomCoeffs[Biquad::A2], f1.fDenomCoeffs[Biquad::A2]);
+      pairs.prevIn[j] = _mm_setr_pd(f0.fPrevIn, f1.fPrevIn);
+      pairs.prevPrevIn[j] = _mm_setr_pd(f0.fPrevPrevIn, f1.fPrevPrevIn);
+      pairs.prevOut[j] = _mm_setr_pd(f0.fPrevOut, f1.fPrevOut);
+      pairs.prevPrevOut[j] = _mm_setr_pd(f0.fPrevPrevOut, f1.fPrevPrevOut);
+      even[j] = _mm_setr_pd(
+         laneHistory(2 * j, tBegin), laneHistory(2 * j + 1, tBegin));
+      odd[j] = _mm_setr_pd(
+         laneHistory(2 * j, tBegin + 1), laneHistory(2 * j + 1, tBegin + 1));
+   }
+
+   const auto outputLag = Lag * (count - 1);
+   const auto output = [&](__m128d last) -> float {
+      return (count % 2) == 0 ? HighLane(last) : _mm_cvtsd_f64(last); };
+
+   static_assert(Lag == 2);
+   auto t = tBegin;
+   for (; t + 1 < len; t += 2) {
+      pfOut[t - outputLag] = output(pairs.Step(even, pfIn[t]));
+      pfOut[t + 1 - outputLag] = output(pairs.Step(odd, pfIn[t + 1]));
+   }
+   if (t < len)
+      pfOut[t - outputLag] = output(pairs.Step(even, pfIn[t]));
+
+   for (size_t j = 0; j < nPairs; ++j) {
+      auto &f0 = lane(2 * j), &f1 = lane(2 * j + 1);
+      f0.fPrevIn = _mm_cvtsd_f64(pairs.prevIn[j]);
+      f1.fPrevIn = HighLane(pairs.prevIn[j]);
+      f0.fPrevPrevIn = _mm_cvtsd_f64(pairs.prevPrevIn[j]);
+      f1.fPrevPrevIn = HighLane(pairs.prevPrevIn[j]);
+      f0.fPrevOut = _mm_cvtsd_f64(pairs.prevOut[j]);
+      f1.fPrevOut = HighLane(pairs.prevOut[j]);
+      f0.fPrevPrevOut = _mm_cvtsd_f64(pairs.prevPrevOut[j]);
+      f1.fPrevPrevOut = HighLane(pairs.prevPrevOut[j]);
+      for (const auto k : { 2 * j, 2 * j + 1 })
+         if (k < count) {
+            const auto high = (k % 2) == 1;
+            history[k][tBegin % Lag] =
+               high ? HighLane(even[j]) : _mm_cvtsd_f64(even[j]);
+            history[k][(tBegin + 1) % Lag] =
+               high ? HighLane(odd[j]) : _mm_cvtsd_f64(odd[j]);
+         }
+   }
+}
+
+AUDACITY_TARGET_SSE2
+void CascadeSSE2(Biquad *biquads, size_t count,
+   const float *pfIn, float *pfOut, size_t len)
+{
+   static_assert(MaxPipelined == 8);
+   CascadeHistory history{};
+   const auto fill = Lag * (count - 1);
+   CascadeSteps(biquads, count, pfIn, pfOut, len, history, 0, fill);
+
+   // All biquads are busy from step fill until step len
+   if (len > fill)
+      switch ((count + 1) / 2) {
+      case 1:
+         CascadePairsSSE2<1>(
+            biquads, count, pfIn, pfOut, len, history, fill);
+         break;
+      case 2:
+         CascadePairsSSE2<2>(
+            biquads, count, pfIn, pfOut, len, history, fill);
+         break;
+      case 3:
+         CascadePairsSSE2<3>(
+            biquads, count, pfIn, pfOut, len, history, fill);
+         break;
+      default:
+         CascadePairsSSE2<4>(
+            biquads, count, pfIn, pfOut, len, history, fill);
+         break;
+      }
+
+   CascadeSteps(biquads, count, pfIn, pfOut, len, history,
+      std::max(len, fill), len + fill);
+}
+
+// The two channels run in the two lanes, with the same arithmetic as
+// Biquad::ProcessOne
+AUDACITY_TARGET_SSE2
+void CascadeTwoChannelsSSE2(Biquad *biquads0, Biquad *biquads1,
+   size_t count, const float *pfIn0, const float *pfIn1,
+   float *pfOut0, float *pfOut1, size_t len)
+{
+   __m128d b0[MaxPipelined], b1[MaxPipelined], b2[MaxPipelined],
+      a1[MaxPipelined], a2[MaxPipelined], prevIn[MaxPipelined],
+      prevPrevIn[MaxPipelined], prevOut[MaxPipelined],
+      prevPrevOut[MaxPipelined];
+   for (size_t k = 0; k < count; ++k) {
+      const auto &f0 = biquads0[k], &f1 = biquads1[k];
+      b0[k] = _mm_setr_pd(
+         f0.fNumerCoeffs[Biquad::B0], f1.fNumerCoeffs[Biquad::B0]);
+      b1[k] = _mm_setr_pd(
+         f0.fNumerCoeffs[Biquad::B1], f1.fNumerCoeffs[Biquad::B1]);
+      b2[k] = _mm_setr_pd(
+         f0.fNumerCoeffs[Biquad::B2], f1.fNumerCoeffs[Biquad::B2]);
+      a1[k] = _mm_setr_pd(
+         f0.fDenomCoeffs[Biquad::A1], f1.fDenomCoeffs[Biquad::A1]);
+      a2[k] = _mm_setr_pd(
+         f0.fDenomCoeffs[Biquad::A2], f1.fDenomCoeffs[Biquad::A2]);
+      prevIn[k] = _mm_setr_pd(f0.fPrevIn, f1.fPrevIn);
+      prevPrevIn[k] = _mm_setr_pd(f0.fPrevPrevIn, f1.fPrevPrevIn);
+      prevOut[k] = _mm_setr_pd(f0.fPrevOut, f1.fPrevOut);
+      prevPrevOut[k] = _mm_setr_pd(f0.fPrevPrevOut, f1.fPrevPrevOut);
+   }
+
+   for (size_t i = 0; i < len; ++i) {
+      auto x = _mm_setr_pd(pfIn0[i], pfIn1[i]);
+      for (size_t k = 0; k < count; ++k) {
+         auto out = _mm_add_pd(_mm_mul_pd(x, b0[k]),
+            _mm_mul_pd(prevIn[k], b1[k]));
+         out = _mm_add_pd(out, _mm_mul_pd(prevPrevIn[k], b2[k]));
+         out = _mm_sub_pd(out, _mm_mul_pd(prevOut[k], a1[k]));
+         out = _mm_sub_pd(out, _mm_mul_pd(prevPrevOut[k], a2[k]));
+         prevPrevIn[k] = prevIn[k];
+         prevIn[k] = x;
+         prevPrevOut[k] = prevOut[k];
+         prevOut[k] = out;
+         x = _mm_cvtps_pd(_mm_cvtpd_ps(out));
+      }
+      pfOut0[i] = _mm_cvtsd_f64(x);
+      pfOut1[i] = HighLane(x);
+   }
+
+   for (size_t k = 0; k < count; ++k) {
+      auto &f0 = biquads0[k], &f1 = biquads1[k];
+      f0.fPrevIn = _mm_cvtsd_f64(prevIn[k]);
+      f1.fPrevIn = HighLane(prevIn[k]);
+      f0.fPrevPrevIn = _mm_cvtsd_f64(prevPrevIn[k]);
+      f1.fPrevPrevIn = HighLane(prevPrevIn[k]);
+      f0.fPrevOut = _mm_cvtsd_f64(prevOut[k]);
+      f1.fPrevOut = HighLane(prevOut[k]);
+      f0.fPrevPrevOut = _mm_cvtsd_f64(prevPrevOut[k]);
+      f1.fPrevPrevOut = HighLane(prevPrevOut[k]);
+   }
+}
+
+#endif
+
+}
+
+void Biquad::ProcessCascade(Biquad *biquads, size_t count,
+   const float *pfIn, float *pfOut, size_t len)
+{
+#ifdef AUDACITY_CPU_X86
+   if (count > 1 && count <= MaxPipelined && GetCpuFeatures().sse2)
+      CascadeSSE2(biquads, count, pfIn, pfOut, len);
+   else
+#endif
+      CascadeScalar(biquads, count, pfIn, pfOut, len);
+
+   for (size_t k = 0; k < count; ++k)
+      biquads[k].FlushDenormals();
+}
+
+void Biquad::ProcessCascade(Biquad *biquads0, Biquad *biquads1,
+   size_t count, const float *pfIn0, const float *pfIn1,
+   float *pfOut0, float *pfOut1, size_t len)
+{
+#ifdef AUDACITY_CPU_X86
+   if (count <= MaxPipelined && GetCpuFeatures().sse2) {
+      CascadeTwoChannelsSSE2(biquads0, biquads1, count,
+         pfIn0, pfIn1, pfOut0, pfOut1, len);
+      for (size_t k = 0; k < count; ++k) {
+         biquads0[k].FlushDenormals();
+         biquads1[k].FlushDenormals();
+      }
+      return;
+   }
+#endif
+   ProcessCascade(biquads0, count, pfIn0, pfOut0, len);
+   ProcessCascade(biquads1, count, pfIn1, pfOut1, len);
+}
+
+void Biquad::FlushDenormals()
+{
+   if (fabs(fPrevIn) < DenormalThreshold &&
+       fabs(fPrevPrevIn) < DenormalThreshold &&
+       fabs(fPrevOut) < DenormalThreshold &&
+       fabs(fPrevPrevOut) < DenormalThreshold)
+      Reset();
+}
+
+size_t Biquad::SettlingLength(double tolerance) const
+{
+   // Largest magnitude of the roots of z^2 + a1 z + a2
+   const double a1 = fDenomCoeffs[A1], a2 = fDenomCoeffs[A2];
+   const double discriminant = a1 * a1 - 4 * a2;
+   const double radius = (discriminant < 0)
+      ? sqrt(a2)
+      : (fabs(a1) + sqrt(discriminant)) / 2;
+   if (radius >= 1)
+      return 0;
+   if (radius <= 0)
+      // Finite impulse response
+      return 2;
+   return 2 + (size_t)ceil(log(tolerance) / log(radius));
 }
 
 const double Biquad::s_fChebyCoeffs[MAX_Order][MAX_Order + 1] =
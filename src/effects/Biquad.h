@@ -21,6 +21,28 @@ struct Biquad
    void Reset();
    void Process(float* pfIn, float* pfOut, int iNumSamples);
 
+   /// Same as Process() for each of count biquads in turn, each taking the
+   /// output of the one before; pfOut may be the same as pfIn.
+   /// The results are identical, but several biquads run at once, each a
+   /// sample behind the one before.
+   static void ProcessCascade(Biquad *biquads, size_t count,
+      const float *pfIn, float *pfOut, size_t len);
+   /// Same as ProcessCascade() for two channels, each with its own cascade
+   /// of count biquads
+   static void ProcessCascade(Biquad *biquads0, Biquad *biquads1,
+      size_t count, const float *pfIn0, const float *pfIn1,
+      float *pfOut0, float *pfOut1, size_t len);
+
+   /// Zero the state if it has decayed so far that it cannot change the
+   /// output by more than the sign of a zero, so that it does not go on
+   /// into denormal numbers, which are very slow.  Process() and
+   /// ProcessCascade() do this after each block.
+   void FlushDenormals();
+
+   /// Number of samples after which the response to any earlier input has
+   /// decayed below tolerance (relative), or 0 if the filter is not stable
+   size_t SettlingLength(double tolerance = 1e-10) const;
+
    enum
    {
       /// Numerator coefficient indices
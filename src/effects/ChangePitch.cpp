@@ -210,6 +210,39 @@ bool EffectChangePitch::Init()
    return true;
 }
 
+bool EffectChangePitch::CanReusePreview()
+{
+   // The result depends only on the input and the parameters
+   return true;
+}
+
+std::unique_ptr<PreviewRenderer> EffectChangePitch::MakePreviewRenderer(
+   std::shared_ptr<const PreviewRenderer::Buffers> input, double rate)
+{
+#if USE_SBSMS
+   if (mUseSBSMS)
+   {
+      double pitchRatio = 1.0 + m_dPercentChange / 100.0;
+      EffectSBSMS proxy;
+      proxy.setParameters(1.0, pitchRatio);
+      return proxy.MakePreviewRenderer(std::move(input), rate);
+   }
+   else
+#endif
+   {
+      // As in Process()
+      Calc_SemitonesChange_fromPercentChange();
+
+      auto initer = [semitonesChange = m_dSemitonesChange](
+         soundtouch::SoundTouch *soundtouch)
+      {
+         soundtouch->setPitchSemiTones((float)(semitonesChange));
+      };
+      return EffectSoundTouch::MakeSoundTouchRenderer(
+         initer, true, std::move(input), rate);
+   }
+}
+
 bool EffectChangePitch::Process()
 {
 #if USE_SBSMS
@@ -63,6 +63,10 @@ public:
 
    bool Init() override;
    bool Process() override;
+   bool CanReusePreview() override;
+   std::unique_ptr<PreviewRenderer> MakePreviewRenderer(
+      std::shared_ptr<const PreviewRenderer::Buffers> input,
+      double rate) override;
    bool CheckWhetherSkipEffect() override;
    void PopulateOrExchange(ShuttleGui & S) override;
    bool TransferDataToWindow() override;
@@ -227,6 +227,76 @@ bool EffectChangeSpeed::Init()
    return true;
 }
 
+bool EffectChangeSpeed::CanReusePreview()
+{
+   // The result depends only on the input and the parameters
+   return true;
+}
+
+namespace {
+//! Resamples each channel of a preview in memory, as ProcessOne() does
+class ChangeSpeedRenderer final : public PreviewRenderer
+{
+public:
+   ChangeSpeedRenderer(std::shared_ptr<const Buffers> input, double factor)
+      : mInput{ std::move(input) }
+      , mFactor{ factor }
+      , mInBuffer{ BlockSize }
+      // mFactor is at most 100-fold so this shouldn't overflow size_t
+      , mOutBufferSize{ size_t( mFactor * BlockSize + 10 ) }
+      , mOutBuffer{ mOutBufferSize }
+      , mPositions( mInput->size() )
+   {
+      // Resample reads preferences, so make the resamplers here, in the main
+      // thread
+      for (size_t ii = 0; ii < mInput->size(); ++ii)
+         mResamplers.push_back(std::make_unique<Resample>(
+            true, mFactor, mFactor)); // constant rate resampling
+   }
+
+   bool Render(Buffers &outputs) override
+   {
+      for (size_t ii = 0; ii < mInput->size(); ++ii) {
+         auto &input = (*mInput)[ii];
+         auto &samplePos = mPositions[ii];
+         if (samplePos >= input.size())
+            continue;
+         const auto blockSize = std::min(BlockSize, input.size() - samplePos);
+         std::copy(input.begin() + samplePos,
+            input.begin() + samplePos + blockSize, mInBuffer.get());
+         const auto results = mResamplers[ii]->Process(mFactor,
+            mInBuffer.get(),
+            blockSize,
+            samplePos + blockSize >= input.size(),
+            mOutBuffer.get(),
+            mOutBufferSize);
+         outputs[ii].insert(outputs[ii].end(),
+            mOutBuffer.get(), mOutBuffer.get() + results.second);
+         samplePos += results.first;
+      }
+      return true;
+   }
+
+private:
+   static constexpr size_t BlockSize = 65536;
+
+   const std::shared_ptr<const Buffers> mInput;
+   const double mFactor;
+   Floats mInBuffer;
+   const size_t mOutBufferSize;
+   Floats mOutBuffer;
+   std::vector<std::unique_ptr<Resample>> mResamplers;
+   std::vector<size_t> mPositions;
+};
+}
+
+std::unique_ptr<PreviewRenderer> EffectChangeSpeed::MakePreviewRenderer(
+   std::shared_ptr<const PreviewRenderer::Buffers> input, double)
+{
+   return std::make_unique<ChangeSpeedRenderer>(
+      std::move(input), 100.0 / (100.0 + m_PercentChange));
+}
+
 bool EffectChangeSpeed::Process()
 {
    // Similar to EffectSoundTouch::Process()
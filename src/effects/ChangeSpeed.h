@@ -53,6 +53,10 @@ public:
    bool Startup() override;
    bool Init() override;
    bool Process() override;
+   bool CanReusePreview() override;
+   std::unique_ptr<PreviewRenderer> MakePreviewRenderer(
+      std::shared_ptr<const PreviewRenderer::Buffers> input,
+      double rate) override;
    void PopulateOrExchange(ShuttleGui & S) override;
    bool TransferDataFromWindow() override;
    bool TransferDataToWindow() override;
@@ -193,6 +193,36 @@ bool EffectChangeTempo::Init()
    return true;
 }
 
+bool EffectChangeTempo::CanReusePreview()
+{
+   // The result depends only on the input and the parameters
+   return true;
+}
+
+std::unique_ptr<PreviewRenderer> EffectChangeTempo::MakePreviewRenderer(
+   std::shared_ptr<const PreviewRenderer::Buffers> input, double rate)
+{
+#if USE_SBSMS
+   if (mUseSBSMS)
+   {
+      double tempoRatio = 1.0 + m_PercentChange / 100.0;
+      EffectSBSMS proxy;
+      proxy.setParameters(tempoRatio, 1.0);
+      return proxy.MakePreviewRenderer(std::move(input), rate);
+   }
+   else
+#endif
+   {
+      auto initer = [percentChange = m_PercentChange](
+         soundtouch::SoundTouch *soundtouch)
+      {
+         soundtouch->setTempoChange(percentChange);
+      };
+      return EffectSoundTouch::MakeSoundTouchRenderer(
+         initer, false, std::move(input), rate);
+   }
+}
+
 bool EffectChangeTempo::Process()
 {
    bool success = false;
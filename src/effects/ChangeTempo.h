@@ -58,6 +58,10 @@ public:
    bool Init() override;
    bool CheckWhetherSkipEffect() override;
    bool Process() override;
+   bool CanReusePreview() override;
+   std::unique_ptr<PreviewRenderer> MakePreviewRenderer(
+      std::shared_ptr<const PreviewRenderer::Buffers> input,
+      double rate) override;
    double CalcPreviewInputLength(double previewLength) override;
    void PopulateOrExchange(ShuttleGui & S) override;
    bool TransferDataToWindow() override;
@@ -0,0 +1,68 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ChannelContents.cpp
+
+**********************************************************************/
+
+#include "ChannelContents.h"
+
+#include <algorithm>
+
+#include "../SampleBlock.h"
+#include "../Sequence.h"
+#include "../WaveClip.h"
+#include "../WaveTrack.h"
+
+ChannelContents::ChannelContents(
+   const WaveTrack &track, sampleCount start, sampleCount end)
+{
+   for (const auto &clip : track.GetClips())
+   {
+      const auto clipStart = clip->GetPlayStartSample();
+      const auto from = std::max(start, clipStart);
+      const auto to = std::min(end, clip->GetPlayEndSample());
+      if (from >= to)
+         continue;
+
+      // Position in the sequence, as in WaveClip::GetSamples()
+      auto seqPos =
+         from - clipStart + clip->TimeToSamples(clip->GetTrimLeft());
+      auto position = from - start;
+      auto remaining = to - from;
+
+      // Find the last block starting at or before seqPos
+      const auto &blocks = *clip->GetSequenceBlockArray();
+      auto iter = std::upper_bound(blocks.begin(), blocks.end(), seqPos,
+         [](sampleCount pos, const SeqBlock &block)
+            { return pos < block.start; });
+      if (iter == blocks.begin())
+         continue;
+      for (--iter; remaining > 0 && iter != blocks.end(); ++iter)
+      {
+         const auto offset = (seqPos - iter->start).as_size_t();
+         const auto count = limitSampleBufferSize(
+            iter->sb->GetSampleCount() - offset, remaining);
+         pieces.push_back({ position, iter->sb, offset, count });
+         seqPos += count;
+         position += count;
+         remaining -= count;
+      }
+   }
+
+   std::sort(pieces.begin(), pieces.end(),
+      [](const Piece &a, const Piece &b){ return a.position < b.position; });
+}
+
+bool ChannelContents::operator ==(const ChannelContents &other) const
+{
+   return std::equal(pieces.begin(), pieces.end(),
+      other.pieces.begin(), other.pieces.end(),
+      [](const Piece &a, const Piece &b){
+         return a.position == b.position &&
+            a.offset == b.offset && a.count == b.count &&
+            !a.block.owner_before(b.block) &&
+            !b.block.owner_before(a.block);
+      });
+}
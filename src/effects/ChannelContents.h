@@ -0,0 +1,47 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ChannelContents.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_CHANNEL_CONTENTS__
+#define __AUDACITY_CHANNEL_CONTENTS__
+
+#include <memory>
+#include <vector>
+
+#include "SampleCount.h"
+
+class SampleBlock;
+class WaveTrack;
+
+//! Identifies the samples of a channel in a region, by the sample blocks
+//! holding them
+/*!
+ Sample blocks are never modified once written, so any edit of the region
+ replaces some blocks, and the contents no longer compare equal.  Analyses
+ of the region may then be kept, and reused while the contents are equal.
+ */
+struct ChannelContents
+{
+   //! Part of the region held in one sample block
+   struct Piece
+   {
+      sampleCount position; //!< relative to the start of the region
+      std::weak_ptr<SampleBlock> block;
+      size_t offset; //!< within the block
+      size_t count;
+   };
+   //! Sorted by position; what lies between them is in no clip
+   std::vector<Piece> pieces;
+
+   ChannelContents(const WaveTrack &track, sampleCount start, sampleCount end);
+
+   bool operator ==(const ChannelContents &other) const;
+   bool operator !=(const ChannelContents &other) const
+      { return !(*this == other); }
+};
+
+#endif
@@ -525,6 +525,22 @@ bool EffectDistortion::TransferDataFromWindow()
    return true;
 }
 
+std::unique_ptr<Effect> EffectDistortion::CloneForParallelProcessing()
+{
+   // ProcessInitialize() makes all the state for each track, except that
+   // the threshold is not among the parameters
+   auto result = CloneWithSettings<EffectDistortion>();
+   if (result)
+      static_cast<EffectDistortion&>(*result).mThreshold = mThreshold;
+   return result;
+}
+
+std::optional<size_t> EffectDistortion::GetWarmUpLength(double sampleRate)
+{
+   // Fill the rolling average of DCFilter()
+   return mParams.mDCBlock ? static_cast<size_t>(sampleRate / 20.0) + 1 : 0;
+}
+
 void EffectDistortion::InstanceInit(EffectDistortionState & data, float sampleRate)
 {
    data.samplerate = sampleRate;
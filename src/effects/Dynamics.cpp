@@ -0,0 +1,337 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  Dynamics.cpp
+
+*******************************************************************//**
+
+\class EffectDynamics
+\brief A compressor and limiter that looks ahead, working in a single pass,
+so that it can also be applied in real time.
+
+*//*******************************************************************/
+
+
+#include "Dynamics.h"
+#include "LoadEffects.h"
+
+#include <wx/intl.h>
+
+#include "../Shuttle.h"
+#include "../ShuttleGui.h"
+#include "../widgets/valnum.h"
+
+// Define keys, defaults, minimums, and maximums for the effect parameters
+//
+//     Name          Type     Key                     Def      Min      Max      Scale
+Param( Threshold,    double,  wxT("Threshold"),        -12.0,   -60.0,   0.0,     1  );
+Param( Ratio,        double,  wxT("Ratio"),            4.0,     1.0,     100.0,   1  );
+Param( Knee,         double,  wxT("Knee"),             6.0,     0.0,     24.0,    1  );
+Param( AttackTime,   double,  wxT("AttackTime"),       5.0,     0.1,     100.0,   1  );
+Param( ReleaseTime,  double,  wxT("ReleaseTime"),      100.0,   1.0,     2000.0,  1  );
+Param( LookAhead,    double,  wxT("LookAhead"),        5.0,     0.0,     100.0,   1  );
+Param( MakeupGain,   double,  wxT("MakeupGain"),       0.0,     0.0,     30.0,    1  );
+
+const ComponentInterfaceSymbol EffectDynamics::Symbol
+{ XO("Dynamics") };
+
+namespace{ BuiltinEffectsModule::Registration< EffectDynamics > reg; }
+
+BEGIN_EVENT_TABLE(EffectDynamics, wxEvtHandler)
+   EVT_TEXT(wxID_ANY, EffectDynamics::OnText)
+END_EVENT_TABLE()
+
+EffectDynamics::EffectDynamics()
+{
+   mLatencyReported = false;
+
+   mThresholdDB = DEF_Threshold;
+   mRatio = DEF_Ratio;
+   mKneeDB = DEF_Knee;
+   mAttackTime = DEF_AttackTime;
+   mReleaseTime = DEF_ReleaseTime;
+   mLookAhead = DEF_LookAhead;
+   mMakeupGainDB = DEF_MakeupGain;
+
+   SetLinearEffectFlag(false);
+}
+
+EffectDynamics::~EffectDynamics()
+{
+}
+
+// ComponentInterface implementation
+
+ComponentInterfaceSymbol EffectDynamics::GetSymbol()
+{
+   return Symbol;
+}
+
+TranslatableString EffectDynamics::GetDescription()
+{
+   return XO("Compresses or limits the dynamic range, looking ahead to catch transients");
+}
+
+ManualPageID EffectDynamics::ManualPage()
+{
+   return L"Dynamics";
+}
+
+// EffectDefinitionInterface implementation
+
+EffectType EffectDynamics::GetType()
+{
+   return EffectTypeProcess;
+}
+
+bool EffectDynamics::SupportsRealtime()
+{
+#if defined(EXPERIMENTAL_REALTIME_AUDACITY_EFFECTS)
+   return true;
+#else
+   return false;
+#endif
+}
+
+// EffectClientInterface implementation
+
+// Both channels of a stereo track are reduced alike, so the image does
+// not shift
+unsigned EffectDynamics::GetAudioInCount()
+{
+   return 2;
+}
+
+unsigned EffectDynamics::GetAudioOutCount()
+{
+   return 2;
+}
+
+sampleCount EffectDynamics::GetLatency()
+{
+   // Reported once only, as the caller accumulates it
+   if (mMaster && !mLatencyReported)
+   {
+      mLatencyReported = true;
+      return mMaster->GetLatency();
+   }
+
+   return 0;
+}
+
+bool EffectDynamics::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelNames WXUNUSED(chanMap))
+{
+   mMaster.emplace(GetSettings(), mSampleRate, GetAudioInCount(), MAX_LookAhead);
+   mLatencyReported = false;
+
+   return true;
+}
+
+bool EffectDynamics::ProcessFinalize()
+{
+   mMaster.reset();
+
+   return true;
+}
+
+size_t EffectDynamics::ProcessBlock(float **inBlock, float **outBlock, size_t blockLen)
+{
+   mMaster->Process(inBlock, outBlock, blockLen);
+
+   return blockLen;
+}
+
+bool EffectDynamics::RealtimeInitialize()
+{
+   SetBlockSize(512);
+
+   mSlaves.clear();
+
+   return true;
+}
+
+bool EffectDynamics::RealtimeAddProcessor(unsigned WXUNUSED(numChannels), float sampleRate)
+{
+   // Allocate for the longest look-ahead now, so that changes of settings
+   // while playing never allocate
+   mSlaves.emplace_back(GetSettings(), sampleRate, GetAudioInCount(), MAX_LookAhead);
+
+   return true;
+}
+
+bool EffectDynamics::RealtimeFinalize()
+{
+   mSlaves.clear();
+
+   return true;
+}
+
+size_t EffectDynamics::RealtimeProcess(int group,
+                                       float **inbuf,
+                                       float **outbuf,
+                                       size_t numSamples)
+{
+   auto &slave = mSlaves[group];
+
+   const auto settings = GetSettings();
+   if (settings != slave.GetSettings())
+      slave.SetSettings(settings);
+
+   slave.Process(inbuf, outbuf, numSamples);
+
+   return numSamples;
+}
+
+bool EffectDynamics::DefineParams( ShuttleParams & S ){
+   S.SHUTTLE_PARAM( mThresholdDB, Threshold );
+   S.SHUTTLE_PARAM( mRatio, Ratio );
+   S.SHUTTLE_PARAM( mKneeDB, Knee );
+   S.SHUTTLE_PARAM( mAttackTime, AttackTime );
+   S.SHUTTLE_PARAM( mReleaseTime, ReleaseTime );
+   S.SHUTTLE_PARAM( mLookAhead, LookAhead );
+   S.SHUTTLE_PARAM( mMakeupGainDB, MakeupGain );
+   return true;
+}
+
+bool EffectDynamics::GetAutomationParameters(CommandParameters & parms)
+{
+   parms.Write(KEY_Threshold, mThresholdDB);
+   parms.Write(KEY_Ratio, mRatio);
+   parms.Write(KEY_Knee, mKneeDB);
+   parms.Write(KEY_AttackTime, mAttackTime);
+   parms.Write(KEY_ReleaseTime, mReleaseTime);
+   parms.Write(KEY_LookAhead, mLookAhead);
+   parms.Write(KEY_MakeupGain, mMakeupGainDB);
+
+   return true;
+}
+
+bool EffectDynamics::SetAutomationParameters(CommandParameters & parms)
+{
+   ReadAndVerifyDouble(Threshold);
+   ReadAndVerifyDouble(Ratio);
+   ReadAndVerifyDouble(Knee);
+   ReadAndVerifyDouble(AttackTime);
+   ReadAndVerifyDouble(ReleaseTime);
+   ReadAndVerifyDouble(LookAhead);
+   ReadAndVerifyDouble(MakeupGain);
+
+   mThresholdDB = Threshold;
+   mRatio = Ratio;
+   mKneeDB = Knee;
+   mAttackTime = AttackTime;
+   mReleaseTime = ReleaseTime;
+   mLookAhead = LookAhead;
+   mMakeupGainDB = MakeupGain;
+
+   return true;
+}
+
+bool EffectDynamics::CheckWhetherSkipEffect()
+{
+   // The look-ahead alone only delays, and the delay is removed
+   return (mRatio == 1.0 && mMakeupGainDB == 0.0);
+}
+
+// Effect implementation
+
+void EffectDynamics::PopulateOrExchange(ShuttleGui & S)
+{
+   S.SetBorder(5);
+   S.AddSpace(0, 5);
+
+   S.StartStatic(XO("Gain curve"));
+   {
+      S.StartMultiColumn(2, wxALIGN_CENTER);
+      {
+         S.Validator<FloatingPointValidator<double>>(
+               1, &mThresholdDB, NumValidatorStyle::DEFAULT,
+               MIN_Threshold, MAX_Threshold)
+            .AddTextBox(XXO("&Threshold (dB):"), wxT(""), 10);
+
+         S.Validator<FloatingPointValidator<double>>(
+               1, &mRatio, NumValidatorStyle::ONE_TRAILING_ZERO,
+               MIN_Ratio, MAX_Ratio)
+            .AddTextBox(XXO("&Ratio (100 to limit):"), wxT(""), 10);
+
+         S.Validator<FloatingPointValidator<double>>(
+               1, &mKneeDB, NumValidatorStyle::DEFAULT,
+               MIN_Knee, MAX_Knee)
+            .AddTextBox(XXO("&Knee width (dB):"), wxT(""), 10);
+
+         S.Validator<FloatingPointValidator<double>>(
+               1, &mMakeupGainDB, NumValidatorStyle::DEFAULT,
+               MIN_MakeupGain, MAX_MakeupGain)
+            .AddTextBox(XXO("&Make-up gain (dB):"), wxT(""), 10);
+      }
+      S.EndMultiColumn();
+   }
+   S.EndStatic();
+
+   S.StartStatic(XO("Timing"));
+   {
+      S.StartMultiColumn(2, wxALIGN_CENTER);
+      {
+         S.Validator<FloatingPointValidator<double>>(
+               1, &mAttackTime, NumValidatorStyle::NO_TRAILING_ZEROES,
+               MIN_AttackTime, MAX_AttackTime)
+            .AddTextBox(XXO("&Attack time (ms):"), wxT(""), 10);
+
+         S.Validator<FloatingPointValidator<double>>(
+               1, &mReleaseTime, NumValidatorStyle::NO_TRAILING_ZEROES,
+               MIN_ReleaseTime, MAX_ReleaseTime)
+            .AddTextBox(XXO("R&elease time (ms):"), wxT(""), 10);
+
+         S.Validator<FloatingPointValidator<double>>(
+               1, &mLookAhead, NumValidatorStyle::NO_TRAILING_ZEROES,
+               MIN_LookAhead, MAX_LookAhead)
+            .AddTextBox(XXO("&Look-ahead (ms):"), wxT(""), 10);
+      }
+      S.EndMultiColumn();
+   }
+   S.EndStatic();
+}
+
+bool EffectDynamics::TransferDataToWindow()
+{
+   if (!mUIParent->TransferDataToWindow())
+   {
+      return false;
+   }
+
+   return true;
+}
+
+bool EffectDynamics::TransferDataFromWindow()
+{
+   if (!mUIParent->Validate() || !mUIParent->TransferDataFromWindow())
+   {
+      return false;
+   }
+
+   return true;
+}
+
+std::unique_ptr<Effect> EffectDynamics::CloneForParallelProcessing()
+{
+   // ProcessInitialize() makes all the state for each track
+   return CloneWithSettings<EffectDynamics>();
+}
+
+// EffectDynamics implementation
+
+DynamicsProcessor::Settings EffectDynamics::GetSettings() const
+{
+   return {
+      mThresholdDB, mRatio, mKneeDB,
+      mAttackTime, mReleaseTime, mLookAhead,
+      mMakeupGainDB,
+   };
+}
+
+void EffectDynamics::OnText(wxCommandEvent & WXUNUSED(evt))
+{
+   // Realtime processing picks up the new settings at its next block
+   EnableApply(mUIParent->TransferDataFromWindow());
+}
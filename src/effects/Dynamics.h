@@ -0,0 +1,88 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  Dynamics.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_EFFECT_DYNAMICS__
+#define __AUDACITY_EFFECT_DYNAMICS__
+
+#include "Effect.h"
+#include "DynamicsProcessor.h"
+
+class ShuttleGui;
+
+class EffectDynamics final : public Effect
+{
+public:
+   static const ComponentInterfaceSymbol Symbol;
+
+   EffectDynamics();
+   virtual ~EffectDynamics();
+
+   // ComponentInterface implementation
+
+   ComponentInterfaceSymbol GetSymbol() override;
+   TranslatableString GetDescription() override;
+   ManualPageID ManualPage() override;
+
+   // EffectDefinitionInterface implementation
+
+   EffectType GetType() override;
+   bool SupportsRealtime() override;
+
+   // EffectClientInterface implementation
+
+   unsigned GetAudioInCount() override;
+   unsigned GetAudioOutCount() override;
+   sampleCount GetLatency() override;
+   bool ProcessInitialize(sampleCount totalLen, ChannelNames chanMap = NULL) override;
+   bool ProcessFinalize() override;
+   size_t ProcessBlock(float **inBlock, float **outBlock, size_t blockLen) override;
+   bool RealtimeInitialize() override;
+   bool RealtimeAddProcessor(unsigned numChannels, float sampleRate) override;
+   bool RealtimeFinalize() override;
+   size_t RealtimeProcess(int group,
+                               float **inbuf,
+                               float **outbuf,
+                               size_t numSamples) override;
+   bool DefineParams( ShuttleParams & S ) override;
+   bool GetAutomationParameters(CommandParameters & parms) override;
+   bool SetAutomationParameters(CommandParameters & parms) override;
+
+   // Effect implementation
+
+   void PopulateOrExchange(ShuttleGui & S) override;
+   bool TransferDataToWindow() override;
+   bool TransferDataFromWindow() override;
+
+   std::unique_ptr<Effect> CloneForParallelProcessing() override;
+
+   bool CheckWhetherSkipEffect() override;
+
+private:
+   // EffectDynamics implementation
+
+   DynamicsProcessor::Settings GetSettings() const;
+
+   void OnText(wxCommandEvent & evt);
+
+private:
+   std::optional<DynamicsProcessor> mMaster;
+   std::vector<DynamicsProcessor> mSlaves;
+   bool mLatencyReported;
+
+   double mThresholdDB;
+   double mRatio;
+   double mKneeDB;
+   double mAttackTime;
+   double mReleaseTime;
+   double mLookAhead;
+   double mMakeupGainDB;
+
+   DECLARE_EVENT_TABLE()
+};
+
+#endif
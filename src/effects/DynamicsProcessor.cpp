@@ -0,0 +1,201 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DynamicsProcessor.cpp
+
+*******************************************************************//**
+
+\class DynamicsProcessor
+\brief Look-ahead compressor and limiter.
+
+Each block passes through the stages in turn, each a simple loop over
+arrays: the peak over channels, the sliding maximum over the look-ahead
+window, the static gain curve, attack and release smoothing (the only
+recursive stage), and the delayed multiply.  While the level stays below
+the knee, no logarithms or exponentials are evaluated.
+
+*//*******************************************************************/
+
+#include "DynamicsProcessor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+//! Samples processed by each pass of the stages
+constexpr size_t ChunkSize = 256;
+
+//! Gain reduction (dB) small enough to end the release
+constexpr double NegligibleReduction = 1e-4;
+
+size_t MillisecondsToSamples(double ms, double rate)
+{
+   return static_cast<size_t>(std::max(0.0, ms) * rate / 1000.0 + 0.5);
+}
+
+double SmoothingFactor(double ms, double rate)
+{
+   const auto samples = ms * rate / 1000.0;
+   return samples > 0 ? exp(-1.0 / samples) : 0.0;
+}
+
+}
+
+bool DynamicsProcessor::Settings::operator ==(const Settings &other) const
+{
+   return thresholdDB == other.thresholdDB
+      && ratio == other.ratio
+      && kneeDB == other.kneeDB
+      && attackMS == other.attackMS
+      && releaseMS == other.releaseMS
+      && lookAheadMS == other.lookAheadMS
+      && makeupGainDB == other.makeupGainDB;
+}
+
+DynamicsProcessor::DynamicsProcessor(const Settings &settings,
+   double sampleRate, unsigned numChannels, double maxLookAheadMS)
+   : mRate{ sampleRate }
+   , mNumChannels{ std::max(1u, numChannels) }
+   , mMaxLookAhead{ MillisecondsToSamples(maxLookAheadMS, sampleRate) }
+   , mDelay((mMaxLookAhead + 1) * mNumChannels)
+   // One more than the window, because a level is pushed before the
+   // oldest is dropped
+   , mWindowLevels(mMaxLookAhead + 2)
+   , mWindowPositions(mMaxLookAhead + 2)
+   , mLevels(ChunkSize)
+   , mGains(ChunkSize)
+{
+   SetSettings(settings);
+}
+
+void DynamicsProcessor::SetSettings(const Settings &settings)
+{
+   mSettings = settings;
+   mLookAhead = std::min(mMaxLookAhead,
+      MillisecondsToSamples(settings.lookAheadMS, mRate));
+   mThresholdDB = settings.thresholdDB;
+   mKneeDB = std::max(0.0, settings.kneeDB);
+   mSlope = 1.0 / std::max(1.0, settings.ratio) - 1.0;
+   mKneeStart = pow(10.0, (mThresholdDB - mKneeDB / 2) / 20.0);
+   mAttackFactor = SmoothingFactor(settings.attackMS, mRate);
+   mReleaseFactor = SmoothingFactor(settings.releaseMS, mRate);
+   mMakeupGain = pow(10.0, settings.makeupGainDB / 20.0);
+}
+
+void DynamicsProcessor::Reset()
+{
+   std::fill(mDelay.begin(), mDelay.end(), 0.0f);
+   mDelayPos = 0;
+   mWindowFront = 0;
+   mWindowCount = 0;
+   mPosition = 0;
+   mReduction = 0;
+}
+
+void DynamicsProcessor::Process(
+   const float *const *input, float *const *output, size_t len)
+{
+   for (size_t offset = 0; offset < len; offset += ChunkSize)
+      ProcessChunk(input, output, offset, std::min(ChunkSize, len - offset));
+}
+
+float DynamicsProcessor::PushLevel(float level)
+{
+   const auto size = mWindowLevels.size();
+   // Levels not greater than the new one can never again be the maximum
+   while (mWindowCount > 0) {
+      const auto back = (mWindowFront + mWindowCount - 1) % size;
+      if (mWindowLevels[back] > level)
+         break;
+      --mWindowCount;
+   }
+   const auto back = (mWindowFront + mWindowCount) % size;
+   mWindowLevels[back] = level;
+   mWindowPositions[back] = mPosition;
+   ++mWindowCount;
+
+   // Drop levels that have passed out of the window
+   while (mWindowPositions[mWindowFront] + mLookAhead < mPosition) {
+      mWindowFront = (mWindowFront + 1) % size;
+      --mWindowCount;
+   }
+   ++mPosition;
+   return mWindowLevels[mWindowFront];
+}
+
+void DynamicsProcessor::ProcessChunk(const float *const *input,
+   float *const *output, size_t offset, size_t len)
+{
+   const auto levels = mLevels.data();
+   const auto gains = mGains.data();
+
+   // Peak over the channels
+   std::fill(levels, levels + len, 0.0f);
+   for (unsigned cc = 0; cc < mNumChannels; ++cc) {
+      const auto in = input[cc] + offset;
+      for (size_t ii = 0; ii < len; ++ii)
+         levels[ii] = std::max(levels[ii], std::fabs(in[ii]));
+   }
+
+   // Peak over the look-ahead, which ends at the sample now entering the
+   // delay line
+   for (size_t ii = 0; ii < len; ++ii)
+      levels[ii] = PushLevel(levels[ii]);
+
+   // Static curve, then smoothing of the gain reduction, in dB
+   const auto kneeStart = mKneeStart;
+   const auto threshold = mThresholdDB;
+   const auto knee = mKneeDB;
+   const auto slope = mSlope;
+   auto reduction = mReduction;
+   for (size_t ii = 0; ii < len; ++ii) {
+      double target = 0;
+      const auto level = levels[ii];
+      if (level > kneeStart) {
+         const auto over = 20.0 * log10(level) - threshold;
+         // With no knee, a level at the threshold may round to below it
+         if (knee <= 0 || 2 * over > knee)
+            target = slope * std::max(0.0, over);
+         else {
+            // Quadratic through the knee, meeting both straight lines
+            const auto x = over + knee / 2;
+            target = slope * x * x / (2 * knee);
+         }
+      }
+
+      const auto factor = target < reduction ? mAttackFactor : mReleaseFactor;
+      reduction = target + factor * (reduction - target);
+      if (target == 0 && reduction > -NegligibleReduction)
+         reduction = 0;
+      gains[ii] = reduction;
+   }
+   mReduction = reduction;
+
+   const auto makeup = mMakeupGain;
+   for (size_t ii = 0; ii < len; ++ii)
+      gains[ii] = gains[ii] == 0
+         ? makeup
+         : makeup * static_cast<float>(pow(10.0, gains[ii] / 20.0));
+
+   // Delay each channel by the look-ahead and apply the gain
+   const auto ringSize = mMaxLookAhead + 1;
+   const auto lookAhead = mLookAhead;
+   for (unsigned cc = 0; cc < mNumChannels; ++cc) {
+      const auto ring = mDelay.data() + cc * ringSize;
+      const auto in = input[cc] + offset;
+      const auto out = output[cc] + offset;
+      auto pos = mDelayPos;
+      auto readPos = (pos + ringSize - lookAhead) % ringSize;
+      for (size_t ii = 0; ii < len; ++ii) {
+         ring[pos] = in[ii];
+         out[ii] = gains[ii] * ring[readPos];
+         if (++pos == ringSize)
+            pos = 0;
+         if (++readPos == ringSize)
+            readPos = 0;
+      }
+   }
+   mDelayPos = (mDelayPos + len) % ringSize;
+}
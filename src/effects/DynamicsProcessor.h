@@ -0,0 +1,103 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DynamicsProcessor.h
+
+  Look-ahead compressor and limiter, working a block at a time, for both
+  destructive and realtime processing.
+
+**********************************************************************/
+
+#ifndef __AUDACITY_DYNAMICS_PROCESSOR__
+#define __AUDACITY_DYNAMICS_PROCESSOR__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//! Reduces the gain of all channels alike, when the loudest passes a threshold
+/*!
+ The level is the peak over all channels, in a window that reaches
+ GetLatency() samples ahead, so that gain reduction is under way when a
+ transient arrives.  The output is delayed by that many samples.
+
+ Neither SetSettings() nor Process() allocates or locks, so both may be
+ called from the PortAudio callback.
+ */
+class DynamicsProcessor final
+{
+public:
+   struct Settings
+   {
+      double thresholdDB;
+      double ratio;        //!< 1 for no compression; large values limit
+      double kneeDB;       //!< width of the soft knee, centred on threshold
+      double attackMS;
+      double releaseMS;
+      double lookAheadMS;
+      double makeupGainDB;
+
+      bool operator ==(const Settings &other) const;
+      bool operator !=(const Settings &other) const
+         { return !(*this == other); }
+   };
+
+   /*!
+    @param maxLookAheadMS bounds the look-ahead of all later settings
+    */
+   DynamicsProcessor(const Settings &settings, double sampleRate,
+      unsigned numChannels, double maxLookAheadMS);
+
+   void SetSettings(const Settings &settings);
+   const Settings &GetSettings() const { return mSettings; }
+
+   //! Delay of the output, in samples
+   size_t GetLatency() const { return mLookAhead; }
+
+   //! Forget all previous input
+   void Reset();
+
+   //! Process len samples of each channel; output may be the same as input
+   void Process(const float *const *input, float *const *output, size_t len);
+
+private:
+   void ProcessChunk(const float *const *input, float *const *output,
+      size_t offset, size_t len);
+   //! Peak over the look-ahead window of the level just pushed
+   float PushLevel(float level);
+
+   Settings mSettings;
+   const double mRate;
+   const unsigned mNumChannels;
+   const size_t mMaxLookAhead;
+
+   // Derived from mSettings
+   size_t mLookAhead;
+   float mKneeStart;        //!< linear level below which gain is unchanged
+   double mThresholdDB;
+   double mKneeDB;
+   double mSlope;           //!< 1/ratio - 1
+   double mAttackFactor;
+   double mReleaseFactor;
+   float mMakeupGain;
+
+   //! Delayed input, one ring of mMaxLookAhead + 1 samples per channel
+   std::vector<float> mDelay;
+   size_t mDelayPos{ 0 };
+
+   //! Decreasing levels, and their positions, for the sliding maximum
+   std::vector<float> mWindowLevels;
+   std::vector<uint64_t> mWindowPositions;
+   size_t mWindowFront{ 0 };
+   size_t mWindowCount{ 0 };
+   uint64_t mPosition{ 0 };
+
+   //! Current gain reduction in dB, never positive
+   double mReduction{ 0 };
+
+   std::vector<float> mLevels;
+   std::vector<float> mGains;
+};
+
+#endif
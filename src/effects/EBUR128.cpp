@@ -9,6 +9,7 @@ Max Maisel
 ***********************************************************************/
 
 #include "EBUR128.h"
+#include <algorithm>
 #include <cstring>
 
 EBUR128::EBUR128(double rate, size_t channels)
@@ -118,6 +119,82 @@ void EBUR128::NextSample()
    ++mSampleCount;
 }
 
+void EBUR128::ProcessSamples(const float *const *channels, size_t len)
+{
+   size_t offset = 0;
+   while(offset < len)
+   {
+      // Stop at each boundary of the overlapping blocks, where NextSample()
+      // would add to the histogram, and at the end of the ring
+      const auto n = std::min({ len - offset,
+         mBlockOverlap - mBlockRingPos % mBlockOverlap,
+         mBlockSize - mBlockRingPos });
+
+      size_t channel = 0;
+      if(mChannelCount >= 2)
+      {
+         WeightTwoChannels(channels[0] + offset, channels[1] + offset, n);
+         channel = 2;
+      }
+      for(; channel < mChannelCount; ++channel)
+         WeightChannel(channels[channel] + offset, channel, n);
+
+      // As in NextSample()
+      mBlockRingPos += n;
+      mBlockRingSize += n;
+      if(mBlockRingPos % mBlockOverlap == 0)
+      {
+         if(mBlockRingSize >= mBlockSize)
+            AddBlockToHistogram(mBlockSize);
+      }
+      if(mBlockRingPos == mBlockSize)
+         mBlockRingPos = 0;
+      mSampleCount += n;
+
+      offset += n;
+   }
+}
+
+namespace {
+// Samples weighted at a time, into buffers on the stack
+constexpr size_t WeightChunk = 256;
+}
+
+void EBUR128::WeightChannel(const float *input, size_t channel, size_t len)
+{
+   float weighted[WeightChunk];
+   for(size_t offset = 0; offset < len; offset += WeightChunk)
+   {
+      const auto n = std::min(WeightChunk, len - offset);
+      Biquad::ProcessCascade(mWeightingFilter[channel].get(), 2,
+         input + offset, weighted, n);
+      auto ring = &mBlockRingBuffer[mBlockRingPos + offset];
+      if(channel == 0)
+         for(size_t i = 0; i < n; ++i)
+            ring[i] = double(weighted[i]) * weighted[i];
+      else
+         for(size_t i = 0; i < n; ++i)
+            ring[i] += double(weighted[i]) * weighted[i];
+   }
+}
+
+void EBUR128::WeightTwoChannels(
+   const float *input0, const float *input1, size_t len)
+{
+   float weighted0[WeightChunk], weighted1[WeightChunk];
+   for(size_t offset = 0; offset < len; offset += WeightChunk)
+   {
+      const auto n = std::min(WeightChunk, len - offset);
+      Biquad::ProcessCascade(mWeightingFilter[0].get(),
+         mWeightingFilter[1].get(), 2, input0 + offset, input1 + offset,
+         weighted0, weighted1, n);
+      auto ring = &mBlockRingBuffer[mBlockRingPos + offset];
+      for(size_t i = 0; i < n; ++i)
+         ring[i] = double(weighted0[i]) * weighted0[i]
+            + double(weighted1[i]) * weighted1[i];
+   }
+}
+
 double EBUR128::IntegrativeLoudness()
 {
    // EBU R128: z_i = mean square without root
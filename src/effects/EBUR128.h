@@ -30,6 +30,10 @@ public:
    void Initialize();
    void ProcessSampleFromChannel(float x_in, size_t channel);
    void NextSample();
+   //! Process len samples of every channel at once
+   /*! Same results as ProcessSampleFromChannel() for each channel and then
+      NextSample(), len times, but much faster */
+   void ProcessSamples(const float *const *channels, size_t len);
    double IntegrativeLoudness();
    inline double IntegrativeLoudnessToLUFS(double loudness)
       { return 10 * log10(loudness); }
@@ -37,6 +41,11 @@ public:
 private:
    void HistogramSums(size_t start_idx, double& sum_v, long int& sum_c);
    void AddBlockToHistogram(size_t validLen);
+   //! Accumulate weighted powers of one channel into the ring buffer
+   void WeightChannel(const float *input, size_t channel, size_t len);
+   //! Same as two calls of WeightChannel(), for channels 0 and 1
+   void WeightTwoChannels(const float *input0, const float *input1,
+      size_t len);
 
    static const size_t HIST_BIN_COUNT = 65536;
    /// EBU R128 absolute threshold
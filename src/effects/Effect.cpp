@@ -17,19 +17,31 @@
 
 
 #include "Effect.h"
+#include "ChannelContents.h"
+#include "PreviewPlayback.h"
 #include "TimeWarper.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 #include <wx/defs.h>
+#include <wx/evtloop.h>
 #include <wx/sizer.h>
 #include <wx/tokenzr.h>
+#include <wx/utils.h>
 
 #include "../AudioIO.h"
 #include "widgets/wxWidgetsWindowPlacement.h"
 #include "../DBConnection.h"
 #include "../LabelTrack.h"
 #include "../Mix.h"
+#include "../ParallelFor.h"
 #include "../PluginManager.h"
 #include "../ProjectAudioManager.h"
 #include "../ProjectFileIO.h"
@@ -63,6 +75,51 @@ const wxString Effect::kFactoryDefaultsIdent = wxT("<Factory Defaults>");
 
 using t2bHash = std::unordered_map< void*, bool >;
 
+//! A rendering made by Preview(), with all that determined its result
+struct Effect::PreviewRendering
+{
+   //! One wave track of the project, as it was copied or mixed for preview
+   struct Input
+   {
+      ChannelContents contents;
+      double rate;
+      float gain;
+      float pan;
+      bool selected;
+
+      bool operator ==(const Input &other) const
+      {
+         return contents == other.contents && rate == other.rate &&
+            gain == other.gain && pan == other.pan &&
+            selected == other.selected;
+      }
+   };
+
+   std::vector<Input> inputs;
+   double t0;
+   double t1;
+   double selectionEnd;
+   wxString parameters;
+
+   bool SameInput(const PreviewRendering &other) const
+   {
+      return inputs == other.inputs && t0 == other.t0 && t1 == other.t1 &&
+         selectionEnd == other.selectionEnd &&
+         parameters == other.parameters;
+   }
+
+   //! Result of processing, starting at time zero
+   std::shared_ptr<TrackList> tracks;
+   double playEnd;
+};
+
+//! How many renderings Preview() keeps
+static constexpr size_t MaxPreviewRenderings = 4;
+
+//! Part of the preview that a rendering in the background does first,
+//! before Preview() plays it
+static constexpr double PreviewChunkFraction = 0.25;
+
 namespace {
 
 Effect::VetoDialogHook &GetVetoDialogHook()
@@ -657,6 +714,9 @@ bool Effect::CloseUI()
    mUIParent = NULL;
    mUIDialog = NULL;
 
+   // Renderings hold sample blocks of the project
+   mPreviewRenderings.clear();
+
    return true;
 }
 
@@ -1255,6 +1315,7 @@ bool Effect::DoEffect(double projectRate,
 
       End();
       ReplaceProcessedTracks( false );
+      mPreviewRenderings.clear();
    } );
 
    // We don't yet know the effect type for code in the Nyquist Prompt, so
@@ -1394,6 +1455,348 @@ bool Effect::Process()
    return bGoodResult;
 }
 
+std::unique_ptr<Effect> Effect::CloneForParallelProcessing()
+{
+   return nullptr;
+}
+
+std::optional<size_t> Effect::GetWarmUpLength(double)
+{
+   return {};
+}
+
+bool Effect::CopySettingsTo(Effect &other)
+{
+   wxString parms;
+   return GetAutomationParameters(parms) &&
+      other.SetAutomationParameters(parms);
+}
+
+namespace {
+
+//! One selected track, or a stereo pair if the effect is multichannel
+struct TrackGroup
+{
+   WaveTrack *left;
+   WaveTrack *right;
+   sampleCount start;
+   sampleCount len;
+   ChannelName map[3];
+   unsigned numChannels;
+};
+
+//! Feeds one group of channels through an instance of an effect, a buffer
+//! at a time, removing the latency that the effect reports
+class EffectStream
+{
+public:
+   /*!
+    @param outputLength total of samples to produce, after which Process()
+    produces no more
+    @param discard number of samples of output to drop at the start, after
+    the latency
+    */
+   EffectStream(Effect &effect, unsigned numChannels, size_t blockSize,
+      sampleCount outputLength, sampleCount discard = 0)
+      : mEffect{ effect }
+      , mNumChannels{ numChannels }
+      , mNumAudioIn{ effect.GetAudioInCount() }
+      , mNumAudioOut{ effect.GetAudioOutCount() }
+      , mBlockSize{ blockSize }
+      , mZeroes{ blockSize, true }
+      , mScratch{ std::max(1u, mNumAudioOut), blockSize }
+      , mInPos{ std::max(1u, mNumAudioIn) }
+      , mOutPos{ std::max(1u, mNumAudioOut) }
+      , mDiscard{ discard }
+      , mRemaining{ outputLength }
+      , mIsProcessor{ effect.GetType() == EffectTypeProcess }
+   {
+   }
+
+   //! Samples still to be produced
+   sampleCount Remaining() const { return mRemaining; }
+
+   //! Process some samples of input, or zeroes after the end of input
+   /*!
+    @param input mNumChannels arrays of len samples, or null for zeroes
+    @param output mNumChannels arrays with room for len samples
+    @return how many samples were written to output, no more than len
+    */
+   size_t Process(const float *const *input, size_t len,
+      float *const *output)
+   {
+      size_t produced = 0;
+      for (size_t pos = 0; pos < len && mRemaining > 0;) {
+         const auto curBlockSize = std::min(mBlockSize, len - pos);
+         for (size_t i = 0; i < mNumAudioIn; i++)
+            mInPos[i] = (input && i < mNumChannels)
+               ? const_cast<float*>(input[i] + pos)
+               : mZeroes.get();
+         for (size_t i = 0; i < mNumAudioOut; i++)
+            mOutPos[i] = mScratch[i].get();
+
+         const auto processed =
+            mEffect.ProcessBlock(mInPos.get(), mOutPos.get(), curBlockSize);
+         wxASSERT(processed == curBlockSize);
+         wxUnusedVar(processed);
+         pos += curBlockSize;
+
+         if (mIsProcessor)
+            mDiscard += mEffect.GetLatency();
+
+         // Drop delayed samples, and warm-up samples, from the front
+         const auto drop =
+            limitSampleBufferSize(curBlockSize, mDiscard);
+         mDiscard -= drop;
+         const auto keep =
+            limitSampleBufferSize(curBlockSize - drop, mRemaining);
+         for (size_t i = 0; i < mNumChannels; i++) {
+            // A mono effect applied to a stereo pair fills both channels
+            const auto &scratch = mScratch[std::min<size_t>(i,
+               std::max(1u, std::min(mNumAudioOut, mNumChannels)) - 1)];
+            std::copy(scratch.get() + drop, scratch.get() + drop + keep,
+               output[i] + produced);
+         }
+         produced += keep;
+         mRemaining -= keep;
+      }
+      return produced;
+   }
+
+private:
+   Effect &mEffect;
+   const unsigned mNumChannels;
+   const unsigned mNumAudioIn;
+   const unsigned mNumAudioOut;
+   const size_t mBlockSize;
+   Floats mZeroes;
+   FloatBuffers mScratch;
+   ArrayOf<float *> mInPos, mOutPos;
+   sampleCount mDiscard;
+   sampleCount mRemaining;
+   const bool mIsProcessor;
+};
+
+//! Part of a track group, to be processed by one copy of the effect
+struct Segment
+{
+   const TrackGroup *group;
+   sampleCount start;
+   sampleCount len;
+   //! Input preceding start, whose output is discarded
+   size_t warmUpLen;
+   FloatBuffers warmUp;
+};
+
+//! Segments are no shorter than this, nor than a few times the warm-up
+constexpr size_t MinSegmentLength = 1 << 20;
+
+//! Cut the groups into segments, where the effect allows it
+/*!
+ The warm-up input is read now, before any output is written over it.
+ */
+std::vector<Segment> MakeSegments(const std::vector<TrackGroup> &groups,
+   const std::function<std::optional<size_t>(double)> &warmUpLength)
+{
+   std::vector<Segment> segments;
+   for (const auto &group : groups) {
+      long long nSegments = 1;
+      const auto warmUp = warmUpLength(group.left->GetRate());
+      if (warmUp) {
+         const auto minLength =
+            std::max<long long>(MinSegmentLength, 4 * *warmUp);
+         nSegments = std::clamp<long long>(
+            group.len.as_long_long() / minLength, 1, ParallelConcurrency());
+      }
+
+      const auto len = group.len.as_long_long();
+      for (long long ii = 0; ii < nSegments; ++ii) {
+         const auto start = len * ii / nSegments;
+         const auto end = len * (ii + 1) / nSegments;
+         Segment segment{ &group, group.start + start, end - start, 0 };
+         if (ii > 0) {
+            segment.warmUpLen = std::min<long long>(*warmUp, start);
+            segment.warmUp.reinit(2, segment.warmUpLen);
+            const auto pos = segment.start - segment.warmUpLen;
+            group.left->GetFloats(
+               segment.warmUp[0].get(), pos, segment.warmUpLen);
+            if (group.right)
+               group.right->GetFloats(
+                  segment.warmUp[1].get(), pos, segment.warmUpLen);
+         }
+         segments.push_back(std::move(segment));
+      }
+   }
+   return segments;
+}
+
+//! Process track groups concurrently, each with its own copy of the effect
+/*!
+ Only the calling thread reads and writes the tracks; other threads only run
+ the effect on buffers.
+ @param clone makes another copy of the effect
+ @param warmUpLength if it gives a value for a sample rate, long groups may
+ also be cut into segments processed concurrently
+ @param progress given the fraction done, returns true to cancel
+ */
+bool ProcessGroupsInParallel(const std::vector<TrackGroup> &groups,
+   std::unique_ptr<Effect> prototype,
+   const std::function<std::unique_ptr<Effect>()> &clone,
+   const std::function<std::optional<size_t>(double)> &warmUpLength,
+   const std::function<bool(double)> &progress)
+{
+   struct Slot {
+      std::unique_ptr<Effect> effect;
+      const Segment *segment{};
+      std::optional<EffectStream> stream;
+      sampleCount inPos, outPos, inputRemaining;
+      size_t bufferSize{}, inputCount{}, produced{};
+      FloatBuffers inBuffer, outBuffer;
+      bool initialized{ false };
+      bool warmUpPending{ false };
+   };
+
+   const auto segments = MakeSegments(groups, warmUpLength);
+   const auto nSlots =
+      std::min<size_t>(ParallelConcurrency(), segments.size());
+   std::vector<Slot> slots(nSlots);
+   if (nSlots > 0)
+      slots[0].effect = std::move(prototype);
+   for (size_t i = 1; i < nSlots; i++)
+      if (!(slots[i].effect = clone()))
+         return false;
+
+   // Allow each copy to clean up, if processing ends early
+   auto cleanup = finally([&]{
+      for (auto &slot : slots)
+         if (slot.initialized)
+            slot.effect->ProcessFinalize();
+   });
+
+   double totalLength = 0, done = 0;
+   for (const auto &group : groups)
+      totalLength += group.len.as_double();
+
+   size_t nextSegment = 0;
+   auto startSegment = [&](Slot &slot) {
+      slot.stream.reset();
+      if (slot.initialized) {
+         slot.initialized = false;
+         if (!slot.effect->ProcessFinalize())
+            return false;
+      }
+      if (nextSegment == segments.size()) {
+         slot.segment = nullptr;
+         return true;
+      }
+
+      const auto &segment = segments[nextSegment++];
+      const auto &group = *segment.group;
+      auto &effect = *slot.effect;
+      effect.SetSampleRate(group.left->GetRate());
+      const auto max = group.left->GetMaxBlockSize();
+      const auto blockSize = effect.SetBlockSize(max);
+      if (!effect.ProcessInitialize(segment.len + segment.warmUpLen,
+            const_cast<ChannelName*>(group.map)))
+         return false;
+      slot.initialized = true;
+      slot.segment = &segment;
+      slot.stream.emplace(effect, group.numChannels, blockSize,
+         segment.len, segment.warmUpLen);
+      slot.warmUpPending = (segment.warmUpLen > 0);
+      slot.inPos = slot.outPos = segment.start;
+      slot.inputRemaining = segment.len;
+      if (slot.bufferSize != max) {
+         slot.bufferSize = max;
+         slot.inBuffer.reinit(2, max);
+         slot.outBuffer.reinit(2, max);
+      }
+      return true;
+   };
+   for (auto &slot : slots)
+      if (!startSegment(slot))
+         return false;
+
+   while (true) {
+      // Read input in this thread
+      bool any = false;
+      for (auto &slot : slots) {
+         if (!slot.segment)
+            continue;
+         any = true;
+         const auto &group = *slot.segment->group;
+         slot.inputCount =
+            limitSampleBufferSize(slot.bufferSize, slot.inputRemaining);
+         if (slot.inputCount > 0) {
+            group.left->GetFloats(
+               slot.inBuffer[0].get(), slot.inPos, slot.inputCount);
+            if (group.right)
+               group.right->GetFloats(
+                  slot.inBuffer[1].get(), slot.inPos, slot.inputCount);
+         }
+      }
+      if (!any)
+         break;
+
+      // Apply the effects concurrently
+      try {
+         ParallelFor(slots.size(), [&](size_t i) {
+            auto &slot = slots[i];
+            if (!slot.segment)
+               return;
+            float *outputs[]{
+               slot.outBuffer[0].get(), slot.outBuffer[1].get() };
+            if (slot.warmUpPending) {
+               // All of this output is discarded
+               const auto &warmUp = slot.segment->warmUp;
+               float *inputs[]{ warmUp[0].get(), warmUp[1].get() };
+               slot.stream->Process(
+                  inputs, slot.segment->warmUpLen, outputs);
+               slot.warmUpPending = false;
+            }
+            float *inputs[]{ slot.inBuffer[0].get(), slot.inBuffer[1].get() };
+            slot.produced = (slot.inputCount > 0)
+               ? slot.stream->Process(inputs, slot.inputCount, outputs)
+               // Flush delayed samples
+               : slot.stream->Process(nullptr, slot.bufferSize, outputs);
+         }, nSlots);
+      }
+      catch (const AudacityException &) {
+         throw;
+      }
+      catch (...) {
+         // As in ProcessTrack, for exceptions maybe from third-party code
+         return false;
+      }
+
+      // Write output in this thread, in order of the slots
+      for (auto &slot : slots) {
+         if (!slot.segment)
+            continue;
+         const auto &group = *slot.segment->group;
+         group.left->Set((samplePtr) slot.outBuffer[0].get(), floatSample,
+            slot.outPos, slot.produced);
+         if (group.right)
+            group.right->Set((samplePtr) slot.outBuffer[1].get(),
+               floatSample, slot.outPos, slot.produced);
+         slot.outPos += slot.produced;
+         slot.inPos += slot.inputCount;
+         slot.inputRemaining -= slot.inputCount;
+         done += slot.inputCount;
+
+         if (slot.stream->Remaining() == 0 && !startSegment(slot))
+            return false;
+      }
+
+      if (progress(totalLength > 0 ? done / totalLength : 1.0))
+         return false;
+   }
+
+   return true;
+}
+
+}
+
 bool Effect::ProcessPass()
 {
    bool bGoodResult = true;
@@ -1402,14 +1805,99 @@ bool Effect::ProcessPass()
    FloatBuffers inBuffer, outBuffer;
    ArrayOf<float *> inBufPos, outBufPos;
 
-   ChannelName map[3];
-
    mBufferSize = 0;
    mBlockSize = 0;
 
    int count = 0;
    bool clear = false;
 
+   // If the effect can be copied, gather the groups of tracks first, then
+   // process them (or segments of them) concurrently
+   std::unique_ptr<Effect> prototype;
+   if (GetType() == EffectTypeProcess && ParallelConcurrency() > 1)
+      prototype = CloneForParallelProcessing();
+   std::vector<TrackGroup> groups;
+
+   auto processGroup = [&](TrackGroup &group) {
+      const auto left = group.left;
+      const auto right = group.right;
+      const auto start = group.start;
+      const auto len = group.len;
+      mNumChannels = group.numChannels;
+
+      if (!isGenerator)
+         mSampleCnt = len;
+      else
+         mSampleCnt = left->TimeToLongSamples(mDuration);
+
+      // Let the client know the sample rate
+      SetSampleRate(left->GetRate());
+
+      // Get the block size the client wants to use
+      auto max = left->GetMaxBlockSize() * 2;
+      mBlockSize = SetBlockSize(max);
+
+      // Calculate the buffer size to be at least the max rounded up to the clients
+      // selected block size.
+      const auto prevBufferSize = mBufferSize;
+      mBufferSize = ((max + (mBlockSize - 1)) / mBlockSize) * mBlockSize;
+
+      // If the buffer size has changed, then (re)allocate the buffers
+      if (prevBufferSize != mBufferSize)
+      {
+         // Always create the number of input buffers the client expects even if we don't have
+         // the same number of channels.
+         inBufPos.reinit( mNumAudioIn );
+         inBuffer.reinit( mNumAudioIn, mBufferSize );
+
+         // We won't be using more than the first 2 buffers, so clear the rest (if any)
+         for (size_t i = 2; i < mNumAudioIn; i++)
+         {
+            for (size_t j = 0; j < mBufferSize; j++)
+            {
+               inBuffer[i][j] = 0.0;
+            }
+         }
+
+         // Always create the number of output buffers the client expects even if we don't have
+         // the same number of channels.
+         outBufPos.reinit( mNumAudioOut );
+         // Output buffers get an extra mBlockSize worth to give extra room if
+         // the plugin adds latency
+         outBuffer.reinit( mNumAudioOut, mBufferSize + mBlockSize );
+      }
+
+      // (Re)Set the input buffer positions
+      for (size_t i = 0; i < mNumAudioIn; i++)
+      {
+         inBufPos[i] = inBuffer[i].get();
+      }
+
+      // (Re)Set the output buffer positions
+      for (size_t i = 0; i < mNumAudioOut; i++)
+      {
+         outBufPos[i] = outBuffer[i].get();
+      }
+
+      // Clear unused input buffers
+      if (!right && !clear && mNumAudioIn > 1)
+      {
+         for (size_t j = 0; j < mBufferSize; j++)
+         {
+            inBuffer[1][j] = 0.0;
+         }
+         clear = true;
+      }
+
+      // Go process the track(s)
+      bool result = ProcessTrack(
+         count, group.map, left, right, start, len,
+         inBuffer, outBuffer, inBufPos, outBufPos);
+      if (result)
+         count++;
+      return result;
+   };
+
    const bool multichannel = mNumAudioIn > 1;
    auto range = multichannel
       ? mOutputTracks->Leaders()
@@ -1419,11 +1907,9 @@ bool Effect::ProcessPass()
          if (!left->GetSelected())
             return fallthrough();
 
-         sampleCount len = 0;
-         sampleCount start = 0;
-
-         mNumChannels = 0;
-         WaveTrack *right{};
+         TrackGroup group{ left, nullptr };
+         auto &map = group.map;
+         unsigned numChannels = 0;
 
          // Iterate either over one track which could be any channel,
          // or if multichannel, then over all channels of left,
@@ -1431,102 +1917,35 @@ bool Effect::ProcessPass()
          for (auto channel :
               TrackList::Channels(left).StartingWith(left)) {
             if (channel->GetChannel() == Track::LeftChannel)
-               map[mNumChannels] = ChannelNameFrontLeft;
+               map[numChannels] = ChannelNameFrontLeft;
             else if (channel->GetChannel() == Track::RightChannel)
-               map[mNumChannels] = ChannelNameFrontRight;
+               map[numChannels] = ChannelNameFrontRight;
             else
-               map[mNumChannels] = ChannelNameMono;
+               map[numChannels] = ChannelNameMono;
 
-            ++ mNumChannels;
-            map[mNumChannels] = ChannelNameEOL;
+            ++ numChannels;
+            map[numChannels] = ChannelNameEOL;
 
             if (! multichannel)
                break;
 
-            if (mNumChannels == 2) {
+            if (numChannels == 2) {
                // TODO: more-than-two-channels
-               right = channel;
+               group.right = channel;
                clear = false;
                // Ignore other channels
                break;
             }
          }
+         group.numChannels = numChannels;
 
          if (!isGenerator)
-         {
-            GetBounds(*left, right, &start, &len);
-            mSampleCnt = len;
-         }
-         else
-            mSampleCnt = left->TimeToLongSamples(mDuration);
-
-         // Let the client know the sample rate
-         SetSampleRate(left->GetRate());
-
-         // Get the block size the client wants to use
-         auto max = left->GetMaxBlockSize() * 2;
-         mBlockSize = SetBlockSize(max);
+            GetBounds(*left, group.right, &group.start, &group.len);
 
-         // Calculate the buffer size to be at least the max rounded up to the clients
-         // selected block size.
-         const auto prevBufferSize = mBufferSize;
-         mBufferSize = ((max + (mBlockSize - 1)) / mBlockSize) * mBlockSize;
-
-         // If the buffer size has changed, then (re)allocate the buffers
-         if (prevBufferSize != mBufferSize)
-         {
-            // Always create the number of input buffers the client expects even if we don't have
-            // the same number of channels.
-            inBufPos.reinit( mNumAudioIn );
-            inBuffer.reinit( mNumAudioIn, mBufferSize );
-
-            // We won't be using more than the first 2 buffers, so clear the rest (if any)
-            for (size_t i = 2; i < mNumAudioIn; i++)
-            {
-               for (size_t j = 0; j < mBufferSize; j++)
-               {
-                  inBuffer[i][j] = 0.0;
-               }
-            }
-
-            // Always create the number of output buffers the client expects even if we don't have
-            // the same number of channels.
-            outBufPos.reinit( mNumAudioOut );
-            // Output buffers get an extra mBlockSize worth to give extra room if
-            // the plugin adds latency
-            outBuffer.reinit( mNumAudioOut, mBufferSize + mBlockSize );
-         }
-
-         // (Re)Set the input buffer positions
-         for (size_t i = 0; i < mNumAudioIn; i++)
-         {
-            inBufPos[i] = inBuffer[i].get();
-         }
-
-         // (Re)Set the output buffer positions
-         for (size_t i = 0; i < mNumAudioOut; i++)
-         {
-            outBufPos[i] = outBuffer[i].get();
-         }
-
-         // Clear unused input buffers
-         if (!right && !clear && mNumAudioIn > 1)
-         {
-            for (size_t j = 0; j < mBufferSize; j++)
-            {
-               inBuffer[1][j] = 0.0;
-            }
-            clear = true;
-         }
-
-         // Go process the track(s)
-         bGoodResult = ProcessTrack(
-            count, map, left, right, start, len,
-            inBuffer, outBuffer, inBufPos, outBufPos);
-         if (!bGoodResult)
-            return;
-
-         count++;
+         if (prototype)
+            groups.push_back(group);
+         else
+            bGoodResult = processGroup(group);
       },
       [&](Track *t) {
          if (t->IsSyncLockSelected())
@@ -1534,6 +1953,12 @@ bool Effect::ProcessPass()
       }
    );
 
+   if (bGoodResult && prototype)
+      bGoodResult = ProcessGroupsInParallel(groups, std::move(prototype),
+         [this]{ return CloneForParallelProcessing(); },
+         [this](double rate){ return GetWarmUpLength(rate); },
+         [this](double frac){ return TotalProgress(frac); });
+
    if (bGoodResult && GetType() == EffectTypeGenerate)
    {
       mT1 = mT0 + mDuration;
@@ -2287,6 +2712,26 @@ double Effect::CalcPreviewInputLength(double previewLength)
    return previewLength;
 }
 
+bool Effect::CanReusePreview()
+{
+   return false;
+}
+
+PreviewRenderer::~PreviewRenderer() = default;
+
+std::unique_ptr<PreviewRenderer> Effect::MakePreviewRenderer(
+   std::shared_ptr<const PreviewRenderer::Buffers>, double)
+{
+   return nullptr;
+}
+
+wxString Effect::GetPreviewSettings()
+{
+   wxString parms;
+   GetAutomationParameters(parms);
+   return parms;
+}
+
 bool Effect::IsHidden()
 {
    return false;
@@ -2350,6 +2795,7 @@ void Effect::Preview(bool dryOnly)
 
    auto vr0 = valueRestorer( mT0 );
    auto vr1 = valueRestorer( mT1 );
+   const auto selectionEnd = mT1;
    // Most effects should stop at t1.
    if (!mPreviewFullSelection)
       mT1 = t1;
@@ -2378,9 +2824,66 @@ void Effect::Preview(bool dryOnly)
    auto uTracks = TrackList::Create( pProject );
    mTracks = uTracks.get();
 
+   // Describe the input, to find an earlier rendering of the same, or to
+   // remember this one
+   std::unique_ptr<PreviewRendering> pRendering;
+   std::unique_ptr<PreviewRendering> pPrevious;
+   if (!dryOnly && CanReusePreview()) {
+      pRendering = std::make_unique<PreviewRendering>();
+      if (!GetAutomationParameters(pRendering->parameters))
+         pRendering.reset();
+   }
+   if (pRendering) {
+      for (auto src : saveTracks->Any< const WaveTrack >())
+         pRendering->inputs.push_back({
+            { *src, src->TimeToLongSamples(mT0), src->TimeToLongSamples(t1) },
+            src->GetRate(), src->GetGain(), src->GetPan(),
+            src->GetSelected()
+         });
+      pRendering->t0 = mT0;
+      pRendering->t1 = t1;
+      pRendering->selectionEnd = mT1;
+
+      auto iter = std::find_if(
+         mPreviewRenderings.begin(), mPreviewRenderings.end(),
+         [&](const std::unique_ptr<PreviewRendering> &pOther){
+            return pOther->SameInput(*pRendering);
+         });
+      if (iter != mPreviewRenderings.end()) {
+         pPrevious = std::move(*iter);
+         mPreviewRenderings.erase(iter);
+         pRendering.reset();
+      }
+   }
+
+   // Keep a rendering, as the most recent
+   auto keep = [&](std::unique_ptr<PreviewRendering> &pKept) {
+      if (pKept && pKept->tracks) {
+         mPreviewRenderings.insert(
+            mPreviewRenderings.begin(), std::move(pKept));
+         if (mPreviewRenderings.size() > MaxPreviewRenderings)
+            mPreviewRenderings.pop_back();
+      }
+   };
+
+   // Render in the background if the effect can, playing while it renders
+   if (!dryOnly && !pPrevious && !isGenerator &&
+      !mPreviewFullSelection && !mPreviewWithNotSelected &&
+      PreviewInBackground(*saveTracks, previewLen, selectionEnd,
+         pRendering.get(), FocusDialog)) {
+      keep(pRendering);
+      return;
+   }
+
+   if (pPrevious) {
+      // Nothing to process; play what was rendered before
+      mTracks = pPrevious->tracks.get();
+      mT0 = 0.0;
+      mT1 = pPrevious->playEnd;
+   }
    // Linear Effect preview optimised by pre-mixing to one track.
    // Generators need to generate per track.
-   if (mIsLinearEffect && !isGenerator) {
+   else if (mIsLinearEffect && !isGenerator) {
       WaveTrack::Holder mixLeft, mixRight;
       MixAndRender(saveTracks, mFactory, rate, floatSample, mT0, t1, mixLeft, mixRight);
       if (!mixLeft)
@@ -2414,14 +2917,16 @@ void Effect::Preview(bool dryOnly)
    // NEW tracks start at time zero.
    // Adjust mT0 and mT1 to be the times to process, and to
    // play back in these tracks
-   mT1 -= mT0;
-   mT0 = 0.0;
+   if (!pPrevious) {
+      mT1 -= mT0;
+      mT0 = 0.0;
+   }
 
    // Update track/group counts
    CountWaveTracks();
 
    // Apply effect
-   if (!dryOnly) {
+   if (!dryOnly && !pPrevious) {
       ProgressDialog progress{
          GetName(),
          XO("Preparing preview"),
@@ -2432,50 +2937,526 @@ void Effect::Preview(bool dryOnly)
       auto vr2 = valueRestorer( mIsPreview, true );
 
       success = Process();
+
+      if (success && pRendering) {
+         pRendering->tracks = uTracks;
+         pRendering->playEnd = mT1;
+      }
    }
 
+   keep(pPrevious ? pPrevious : pRendering);
+
    if (success)
    {
-      auto tracks = ProjectAudioManager::GetAllPlaybackTracks(*mTracks, true);
-
       // Some effects (Paulstretch) may need to generate more
       // than previewLen, so take the min.
       t1 = std::min(mT0 + previewLen, mT1);
 
-      // Start audio playing
-      auto options = DefaultPlayOptions(*pProject);
-      int token =
-         gAudioIO->StartStream(tracks, mT0, t1, options);
+      PlayPreview(*mTracks, mT0, t1, FocusDialog);
+   }
+}
 
-      if (token) {
-         auto previewing = ProgressResult::Success;
-         // The progress dialog must be deleted before stopping the stream
-         // to allow events to flow to the app during StopStream processing.
-         // The progress dialog blocks these events.
-         {
-            ProgressDialog progress
-            (GetName(), XO("Previewing"), pdlgHideCancelButton);
+namespace {
 
-            while (gAudioIO->IsStreamActive(token) && previewing == ProgressResult::Success) {
-               ::wxMilliSleep(100);
-               previewing = progress.Update(gAudioIO->GetStreamTime() - mT0, t1 - mT0);
+//! Runs the renderers of one preview in a thread of its own, and keeps
+//! their output until the main thread takes it
+class PreviewWorker
+{
+public:
+   struct Job
+   {
+      std::unique_ptr<PreviewRenderer> renderer;
+      size_t nChannels;
+      //! Samples per channel after which the output is complete
+      size_t limit;
+      size_t produced{ 0 };
+      bool complete{ false };
+   };
+
+   //! Output of one job not yet taken
+   struct Result
+   {
+      PreviewRenderer::Buffers samples;
+      bool complete{ false };
+   };
+   using Results = std::vector<Result>;
+
+   explicit PreviewWorker(std::vector<Job> jobs)
+      : mJobs{ std::move(jobs) }
+      , mResults( mJobs.size() )
+      , mThread{ [this]{ Run(); } }
+   {
+   }
+
+   ~PreviewWorker()
+   {
+      Cancel();
+      mThread.join();
+   }
+
+   //! Stop after the piece being rendered
+   void Cancel()
+   {
+      mCancelled.store(true, std::memory_order_relaxed);
+   }
+
+   bool Finished() const
+   {
+      return mFinished.load(std::memory_order_acquire);
+   }
+
+   //! Append the output rendered since the last call to results
+   /*! @return false if rendering failed */
+   bool Take(Results &results)
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      results.resize(mResults.size());
+      for (size_t ii = 0; ii < mResults.size(); ++ii) {
+         auto &from = mResults[ii];
+         auto &to = results[ii];
+         to.samples.resize(from.samples.size());
+         for (size_t iChannel = 0; iChannel < from.samples.size(); ++iChannel) {
+            auto &samples = from.samples[iChannel];
+            auto &dest = to.samples[iChannel];
+            dest.insert(dest.end(), samples.begin(), samples.end());
+            samples.clear();
+         }
+         to.complete = from.complete;
+      }
+      return !mFailed;
+   }
+
+private:
+   void Run()
+   {
+      PreviewRenderer::Buffers buffers;
+      auto cancelled = [this]{
+         return mCancelled.load(std::memory_order_relaxed);
+      };
+      try {
+         // The jobs take turns, so that all tracks of the preview grow
+         // together
+         for (bool more = true; more && !cancelled();) {
+            more = false;
+            for (size_t ii = 0; ii < mJobs.size() && !cancelled(); ++ii) {
+               auto &job = mJobs[ii];
+               if (job.complete)
+                  continue;
+               buffers.assign(job.nChannels, {});
+               if (!job.renderer->Render(buffers)) {
+                  std::lock_guard<std::mutex> lock{ mMutex };
+                  mFailed = true;
+                  break;
+               }
+               auto len = buffers.empty() ? 0 : buffers[0].size();
+               if (len == 0 || job.produced + len >= job.limit) {
+                  len = std::min(len, job.limit - job.produced);
+                  job.complete = true;
+               }
+               job.produced += len;
+
+               std::lock_guard<std::mutex> lock{ mMutex };
+               auto &result = mResults[ii];
+               result.samples.resize(job.nChannels);
+               for (size_t iChannel = 0; iChannel < job.nChannels; ++iChannel) {
+                  auto &samples = buffers[iChannel];
+                  result.samples[iChannel].insert(
+                     result.samples[iChannel].end(),
+                     samples.begin(), samples.begin() + len);
+               }
+               result.complete = job.complete;
+               more = more || !job.complete;
             }
+            if (mFailed)
+               break;
          }
+      }
+      catch (...) {
+         // Rendering again in the foreground reports the error
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mFailed = true;
+      }
+      mFinished.store(true, std::memory_order_release);
+   }
 
-         gAudioIO->StopStream();
+   std::vector<Job> mJobs;
 
-         while (gAudioIO->IsBusy()) {
-            ::wxMilliSleep(100);
+   std::mutex mMutex;
+   Results mResults;
+   bool mFailed{ false };
+
+   std::atomic<bool> mCancelled{ false };
+   std::atomic<bool> mFinished{ false };
+
+   // Last, so that all else is constructed before the thread starts
+   std::thread mThread;
+};
+
+}
+
+bool Effect::PreviewInBackground(TrackList &source, double previewLen,
+   double selectionEnd, PreviewRendering *pRendering, wxWindow *FocusDialog)
+{
+   // The preview starts at mT0, and [mT0, mT1) is its input; everything
+   // below is made and read on the main thread, except by the worker, which
+   // has its own copies of the input samples and the settings
+   const auto pProject = source.GetOwner();
+   const auto t0 = mT0;
+   auto t1 = mT1;
+
+   // One track of input
+   struct Input
+   {
+      //! Its channels, copied for output
+      std::vector<std::shared_ptr<const WaveTrack>> channels;
+      std::shared_ptr<const PreviewRenderer::Buffers> samples;
+   };
+
+   // Read the input from t0 to the given end, mixed to one track if the
+   // effect is linear, as Preview() would give it to Process()
+   auto readInput = [&](double end) {
+      std::vector<Input> inputs;
+      auto read = [&](std::vector<std::shared_ptr<const WaveTrack>> channels,
+         double start, double end) {
+         auto pSamples = std::make_shared<PreviewRenderer::Buffers>();
+         for (auto &pChannel : channels) {
+            const auto s0 = pChannel->TimeToLongSamples(start);
+            const auto len =
+               (pChannel->TimeToLongSamples(end) - s0).as_size_t();
+            pSamples->emplace_back(len);
+            pChannel->GetFloats(pSamples->back().data(), s0, len);
+         }
+         inputs.push_back({ std::move(channels), std::move(pSamples) });
+      };
+
+      if (mIsLinearEffect) {
+         WaveTrack::Holder mixLeft, mixRight;
+         MixAndRender(&source, mFactory, mProjectRate, floatSample,
+            t0, end, mixLeft, mixRight);
+         if (mixLeft) {
+            std::vector<std::shared_ptr<const WaveTrack>> channels{ mixLeft };
+            if (mixRight)
+               channels.push_back(mixRight);
+            read(std::move(channels),
+               mixLeft->GetStartTime(), mixLeft->GetEndTime());
          }
       }
-      else {
-         using namespace BasicUI;
-         ShowErrorDialog(
-            wxWidgetsWindowPlacement{ FocusDialog }, XO("Error"),
-            XO("Error opening sound device.\nTry changing the audio host, playback device and the project sample rate."),
-            wxT("Error_opening_sound_device"),
-            ErrorDialogOptions{ ErrorDialogType::ModalErrorReport } );
+      else
+         for (auto pLeader : source.SelectedLeaders< const WaveTrack >()) {
+            std::vector<std::shared_ptr<const WaveTrack>> channels;
+            double trackEnd = t0;
+            for (auto pChannel : TrackList::Channels(pLeader)) {
+               channels.push_back(pChannel->SharedPointer<const WaveTrack>());
+               trackEnd = std::max(trackEnd, pChannel->GetEndTime());
+            }
+            if (trackEnd > t0)
+               read(std::move(channels), t0, std::min(end, trackEnd));
+         }
+
+      return inputs;
+   };
+
+   // A rendering with the settings of one moment: its worker, and the tracks
+   // that receive what the worker renders
+   struct Rendering
+   {
+      std::unique_ptr<PreviewWorker> worker;
+      std::shared_ptr<TrackList> tracks;
+      //! Output channels for each input
+      std::vector<std::vector<WaveTrack *>> outputs;
+      PreviewWorker::Results results;
+      double end{ 0 };
+      bool complete{ false };
+      //! Whether there is output not yet posted for playback
+      bool changed{ false };
+   };
+
+   // Make the renderers and the output tracks; returns null if the effect
+   // can't render any input in the background
+   auto start = [&](const std::vector<Input> &inputs) {
+      std::unique_ptr<Rendering> result;
+      std::vector<PreviewWorker::Job> jobs;
+      auto pRendering = std::make_unique<Rendering>();
+      pRendering->tracks = TrackList::Create( pProject );
+      for (auto &input : inputs) {
+         const auto rate = input.channels[0]->GetRate();
+         auto renderer = MakePreviewRenderer(input.samples, rate);
+         if (!renderer)
+            return result;
+         jobs.push_back({ std::move(renderer), input.channels.size(),
+            static_cast<size_t>(std::ceil(previewLen * rate)) });
+
+         auto &outputs = pRendering->outputs.emplace_back();
+         for (auto &pChannel : input.channels) {
+            auto pOutput = pChannel->EmptyCopy();
+            pOutput->SetSelected(true);
+            WaveTrackView::Get( *pOutput )
+               .SetDisplay(WaveTrackViewConstants::NoDisplay);
+            outputs.push_back( pRendering->tracks->Add( pOutput ) );
+         }
+         if (outputs.size() > 1 && !outputs[0]->HasLinkedTrack())
+            pRendering->tracks->MakeMultiChannelTrack(
+               *outputs[0], outputs.size(), true);
+      }
+      if (!jobs.empty()) {
+         pRendering->worker = std::make_unique<PreviewWorker>(std::move(jobs));
+         result = std::move(pRendering);
+      }
+      return result;
+   };
+
+   // Append what the worker rendered; returns false if it failed
+   auto update = [&](Rendering &rendering) {
+      if (!rendering.worker)
+         return true;
+      const auto success = rendering.worker->Take(rendering.results);
+      double incompleteEnd = std::numeric_limits<double>::infinity();
+      double completeEnd = 0;
+      for (size_t ii = 0; ii < rendering.results.size(); ++ii) {
+         auto &result = rendering.results[ii];
+         auto &outputs = rendering.outputs[ii];
+         for (size_t iChannel = 0; iChannel < outputs.size(); ++iChannel) {
+            if (iChannel >= result.samples.size())
+               break;
+            auto &samples = result.samples[iChannel];
+            if (!samples.empty()) {
+               outputs[iChannel]->Append(
+                  (samplePtr) samples.data(), floatSample, samples.size());
+               // So that copies of the track have all of it
+               outputs[iChannel]->Flush();
+               samples.clear();
+               rendering.changed = true;
+            }
+         }
+         const auto end = outputs[0]->GetEndTime();
+         if (result.complete)
+            completeEnd = std::max(completeEnd, end);
+         else
+            incompleteEnd = std::min(incompleteEnd, end);
+      }
+      const auto complete = !std::isfinite(incompleteEnd);
+      rendering.changed = rendering.changed || complete != rendering.complete;
+      rendering.complete = complete;
+      rendering.end = complete ? completeEnd : incompleteEnd;
+      return success;
+   };
+
+   auto ready = [&](const Rendering &rendering) {
+      return rendering.complete ||
+         rendering.end >= previewLen * PreviewChunkFraction;
+   };
+
+   // Post copies of the output for playback; all copies live until the
+   // stream stops, so that none is destroyed in the audio threads
+   const auto pFeed = std::make_shared<PreviewFeed>();
+   std::vector<std::shared_ptr<TrackList>> posted;
+   auto post = [&](Rendering &rendering, bool restart) {
+      auto pCopy = TrackList::Create( pProject );
+      for (auto pTrack : *rendering.tracks)
+         pCopy->Add( pTrack->Duplicate() );
+      posted.push_back(pCopy);
+      auto transport =
+         ProjectAudioManager::GetAllPlaybackTracks(*pCopy, true);
+      pFeed->Post({
+         transport.playbackTracks.begin(), transport.playbackTracks.end() },
+         rendering.end, rendering.complete, restart);
+      rendering.changed = false;
+      return transport;
+   };
+
+   auto vr = valueRestorer( mIsPreview, true );
+
+   auto inputs = readInput(t1);
+   auto settings = GetPreviewSettings();
+   auto pCurrent = start(inputs);
+   if (!pCurrent)
+      return false;
+
+   {
+      ProgressDialog progress{
+         GetName(),
+         XO("Preparing preview"),
+         pdlgHideCancelButton
+      }; // Have only "Stop" button.
+      while (!ready(*pCurrent)) {
+         if (progress.Update(pCurrent->end, previewLen * PreviewChunkFraction)
+            != ProgressResult::Success)
+            return true;
+         ::wxMilliSleep(20);
+         if (!update(*pCurrent))
+            return false;
+      }
+   }
+
+   // Start audio playing
+   auto gAudioIO = AudioIO::Get();
+   auto options = DefaultPlayOptions(*pProject);
+   // What is rendered is not warped by any time track
+   options.envelope = nullptr;
+   options.policyFactory = [pFeed]() -> std::unique_ptr<PlaybackPolicy> {
+      return std::make_unique<PreviewPlaybackPolicy>(pFeed);
+   };
+   int token =
+      gAudioIO->StartStream(post(*pCurrent, false), 0, previewLen, options);
+
+   if (!token) {
+      using namespace BasicUI;
+      ShowErrorDialog(
+         wxWidgetsWindowPlacement{ FocusDialog }, XO("Error"),
+         XO("Error opening sound device.\nTry changing the audio host, playback device and the project sample rate."),
+         wxT("Error_opening_sound_device"),
+         ErrorDialogOptions{ ErrorDialogType::ModalErrorReport } );
+      return true;
+   }
+
+   // A rendering with newer settings, until its first chunk is ready
+   std::unique_ptr<Rendering> pNext;
+   // Cancelled workers, until their threads finish
+   std::list<std::unique_ptr<PreviewWorker>> retired;
+   auto retire = [&](Rendering &rendering) {
+      if (rendering.worker) {
+         rendering.worker->Cancel();
+         retired.push_back(std::move(rendering.worker));
       }
+   };
+   bool restarted = false;
+   bool success = true;
+   bool stopped = false;
+
+   // The progress dialog must be deleted before stopping the stream
+   // to allow events to flow to the app during StopStream processing.
+   // The progress dialog blocks these events.
+   {
+      // The effect dialog stays enabled, so that new settings can be heard
+      // while the preview plays.  Its buttons, or closing it, stop the
+      // preview.  Without a dialog, show progress as PlayPreview() does.
+      const auto pDialog =
+         FocusDialog ? wxGetTopLevelParent(FocusDialog) : nullptr;
+      std::optional<wxWindowDisabler> disabler;
+      std::optional<ProgressDialog> progress;
+      auto onButton = [&](wxCommandEvent &) {
+         stopped = true;
+      };
+      auto onClose = [&](wxCloseEvent &event) {
+         stopped = true;
+         if (event.CanVeto())
+            event.Veto();
+      };
+      if (pDialog) {
+         disabler.emplace(pDialog);
+         pDialog->Bind(wxEVT_BUTTON, onButton);
+         pDialog->Bind(wxEVT_CLOSE_WINDOW, onClose);
+      }
+      else
+         progress.emplace(GetName(), XO("Previewing"), pdlgHideCancelButton);
+
+      while (!stopped && gAudioIO->IsStreamActive(token)) {
+         if (progress)
+            stopped = progress->Update(gAudioIO->GetStreamTime(), previewLen)
+               != ProgressResult::Success;
+         else
+            wxEventLoopBase::GetActive()->YieldFor(wxEVT_CATEGORY_UI |
+               wxEVT_CATEGORY_USER_INPUT | wxEVT_CATEGORY_TIMER);
+         ::wxMilliSleep(20);
+
+         // Render again when the settings change, cancelling what renders
+         // with the old ones
+         if (auto newSettings = GetPreviewSettings();
+            newSettings != settings) {
+            settings = newSettings;
+            const auto end = std::min(
+               t0 + std::min(mDuration, CalcPreviewInputLength(previewLen)),
+               selectionEnd);
+            if (end != t1)
+               inputs = readInput(t1 = end);
+            if (auto pNew = start(inputs)) {
+               retire(*pCurrent);
+               if (pNext)
+                  retire(*pNext);
+               pNext = std::move(pNew);
+            }
+         }
+
+         if (!update(*pCurrent) || (pNext && !update(*pNext))) {
+            success = false;
+            break;
+         }
+         if (pNext && ready(*pNext)) {
+            // Play the new rendering from the start
+            post(*pNext, true);
+            pCurrent = std::move(pNext);
+            restarted = true;
+         }
+         else if (pCurrent->changed)
+            post(*pCurrent, false);
+
+         retired.remove_if([](const std::unique_ptr<PreviewWorker> &pWorker){
+            return pWorker->Finished();
+         });
+      }
+
+      if (pDialog) {
+         pDialog->Unbind(wxEVT_BUTTON, onButton);
+         pDialog->Unbind(wxEVT_CLOSE_WINDOW, onClose);
+      }
+   }
+
+   gAudioIO->StopStream();
+
+   while (gAudioIO->IsBusy()) {
+      ::wxMilliSleep(100);
+   }
+
+   // Keep a complete rendering with the settings of the first
+   if (success && !restarted && pRendering &&
+      update(*pCurrent) && pCurrent->complete) {
+      pRendering->tracks = pCurrent->tracks;
+      pRendering->playEnd = pCurrent->end;
+   }
+
+   return success;
+}
+
+void Effect::PlayPreview(TrackList &tracks, double t0, double t1,
+   wxWindow *FocusDialog)
+{
+   auto gAudioIO = AudioIO::Get();
+   auto playbackTracks =
+      ProjectAudioManager::GetAllPlaybackTracks(tracks, true);
+
+   // Start audio playing
+   auto options = DefaultPlayOptions(*tracks.GetOwner());
+   int token =
+      gAudioIO->StartStream(playbackTracks, t0, t1, options);
+
+   if (!token) {
+      using namespace BasicUI;
+      ShowErrorDialog(
+         wxWidgetsWindowPlacement{ FocusDialog }, XO("Error"),
+         XO("Error opening sound device.\nTry changing the audio host, playback device and the project sample rate."),
+         wxT("Error_opening_sound_device"),
+         ErrorDialogOptions{ ErrorDialogType::ModalErrorReport } );
+      return;
+   }
+
+   auto previewing = ProgressResult::Success;
+   // The progress dialog must be deleted before stopping the stream
+   // to allow events to flow to the app during StopStream processing.
+   // The progress dialog blocks these events.
+   {
+      ProgressDialog progress
+      (GetName(), XO("Previewing"), pdlgHideCancelButton);
+
+      while (gAudioIO->IsStreamActive(token) && previewing == ProgressResult::Success) {
+         ::wxMilliSleep(100);
+         previewing = progress.Update(gAudioIO->GetStreamTime() - t0, t1 - t0);
+      }
+   }
+
+   gAudioIO->StopStream();
+
+   while (gAudioIO->IsBusy()) {
+      ::wxMilliSleep(100);
    }
 }
 
@@ -15,7 +15,9 @@
 
 
 #include <functional>
+#include <optional>
 #include <set>
+#include <vector>
 
 #include <wx/defs.h>
 
@@ -61,6 +63,27 @@ class WaveTrack;
 
 #define NYQUIST_WORKER_ID wxT("Nyquist Worker")
 
+//! Renders the preview of an effect in successive pieces, on a worker thread
+/*!
+ Made by Effect::MakePreviewRenderer() with a copy of the input and of the
+ settings.  Render() must not touch tracks, the project, or the user
+ interface.
+ */
+class AUDACITY_DLL_API PreviewRenderer /* not final */
+{
+public:
+   //! One vector of samples for each channel
+   using Buffers = std::vector<std::vector<float>>;
+
+   virtual ~PreviewRenderer();
+
+   //! Append the next piece of output to each channel of outputs
+   /*!
+    @return false on failure; appending nothing means the output is complete
+    */
+   virtual bool Render(Buffers &outputs) = 0;
+};
+
 // TODO:  Apr-06-2015
 // TODO:  Much more cleanup of old methods and variables is needed, but
 // TODO:  can't be done until after all effects are using the NEW API.
@@ -305,6 +328,21 @@ protected:
    virtual bool InitPass2();
    virtual int GetPass();
 
+   // Override to return another instance with the same settings, if
+   // ProcessInitialize() resets all the state that ProcessBlock() uses, so
+   // that the result for one track does not depend on the others.  Then
+   // ProcessPass() may process several tracks at once, each with its own
+   // copy of the effect, on other threads.  The default returns null.
+   virtual std::unique_ptr<Effect> CloneForParallelProcessing();
+
+   // Override also, if the effect reports no latency and the output at each
+   // sample depends only on the input within a bounded distance before it,
+   // and not on the position in the track.  Then long tracks may be cut into
+   // segments to process concurrently, each preceded by this many samples of
+   // input, whose output is discarded.  The default returns nullopt, meaning
+   // tracks are not cut.
+   virtual std::optional<size_t> GetWarmUpLength(double sampleRate);
+
    // clean up any temporary memory, needed only per invocation of the
    // effect, after either successful or failed or exception-aborted processing.
    // Invoked inside a "finally" block so it must be no-throw.
@@ -318,6 +356,25 @@ protected:
    // Only override it if you need to do preprocessing or cleanup.
    virtual void Preview(bool dryOnly);
 
+   // Override to return true, if playing again a rendering that Preview()
+   // made earlier, of the same input with the same automation parameters,
+   // is as good as rendering afresh.  Then Preview() keeps a few renderings
+   // while the dialog is open.  The default returns false.
+   virtual bool CanReusePreview();
+
+   // Override to render previews in the background, while Preview() plays
+   // what is rendered so far.  input holds the samples of one track (one
+   // vector per channel) from the start of the preview; rate is theirs.
+   // Called on the main thread.  Return null to render in the foreground with
+   // Process(), as the default does, for instance to show an error message.
+   virtual std::unique_ptr<PreviewRenderer> MakePreviewRenderer(
+      std::shared_ptr<const PreviewRenderer::Buffers> input, double rate);
+
+   // Preview() polls this while it plays a preview rendered in the
+   // background, and renders again when the result changes.  The default
+   // returns the automation parameters.
+   virtual wxString GetPreviewSettings();
+
    virtual void PopulateOrExchange(ShuttleGui & S);
    virtual bool TransferDataToWindow() /* not override */;
    virtual bool TransferDataFromWindow() /* not override */;
@@ -327,6 +384,17 @@ protected:
 
    // No more virtuals!
 
+   // Helper for overrides of CloneForParallelProcessing()
+   template< typename Subclass >
+   std::unique_ptr<Effect> CloneWithSettings()
+   {
+      auto result = std::make_unique< Subclass >();
+      if (!CopySettingsTo(*result))
+         return nullptr;
+      return result;
+   }
+   bool CopySettingsTo(Effect &other);
+
    // The Progress methods all return true if the user has cancelled;
    // you should exit immediately if this happens (cleaning up memory
    // is okay, but don't try to undo).
@@ -516,6 +584,18 @@ private:
 
    bool mIsPreview;
 
+   struct PreviewRendering;
+   //! Kept by Preview() for reuse while the dialog is open, most recent first
+   std::vector<std::unique_ptr<PreviewRendering>> mPreviewRenderings;
+
+   //! Returns false if there is no renderer or it failed, so that Process()
+   //! must be used
+   bool PreviewInBackground(TrackList &source, double previewLen,
+      double selectionEnd, PreviewRendering *pRendering,
+      wxWindow *FocusDialog);
+   void PlayPreview(TrackList &tracks, double t0, double t1,
+      wxWindow *FocusDialog);
+
    bool mUIDebug;
 
    std::vector<Track*> mIMap;
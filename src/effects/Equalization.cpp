@@ -95,6 +95,7 @@
 #include "../Envelope.h"
 #include "../EnvelopeEditor.h"
 #include "FFT.h"
+#include "../ParallelFor.h"
 #include "Prefs.h"
 #include "Project.h"
 #include "Theme.h"
@@ -106,6 +107,7 @@
 #include "../widgets/AudacityTextEntryDialog.h"
 #include "XMLFileReader.h"
 #include "AllThemeResources.h"
+#include "SpectrumKernels.h"
 #include "float_cast.h"
 
 #if wxUSE_ACCESSIBILITY
@@ -114,11 +116,6 @@
 
 #include "../widgets/FileDialog/FileDialog.h"
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-#include "Equalization48x.h"
-#endif
-
-
 enum
 {
    ID_Length = 10000,
@@ -135,14 +132,6 @@ enum
    ID_Curve,
    ID_Manage,
    ID_Delete,
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   ID_DefaultMath,
-   ID_SSE,
-   ID_SSEThreaded,
-   ID_AVX,
-   ID_AVXThreaded,
-   ID_Bench,
-#endif
    ID_Slider,   // needs to come last
 };
 
@@ -231,19 +220,10 @@ BEGIN_EVENT_TABLE(EffectEqualization, wxEvtHandler)
    EVT_CHECKBOX(ID_Linear, EffectEqualization::OnLinFreq)
    EVT_CHECKBOX(ID_Grid, EffectEqualization::OnGridOnOff)
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   EVT_RADIOBUTTON(ID_DefaultMath, EffectEqualization::OnProcessingRadio)
-   EVT_RADIOBUTTON(ID_SSE, EffectEqualization::OnProcessingRadio)
-   EVT_RADIOBUTTON(ID_SSEThreaded, EffectEqualization::OnProcessingRadio)
-   EVT_RADIOBUTTON(ID_AVX, EffectEqualization::OnProcessingRadio)
-   EVT_RADIOBUTTON(ID_AVXThreaded, EffectEqualization::OnProcessingRadio)
-   EVT_BUTTON(ID_Bench, EffectEqualization::OnBench)
-#endif
 END_EVENT_TABLE()
 
 EffectEqualization::EffectEqualization(int Options)
-   : mFFTBuffer{ windowSize }
-   , mFilterFuncR{ windowSize }
+   : mFilterFuncR{ windowSize }
    , mFilterFuncI{ windowSize }
 {
    mOptions = Options;
@@ -300,16 +280,6 @@ EffectEqualization::EffectEqualization(int Options)
    mWhenSliders[NUMBER_OF_BANDS] = 1.;
    mEQVals[NUMBER_OF_BANDS] = 0.;
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   bool useSSE;
-   GetPrivateConfig(GetCurrentSettingsGroup(), wxT("/SSE/GUI"), useSSE, false);
-   if(useSSE && !mEffectEqualization48x)
-      mEffectEqualization48x = std::make_unique<EffectEqualization48x>();
-   else if(!useSSE)
-      mEffectEqualization48x.reset();
-   mBench=false;
-#endif
-
    // We expect these Hi and Lo frequencies to be overridden by Init().
    // Don't use inputTracks().  See bug 2321.
 #if 0
@@ -707,16 +677,6 @@ bool EffectEqualization::Init()
 
 bool EffectEqualization::Process()
 {
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   if(mEffectEqualization48x) {
-      if(mBench) {
-         mBench=false;
-         return mEffectEqualization48x->Benchmark(this);
-      }
-      else
-         return mEffectEqualization48x->Process(this);
-   }
-#endif
    this->CopyInputTracks(); // Set up mOutputTracks.
    CalcFilter();
    bool bGoodResult = true;
@@ -1083,63 +1043,6 @@ void EffectEqualization::PopulateOrExchange(ShuttleGui & S)
    }
    S.EndMultiColumn();
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   if (mEffectEqualization48x)
-   {
-      // -------------------------------------------------------------------
-      // ROW 6: Processing routine selection
-      // -------------------------------------------------------------------
-
-      // Column 1 is blank
-      S.AddSpace(1, 1);
-
-      S.StartHorizontalLay();
-      {
-         S.AddUnits(XO("&Processing: "));
-
-         // update the control state
-         int mathPath = EffectEqualization48x::GetMathPath();
-         int value =
-            (mathPath & MATH_FUNCTION_SSE)
-            ? (mathPath & MATH_FUNCTION_THREADED)
-               ? 2
-               : 1
-            : false // (mathPath & MATH_FUNCTION_AVX) // not implemented
-               ? (mathPath & MATH_FUNCTION_THREADED)
-                  ? 4
-                  : 3
-               : 0;
-
-         mMathProcessingType[0] = S.Id(ID_DefaultMath)
-            .AddRadioButton(XXO("D&efault"),
-                            0, value);
-         mMathProcessingType[1] = S.Id(ID_SSE)
-            .Disable(!EffectEqualization48x::GetMathCaps()->SSE)
-            .AddRadioButtonToGroup(XXO("&SSE"),
-                                   1, value);
-         mMathProcessingType[2] = S.Id(ID_SSEThreaded)
-            .Disable(!EffectEqualization48x::GetMathCaps()->SSE)
-            .AddRadioButtonToGroup(XXO("SSE &Threaded"),
-                                   2, value);
-         mMathProcessingType[3] = S.Id(ID_AVX)
-            // not implemented
-            .Disable(true /* !EffectEqualization48x::GetMathCaps()->AVX */)
-            .AddRadioButtonToGroup(XXO("A&VX"),
-                                   3, value);
-         mMathProcessingType[4] = S.Id(ID_AVXThreaded)
-            // not implemented
-            .Disable(true /* !EffectEqualization48x::GetMathCaps()->AVX */)
-            .AddRadioButtonToGroup(XXO("AV&X Threaded"),
-                                   4, value);
-         S.Id(ID_Bench).AddButton(XXO("&Bench"));
-      }
-      S.EndHorizontalLay();
-
-      // Column 3 is blank
-      S.AddSpace(1, 1);
-   }
-#endif
-
    mUIParent->SetAutoLayout(false);
    if( mOptions != kEqOptionGraphic)
       mUIParent->Layout();
@@ -1312,10 +1215,15 @@ bool EffectEqualization::ProcessOne(int count, WaveTrack * t,
 
    Floats buffer{ idealBlockLen };
 
-   Floats window1{ windowSize };
-   Floats window2{ windowSize };
-   float *thisWindow = window1.get();
-   float *lastWindow = window2.get();
+   // The lumps of a block are filtered independently, on several threads,
+   // each into its own window.  Window 0 holds the last lump of the
+   // previous block, for the overlap-add.
+   const auto maxLumps = idealBlockLen / L;
+   const auto nThreads = std::min<size_t>(ParallelConcurrency(), maxLumps);
+   Floats windows{ (maxLumps + 1) * windowSize };
+   Floats scratch{ nThreads * windowSize };
+   float *thisWindow = windows.get();
+   float *lastWindow = windows.get();
 
    auto originalLen = len;
 
@@ -1333,15 +1241,31 @@ bool EffectEqualization::ProcessOne(int count, WaveTrack * t,
 
       t->GetFloats(buffer.get(), s, block);
 
-      for(size_t i = 0; i < block; i += L)   //go through block in lumps of length L
+      if (lastWindow != windows.get()) {
+         std::copy(lastWindow, lastWindow + windowSize, windows.get());
+         lastWindow = windows.get();
+      }
+      const auto nLumps = (block + L - 1) / L;
+
+      const auto nRanges = std::min(nThreads, nLumps);
+      ParallelFor(nRanges, [&](size_t range) {
+         const auto pScratch = scratch.get() + range * windowSize;
+         const auto end = nLumps * (range + 1) / nRanges;
+         for (auto lump = nLumps * range / nRanges; lump < end; ++lump) {
+            const auto window = windows.get() + (lump + 1) * windowSize;
+            const auto i = lump * L;
+            const auto n = std::min<size_t>(L, block - i);
+            std::copy(&buffer[i], &buffer[i] + n, window);   //copy the L (or remaining) samples
+            std::fill(window + n, window + windowSize, 0.0f);   //this includes the padding
+            Filter(windowSize, window, pScratch);
+         }
+      }, nRanges);
+
+      for(size_t lump = 0; lump < nLumps; ++lump)   //go through block in lumps of length L
       {
+         const auto i = lump * L;
+         thisWindow = windows.get() + (lump + 1) * windowSize;
          wcopy = std::min <size_t> (L, block - i);
-         for(size_t j = 0; j < wcopy; j++)
-            thisWindow[j] = buffer[i+j];   //copy the L (or remaining) samples
-         for(auto j = wcopy; j < windowSize; j++)
-            thisWindow[j] = 0;   //this includes the padding
-
-         Filter(windowSize, thisWindow);
 
          // Overlap - Add
          for(size_t j = 0; (j < mM - 1) && (j < wcopy); j++)
@@ -1350,7 +1274,7 @@ bool EffectEqualization::ProcessOne(int count, WaveTrack * t,
             buffer[i+j] = thisWindow[j];
 
          std::swap( thisWindow, lastWindow );
-      }  //next i, lump of this block
+      }  //next lump of this block
 
       output->Append((samplePtr)buffer.get(), floatSample, block);
       len -= block;
@@ -1558,29 +1482,19 @@ bool EffectEqualization::CalcFilter()
    return TRUE;
 }
 
-void EffectEqualization::Filter(size_t len, float *buffer)
+void EffectEqualization::Filter(size_t len, float *buffer, float *scratch) const
 {
-   float re,im;
    // Apply FFT
    RealFFTf(buffer, hFFT.get());
    //FFT(len, false, inr, NULL, outr, outi);
 
    // Apply filter
-   // DC component is purely real
-   mFFTBuffer[0] = buffer[0] * mFilterFuncR[0];
-   for(size_t i = 1; i < (len / 2); i++)
-   {
-      re=buffer[hFFT->BitReversed[i]  ];
-      im=buffer[hFFT->BitReversed[i]+1];
-      mFFTBuffer[2*i  ] = re*mFilterFuncR[i] - im*mFilterFuncI[i];
-      mFFTBuffer[2*i+1] = re*mFilterFuncI[i] + im*mFilterFuncR[i];
-   }
-   // Fs/2 component is purely real
-   mFFTBuffer[1] = buffer[1] * mFilterFuncR[len/2];
+   MultiplyFrequencyResponse(*hFFT, buffer, scratch,
+      mFilterFuncR.get(), mFilterFuncI.get());
 
    // Inverse FFT and normalization
-   InverseRealFFTf(mFFTBuffer.get(), hFFT.get());
-   ReorderToTime(hFFT.get(), mFFTBuffer.get(), buffer);
+   InverseRealFFTf(scratch, hFFT.get());
+   ReorderToTime(hFFT.get(), scratch, buffer);
 }
 
 //
@@ -3029,35 +2943,6 @@ void EffectEqualization::OnLinFreq(wxCommandEvent & WXUNUSED(event))
    ForceRecalc();
 }
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-
-void EffectEqualization::OnProcessingRadio(wxCommandEvent & event)
-{
-   int testEvent=event.GetId();
-   switch(testEvent)
-   {
-   case ID_DefaultMath: EffectEqualization48x::SetMathPath(MATH_FUNCTION_ORIGINAL);
-      break;
-   case ID_SSE: EffectEqualization48x::SetMathPath(MATH_FUNCTION_SSE);
-      break;
-   case ID_SSEThreaded: EffectEqualization48x::SetMathPath(MATH_FUNCTION_THREADED | MATH_FUNCTION_SSE);
-      break;
-   case ID_AVX: testEvent = 2;
-      break;
-   case ID_AVXThreaded: testEvent = 2;
-      break;
-   }
-
-};
-
-void EffectEqualization::OnBench( wxCommandEvent & event)
-{
-   mBench=true;
-   // OnOk(event);
-}
-
-#endif
-
 //----------------------------------------------------------------------------
 // EqualizationPanel
 //----------------------------------------------------------------------------
@@ -85,10 +85,6 @@ public:
 
 using EQCurveArray = std::vector<EQCurve>;
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-class EffectEqualization48x;
-#endif
-
 class EffectEqualization : public Effect,
                            public XMLTagHandler
 {
@@ -148,7 +144,9 @@ private:
    bool ProcessOne(int count, WaveTrack * t,
                    sampleCount start, sampleCount len);
    bool CalcFilter();
-   void Filter(size_t len, float *buffer);
+   //! Filter len samples in place, using scratch of the same size
+   /*! May be called on several threads at once */
+   void Filter(size_t len, float *buffer, float *scratch) const;
    
    void Flatten();
    void ForceRecalc();
@@ -198,15 +196,11 @@ private:
    void OnInvert( wxCommandEvent & event );
    void OnGridOnOff( wxCommandEvent & event );
    void OnLinFreq( wxCommandEvent & event );
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   void OnProcessingRadio( wxCommandEvent & event );
-   void OnBench( wxCommandEvent & event );
-#endif
 
 private:
    int mOptions;
    HFFT hFFT;
-   Floats mFFTBuffer, mFilterFuncR, mFilterFuncI;
+   Floats mFilterFuncR, mFilterFuncI;
    size_t mM;
    wxString mCurveName;
    bool mLin;
@@ -235,12 +229,6 @@ private:
    std::unique_ptr<Envelope> mLogEnvelope, mLinEnvelope;
    Envelope *mEnvelope;
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   bool mBench;
-   std::unique_ptr<EffectEqualization48x> mEffectEqualization48x;
-   friend class EffectEqualization48x;
-#endif
-
    wxSizer *szrC;
    wxSizer *szrG;
    wxSizer *szrV;
@@ -270,11 +258,6 @@ private:
    wxSlider *mdBMaxSlider;
    wxSlider *mSliders[NUMBER_OF_BANDS];
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   wxRadioButton *mMathProcessingType[5]; // default, sse, sse threaded, AVX, AVX threaded (note AVX is not implemented yet
-   wxBoxSizer *szrM;
-#endif
-
    DECLARE_EVENT_TABLE()
 
    friend class EqualizationPanel;
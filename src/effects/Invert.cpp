@@ -82,3 +82,15 @@ size_t EffectInvert::ProcessBlock(float **inBlock, float **outBlock, size_t bloc
 
    return blockLen;
 }
+
+// Effect implementation
+
+std::unique_ptr<Effect> EffectInvert::CloneForParallelProcessing()
+{
+   return std::make_unique<EffectInvert>();
+}
+
+std::optional<size_t> EffectInvert::GetWarmUpLength(double)
+{
+   return 0;
+}
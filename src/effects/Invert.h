@@ -38,6 +38,11 @@ public:
    unsigned GetAudioInCount() override;
    unsigned GetAudioOutCount() override;
    size_t ProcessBlock(float **inBlock, float **outBlock, size_t blockLen) override;
+
+   // Effect implementation
+
+   std::unique_ptr<Effect> CloneForParallelProcessing() override;
+   std::optional<size_t> GetWarmUpLength(double sampleRate) override;
 };
 
 #endif
@@ -18,6 +18,8 @@
 #include "Loudness.h"
 
 #include <math.h>
+#include <deque>
+#include <optional>
 
 #include <wx/intl.h>
 #include <wx/simplebook.h>
@@ -32,6 +34,7 @@
 #include "../widgets/valnum.h"
 #include "../widgets/ProgressDialog.h"
 
+#include "ChannelContents.h"
 #include "LoadEffects.h"
 
 enum kNormalizeTargets
@@ -55,6 +58,44 @@ Param( RMSLevel,    double,  wxT("RMSLevel"),            -20.0,      -145.0,  0.
 Param( DualMono,    bool,    wxT("DualMono"),            true,       false,   true,     1  );
 Param( NormalizeTo, int,     wxT("NormalizeTo"),         kLoudness , 0    ,   nAlgos-1, 1  );
 
+namespace {
+
+//! Integrative loudness of recently analysed regions
+/*!
+ Lets applying the effect after previewing it, or normalizing the same audio
+ again at another level, skip the analysis pass.  Used only from the main
+ thread.
+ */
+struct LoudnessCacheEntry
+{
+   double rate;
+   std::vector<ChannelContents> channels;
+   double loudness;
+};
+
+constexpr size_t LoudnessCacheSize = 32;
+std::deque<LoudnessCacheEntry> sLoudnessCache;
+
+std::optional<double> FindCachedLoudness(
+   double rate, const std::vector<ChannelContents> &channels)
+{
+   for (const auto &entry : sLoudnessCache)
+      if (entry.rate == rate && entry.channels == channels)
+         return entry.loudness;
+   return {};
+}
+
+void CacheLoudness(
+   double rate, std::vector<ChannelContents> channels, double loudness)
+{
+   // Entries whose blocks were all deleted just age out
+   if (sLoudnessCache.size() >= LoudnessCacheSize)
+      sLoudnessCache.pop_back();
+   sLoudnessCache.push_front({ rate, std::move(channels), loudness });
+}
+
+}
+
 BEGIN_EVENT_TABLE(EffectLoudness, wxEvtHandler)
    EVT_CHOICE(wxID_ANY, EffectLoudness::OnChoice)
    EVT_CHECKBOX(wxID_ANY, EffectLoudness::OnUpdateUI)
@@ -216,15 +257,38 @@ bool EffectLoudness::Process()
 
       mProcStereo = range.size() > 1;
 
+      double loudness = 0;
       if(mNormalizeTo == kLoudness)
       {
-         mLoudnessProcessor.reset(safenew EBUR128(mCurRate, range.size()));
-         mLoudnessProcessor->Initialize();
-         if(!ProcessOne(range, true))
+         std::vector<ChannelContents> contents;
+         std::optional<double> cached;
+         if(mCurT1 > mCurT0)
          {
-            // Processing failed -> abort
-            bGoodResult = false;
-            break;
+            const auto start = track->TimeToLongSamples(mCurT0);
+            const auto end = track->TimeToLongSamples(mCurT1);
+            for(auto channel : range)
+               contents.emplace_back(*channel, start, end);
+            cached = FindCachedLoudness(mCurRate, contents);
+         }
+
+         if(cached)
+         {
+            // Same audio analysed before; only the processing pass remains
+            loudness = *cached;
+            mSteps = 1;
+         }
+         else
+         {
+            mLoudnessProcessor.reset(safenew EBUR128(mCurRate, range.size()));
+            mLoudnessProcessor->Initialize();
+            if(!ProcessOne(range, true))
+            {
+               // Processing failed -> abort
+               bGoodResult = false;
+               break;
+            }
+            loudness = mLoudnessProcessor->IntegrativeLoudness();
+            CacheLoudness(mCurRate, std::move(contents), loudness);
          }
       }
       else // RMS
@@ -245,7 +309,7 @@ bool EffectLoudness::Process()
       // Calculate normalization values the analysis results
       float extent;
       if(mNormalizeTo == kLoudness)
-         extent = mLoudnessProcessor->IntegrativeLoudness();
+         extent = loudness;
       else // RMS
       {
          extent = mRMS[0];
@@ -525,13 +589,8 @@ void EffectLoudness::LoadBufferBlock(TrackIterRange<WaveTrack> range,
 /// (for loudness).
 bool EffectLoudness::AnalyseBufferBlock()
 {
-   for(size_t i = 0; i < mTrackBufferLen; i++)
-   {
-      mLoudnessProcessor->ProcessSampleFromChannel(mTrackBuffer[0][i], 0);
-      if(mProcStereo)
-         mLoudnessProcessor->ProcessSampleFromChannel(mTrackBuffer[1][i], 1);
-      mLoudnessProcessor->NextSample();
-   }
+   const float *channels[2] = { mTrackBuffer[0].get(), mTrackBuffer[1].get() };
+   mLoudnessProcessor->ProcessSamples(channels, mTrackBufferLen);
 
    if(!UpdateProgress())
       return false;
@@ -261,8 +261,10 @@ public:
    typedef EffectNoiseReduction::Settings Settings;
    typedef  EffectNoiseReduction::Statistics Statistics;
 
+   //! @param effect null when rendering a preview in the background, which
+   //! shows no progress
    Worker(eWindowFunctions inWindowType, eWindowFunctions outWindowType,
-      EffectNoiseReduction &effect, const Settings &settings,
+      EffectNoiseReduction *effect, const Settings &settings,
       Statistics &statistics
 #ifdef EXPERIMENTAL_SPECTRAL_EDITING
       , double f0, double f1
@@ -285,10 +287,18 @@ public:
 
    bool Process(TrackList &tracks, double mT0, double mT1);
 
+   //! Call once before ProcessBuffered()
+   bool StartBuffered();
+   //! Transform samples in memory instead of a track
+   /*! @param buffer null to flush the end
+      @param output receives the transformed samples */
+   bool ProcessBuffered(const float *buffer, size_t len, FloatVector &output);
+
 protected:
    MyWindow &NthWindow(int nn) { return static_cast<MyWindow&>(Nth(nn)); }
    std::unique_ptr<Window> NewWindow(size_t windowSize) override;
    bool DoStart() override;
+   void DoOutput(const float *outBuffer, size_t mStepSize) override;
    static bool Processor(SpectrumTransformer &transformer);
    bool DoFinish() override;
 
@@ -303,8 +313,9 @@ private:
 
    const bool mDoProfile;
 
-   EffectNoiseReduction &mEffect;
+   EffectNoiseReduction *const mpEffect;
    Statistics &mStatistics;
+   FloatVector *mpOutput = nullptr;
 
    FloatVector mFreqSmoothingScratch;
    const size_t mFreqSmoothingBins;
@@ -361,6 +372,7 @@ public:
 
 private:
    void DisableControlsIfIsolating();
+   void UpdatePreviewSettings();
 
 #ifdef ADVANCED_SETTINGS
    void EnableDisableSensitivityControls();
@@ -388,6 +400,7 @@ private:
 
    bool mbHasProfile;
    bool mbAllowTwiddleSettings;
+   bool mbPreviewing{ false };
 
 
    wxRadioButton *mKeepSignal;
@@ -613,37 +626,12 @@ EffectNoiseReduction::Worker::MyWindow::~MyWindow()
 {
 }
 
-bool EffectNoiseReduction::Process()
+namespace {
+//! The window functions for the forward and inverse transforms
+std::pair<eWindowFunctions, eWindowFunctions> WindowFunctions(int windowTypes)
 {
-   // This same code will either reduce noise or profile it
-
-   this->CopyInputTracks(); // Set up mOutputTracks.
-
-   auto track = * (mOutputTracks->Selected< const WaveTrack >()).begin();
-   if (!track)
-      return false;
-
-   // Initialize statistics if gathering them, or check for mismatched (advanced)
-   // settings if reducing noise.
-   if (mSettings->mDoProfile) {
-      size_t spectrumSize = 1 + mSettings->WindowSize() / 2;
-      mStatistics = std::make_unique<Statistics>
-         (spectrumSize, track->GetRate(), mSettings->mWindowTypes);
-   }
-   else if (mStatistics->mWindowSize != mSettings->WindowSize()) {
-      // possible only with advanced settings
-      ::Effect::MessageBox(
-         XO("You must specify the same window size for steps 1 and 2.") );
-      return false;
-   }
-   else if (mStatistics->mWindowTypes != mSettings->mWindowTypes) {
-      // A warning only
-      ::Effect::MessageBox(
-         XO("Warning: window types are not the same as for profiling.") );
-   }
-
    eWindowFunctions inWindowType, outWindowType;
-   switch (mSettings->mWindowTypes) {
+   switch (windowTypes) {
    case WT_RECTANGULAR_HANN:
       inWindowType = eWinFuncRectangular;
       outWindowType = eWinFuncHann;
@@ -671,8 +659,144 @@ bool EffectNoiseReduction::Process()
       inWindowType = outWindowType = eWinFuncHann;
       break;
    }
+   return { inWindowType, outWindowType };
+}
+}
+
+//! Reduces noise in a preview in memory, some blocks at a time
+class EffectNoiseReduction::Renderer final : public PreviewRenderer
+{
+public:
+   Renderer(std::shared_ptr<const Buffers> input,
+      const Settings &settings, const Statistics &statistics
+#ifdef EXPERIMENTAL_SPECTRAL_EDITING
+      , double f0, double f1
+#endif
+   )
+      : mInput{ std::move(input) }
+      , mStatistics{ statistics }
+      , mPositions( mInput->size() )
+      , mFinished( mInput->size() )
+   {
+      // The transformers read preferences, so make them here, in the main
+      // thread
+      const auto [inWindowType, outWindowType] =
+         WindowFunctions(settings.mWindowTypes);
+      for (size_t ii = 0; ii < mInput->size(); ++ii)
+         mWorkers.push_back(std::make_unique<Worker>(
+            inWindowType, outWindowType, nullptr, settings, mStatistics
+#ifdef EXPERIMENTAL_SPECTRAL_EDITING
+            , f0, f1
+#endif
+         ));
+   }
+
+   bool Render(Buffers &outputs) override
+   {
+      for (size_t ii = 0; ii < mWorkers.size(); ++ii) {
+         auto &worker = *mWorkers[ii];
+         const auto &input = (*mInput)[ii];
+         auto &samplePos = mPositions[ii];
+         auto &output = outputs[ii];
+         // Output lags the input by some windows, so keep going until there
+         // is some, because appending nothing means the end
+         const auto oldSize = output.size();
+         while (!mFinished[ii] && output.size() == oldSize) {
+            if (samplePos == 0 && !worker.StartBuffered())
+               return false;
+            if (samplePos < input.size()) {
+               const auto blockSize =
+                  std::min(BlockSize, input.size() - samplePos);
+               if (!worker.ProcessBuffered(
+                  input.data() + samplePos, blockSize, output))
+                  return false;
+               samplePos += blockSize;
+            }
+            else {
+               if (!worker.ProcessBuffered(nullptr, 0, output))
+                  return false;
+               mFinished[ii] = true;
+            }
+         }
+      }
+      return true;
+   }
+
+private:
+   static constexpr size_t BlockSize = 65536;
+
+   const std::shared_ptr<const Buffers> mInput;
+   //! A copy, which the workers only read, so that profiling again in the
+   //! main thread does not disturb them
+   Statistics mStatistics;
+   std::vector<std::unique_ptr<Worker>> mWorkers;
+   std::vector<size_t> mPositions;
+   std::vector<bool> mFinished;
+};
+
+std::unique_ptr<PreviewRenderer> EffectNoiseReduction::MakePreviewRenderer(
+   std::shared_ptr<const PreviewRenderer::Buffers> input, double rate)
+{
+   // Mismatched settings show a warning or error, so leave those to the
+   // foreground
+   if (mSettings->mDoProfile || !mStatistics ||
+      mStatistics->mWindowSize != mSettings->WindowSize() ||
+      mStatistics->mWindowTypes != mSettings->mWindowTypes ||
+      mStatistics->mRate != rate)
+      return nullptr;
+   return std::make_unique<Renderer>(
+      std::move(input), *mSettings, *mStatistics
+#ifdef EXPERIMENTAL_SPECTRAL_EDITING
+      , mF0, mF1
+#endif
+   );
+}
+
+wxString EffectNoiseReduction::GetPreviewSettings()
+{
+   // The dialog updates mSettings while a preview plays
+   const auto &settings = *mSettings;
+   return wxString::Format(wxT("%g %g %g %g %g %g %d %d %d %d %d"),
+      settings.mNewSensitivity, settings.mFreqSmoothingBands,
+      settings.mNoiseGain, settings.mAttackTime, settings.mReleaseTime,
+      settings.mOldSensitivity, settings.mNoiseReductionChoice,
+      settings.mWindowTypes, settings.mWindowSizeChoice,
+      settings.mStepsPerWindowChoice, settings.mMethod);
+}
+
+bool EffectNoiseReduction::Process()
+{
+   // This same code will either reduce noise or profile it
+
+   this->CopyInputTracks(); // Set up mOutputTracks.
+
+   auto track = * (mOutputTracks->Selected< const WaveTrack >()).begin();
+   if (!track)
+      return false;
+
+   // Initialize statistics if gathering them, or check for mismatched (advanced)
+   // settings if reducing noise.
+   if (mSettings->mDoProfile) {
+      size_t spectrumSize = 1 + mSettings->WindowSize() / 2;
+      mStatistics = std::make_unique<Statistics>
+         (spectrumSize, track->GetRate(), mSettings->mWindowTypes);
+   }
+   else if (mStatistics->mWindowSize != mSettings->WindowSize()) {
+      // possible only with advanced settings
+      ::Effect::MessageBox(
+         XO("You must specify the same window size for steps 1 and 2.") );
+      return false;
+   }
+   else if (mStatistics->mWindowTypes != mSettings->mWindowTypes) {
+      // A warning only
+      ::Effect::MessageBox(
+         XO("Warning: window types are not the same as for profiling.") );
+   }
+
+   const auto [inWindowType, outWindowType] =
+      WindowFunctions(mSettings->mWindowTypes);
    Worker worker{ inWindowType, outWindowType,
-      *this, *mSettings, *mStatistics
+      this, *mSettings, *mStatistics
 #ifdef EXPERIMENTAL_SPECTRAL_EDITING
       , mF0, mF1
 #endif
@@ -700,10 +824,10 @@ bool EffectNoiseReduction::Worker::Process(
       mProgressWindowCount = 0;
       if (track->GetRate() != mStatistics.mRate) {
          if (mDoProfile)
-            mEffect.Effect::MessageBox(
+            mpEffect->Effect::MessageBox(
                XO("All noise profile data must have the same sample rate.") );
          else
-            mEffect.Effect::MessageBox(
+            mpEffect->Effect::MessageBox(
                XO(
 "The sample rate of the noise profile must match that of the sound to be processed.") );
          return false;
@@ -737,7 +861,7 @@ bool EffectNoiseReduction::Worker::Process(
 
    if (mDoProfile) {
       if (mStatistics.mTotalWindows == 0) {
-         mEffect.Effect::MessageBox(XO("Selected noise profile is too short."));
+         mpEffect->Effect::MessageBox(XO("Selected noise profile is too short."));
          return false;
       }
    }
@@ -778,7 +902,7 @@ void EffectNoiseReduction::Worker::ApplyFreqSmoothing(FloatVector &gains)
 
 EffectNoiseReduction::Worker::Worker(eWindowFunctions inWindowType,
    eWindowFunctions outWindowType,
-   EffectNoiseReduction &effect,
+   EffectNoiseReduction *effect,
    const Settings &settings, Statistics &statistics
 #ifdef EXPERIMENTAL_SPECTRAL_EDITING
    , double f0, double f1
@@ -790,7 +914,7 @@ EffectNoiseReduction::Worker::Worker(eWindowFunctions inWindowType,
 }
 , mDoProfile{ settings.mDoProfile }
 
-, mEffect{ effect }
+, mpEffect{ effect }
 , mStatistics{ statistics }
 
 , mFreqSmoothingScratch( mSpectrumSize )
@@ -861,6 +985,29 @@ bool EffectNoiseReduction::Worker::DoStart()
    return TrackSpectrumTransformer::DoStart();
 }
 
+void EffectNoiseReduction::Worker::DoOutput(
+   const float *outBuffer, size_t mStepSize)
+{
+   if (mpOutput)
+      mpOutput->insert(mpOutput->end(), outBuffer, outBuffer + mStepSize);
+   else
+      TrackSpectrumTransformer::DoOutput(outBuffer, mStepSize);
+}
+
+bool EffectNoiseReduction::Worker::StartBuffered()
+{
+   return Start(mHistoryLen);
+}
+
+bool EffectNoiseReduction::Worker::ProcessBuffered(
+   const float *buffer, size_t len, FloatVector &output)
+{
+   mpOutput = &output;
+   return buffer
+      ? ProcessSamples(Processor, buffer, len)
+      : Finish(Processor);
+}
+
 bool EffectNoiseReduction::Worker::Processor(SpectrumTransformer &transformer)
 {
    auto &worker = static_cast<Worker &>(transformer);
@@ -884,8 +1031,11 @@ bool EffectNoiseReduction::Worker::Processor(SpectrumTransformer &transformer)
    else
       worker.ReduceNoise();
 
+   if (!worker.mpEffect)
+      return true;
+
    // Update the Progress meter, let user cancel
-   return !worker.mEffect.TrackProgress(worker.mProgressTrackCount,
+   return !worker.mpEffect->TrackProgress(worker.mProgressTrackCount,
       std::min(1.0,
          ((++worker.mProgressWindowCount).as_double() * worker.mStepSize)
             / worker.mLen.as_double()));
@@ -1458,6 +1608,7 @@ void EffectNoiseReduction::Dialog::OnNoiseReductionChoice( wxCommandEvent & WXUN
       mTempSettings.mNoiseReductionChoice = NRC_LEAVE_RESIDUE;
 #endif
    DisableControlsIfIsolating();
+   UpdatePreviewSettings();
 }
 
 #ifdef ADVANCED_SETTINGS
@@ -1477,9 +1628,20 @@ void EffectNoiseReduction::Dialog::OnPreview(wxCommandEvent & WXUNUSED(event))
    *m_pSettings = mTempSettings;
    m_pSettings->mDoProfile = false;
 
+   auto previewing = valueRestorer( mbPreviewing, true );
    m_pEffect->Preview( false );
 }
 
+void EffectNoiseReduction::Dialog::UpdatePreviewSettings()
+{
+   // A preview rendered in the background plays on while the dialog is
+   // used; let it hear the new settings
+   if (mbPreviewing) {
+      *m_pSettings = mTempSettings;
+      m_pSettings->mDoProfile = false;
+   }
+}
+
 void EffectNoiseReduction::Dialog::OnReduceNoise( wxCommandEvent & WXUNUSED(event))
 {
    if (!TransferDataFromWindow())
@@ -1690,6 +1852,7 @@ void EffectNoiseReduction::Dialog::OnText(wxCommandEvent &event)
 
    text->GetValue().ToDouble(&field);
    slider->SetValue(info.SliderSetting(field));
+   UpdatePreviewSettings();
 }
 
 void EffectNoiseReduction::Dialog::OnSlider(wxCommandEvent &event)
@@ -1705,4 +1868,5 @@ void EffectNoiseReduction::Dialog::OnSlider(wxCommandEvent &event)
 
    field = info.Value(slider->GetValue());
    text->SetValue(info.Text(field));
+   UpdatePreviewSettings();
 }
@@ -48,8 +48,15 @@ public:
    class Statistics;
    class Dialog;
 
+protected:
+   std::unique_ptr<PreviewRenderer> MakePreviewRenderer(
+      std::shared_ptr<const PreviewRenderer::Buffers> input,
+      double rate) override;
+   wxString GetPreviewSettings() override;
+
 private:
    class Worker;
+   class Renderer;
    friend class Dialog;
 
    std::unique_ptr<Settings> mSettings;
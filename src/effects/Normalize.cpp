@@ -20,6 +20,8 @@
 #include "LoadEffects.h"
 
 #include <math.h>
+#include <deque>
+#include <optional>
 
 #include <wx/checkbox.h>
 #include <wx/intl.h>
@@ -34,6 +36,8 @@
 #include "../widgets/valnum.h"
 #include "../widgets/ProgressDialog.h"
 
+#include "ChannelContents.h"
+
 // Define keys, defaults, minimums, and maximums for the effect parameters
 //
 //     Name         Type     Key                        Def      Min      Max   Scale
@@ -47,6 +51,42 @@ const ComponentInterfaceSymbol EffectNormalize::Symbol
 
 namespace{ BuiltinEffectsModule::Registration< EffectNormalize > reg; }
 
+namespace {
+
+//! DC offsets of recently analysed channels
+/*!
+ Lets applying the effect after previewing it, or normalizing the same audio
+ again at another level, skip the reading of all samples.  The peak needs
+ no cache, as it comes from the block summaries.  Used only from the main
+ thread.
+ */
+struct OffsetCacheEntry
+{
+   ChannelContents contents;
+   float offset;
+};
+
+constexpr size_t OffsetCacheSize = 32;
+std::deque<OffsetCacheEntry> sOffsetCache;
+
+std::optional<float> FindCachedOffset(const ChannelContents &contents)
+{
+   for (const auto &entry : sOffsetCache)
+      if (entry.contents == contents)
+         return entry.offset;
+   return {};
+}
+
+void CacheOffset(ChannelContents contents, float offset)
+{
+   // Entries whose blocks were all deleted just age out
+   if (sOffsetCache.size() >= OffsetCacheSize)
+      sOffsetCache.pop_back();
+   sOffsetCache.push_front({ std::move(contents), offset });
+}
+
+}
+
 BEGIN_EVENT_TABLE(EffectNormalize, wxEvtHandler)
    EVT_CHECKBOX(wxID_ANY, EffectNormalize::OnUpdateUI)
    EVT_TEXT(wxID_ANY, EffectNormalize::OnUpdateUI)
@@ -414,6 +454,14 @@ bool EffectNormalize::AnalyseTrackData(const WaveTrack * track, const Translatab
    //to make it a double now than it is to do it later
    auto len = (end - start).as_double();
 
+   ChannelContents contents{ *track, start, end };
+   if (const auto cached = FindCachedOffset(contents)) {
+      // Same audio analysed before
+      offset = *cached;
+      progress += 1.0/double(2*GetNumWaveTracks());
+      return true;
+   }
+
    //Initiate a processing buffer.  This buffer will (most likely)
    //be shorter than the length of the track being processed.
    Floats buffer{ track->GetMaxBlockSize() };
@@ -455,6 +503,8 @@ bool EffectNormalize::AnalyseTrackData(const WaveTrack * track, const Translatab
       offset = -mSum / totalSamples.as_double();  // calculate actual offset (amount that needs to be added on)
    else
       offset = 0.0;
+   if (rc)
+      CacheOffset(std::move(contents), offset);
 
    progress += 1.0/double(2*GetNumWaveTracks());
    //Return true because the effect processing succeeded ... unless cancelled
@@ -19,6 +19,9 @@
 #include "LoadEffects.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
 
 #include <math.h>
 #include <float.h>
@@ -33,6 +36,7 @@
 #include "../widgets/AudacityMessageBox.h"
 #include "Prefs.h"
 
+#include "../ParallelFor.h"
 #include "../WaveTrack.h"
 
 // Define keys, defaults, minimums, and maximums for the effect parameters
@@ -41,8 +45,17 @@
 Param( Amount, float,   wxT("Stretch Factor"),   10.0,    1.0,     FLT_MAX, 1   );
 Param( Time,   float,   wxT("Time Resolution"),  0.25f,   0.00099f,  FLT_MAX, 1   );
 
+//! Bounds the memory for windows that are transformed at once
+static constexpr size_t MaxBatchSamples = 1 << 22;
+
 /// \brief Class that helps EffectPaulStretch.  It does the FFTs and inner loop 
 /// of the effect.
+/*!
+ Each window of output comes from one window of the input pool, transformed
+ independently of all others, so that many windows may be transformed at
+ once on different threads.  Filling the pool and overlapping the
+ transformed windows are sequential.
+ */
 class PaulStretch
 {
 public:
@@ -50,13 +63,35 @@ public:
    //in_bufsize is also a half of a FFT buffer (in samples)
    virtual ~PaulStretch();
 
-   void process(float *smps, size_t nsmps);
+   //! Add samples to the pool, then copy the pool into window
+   /*! @param window has room for poolsize samples */
+   void add_samples(const float *smps, size_t nsmps, float *window);
+
+   //! Work space for transform(), one for each thread
+   struct Scratch {
+      explicit Scratch(size_t poolsize);
+      Floats fft_c, fft_s, fft_freq, fft_tmp;
+   };
+
+   //! Replace the pool copied into window with its inverse FFT after
+   //! randomizing the phases
+   /*!
+    The phases are random but depend only on index, so the output is
+    reproducible.  Windows may be transformed concurrently, with different
+    scratch, but the first to be transformed in the program must not be
+    transformed concurrently with any other call to FFT().
+    */
+   void transform(float *window, size_t index, Scratch &scratch) const;
+
+   //! Make out_buf from the next transformed window, overlapping the one
+   //! before
+   void make_output(const float *transformed);
 
    size_t get_nsamples();//how many samples are required to be added in the pool next time
    size_t get_nsamples_for_fill();//how many samples are required to be added for a complete buffer refill (at start of the song or after seek)
 
 private:
-   void process_spectrum(float *WXUNUSED(freq)) {};
+   void process_spectrum(float *WXUNUSED(freq)) const {};
 
    const float samplerate;
    const float rap;
@@ -76,8 +111,60 @@ private:
    const Floats in_pool;//de marimea in_bufsize
 
    double remained_samples;//how many fraction of samples has remained (0..1)
+};
+
+/// \brief Stretches one channel with PaulStretch, a batch of windows at a
+/// time
+/*!
+ The windows of a batch are transformed on several threads.  The input is
+ blended into the start and end of the output.
+ */
+class PaulStretchPass
+{
+public:
+   //! Reads samples of the input, from a position relative to its start
+   using Reader =
+      std::function<void(float *buffer, sampleCount pos, size_t len)>;
+   //! Receives output, and the position reached in the input; returns false
+   //! to cancel
+   using Writer =
+      std::function<bool(const float *buffer, size_t len, sampleCount pos)>;
+
+   /*!
+    @param len of the input, at least twice bufsize
+    @param batchSize windows to transform at once, at least two
+    @param nThreads at most, for the transforms
+    */
+   PaulStretchPass(double amount, size_t bufsize, float rate,
+      sampleCount len, Reader reader, size_t batchSize, unsigned nThreads);
+
+   bool Done() const { return s >= len; }
+
+   //! Read and transform the next batch of windows, and write their output
+   /*! @return false if the writer cancelled */
+   bool NextBatch(const Writer &writer);
 
-   const Floats fft_smps, fft_c, fft_s, fft_freq, fft_tmp;
+private:
+   static double AdjustedAmount(double amount, size_t bufsize,
+      sampleCount len);
+
+   const sampleCount len;
+   const Reader reader;
+   PaulStretch stretch;
+   const size_t bufsize;
+   const size_t fade_len;
+   const size_t batchSize;
+   const unsigned nThreads;
+   Floats buffer0;
+   Floats fade_track_smps;
+   Floats windows;
+   std::vector<PaulStretch::Scratch> scratches;
+   // Position reached in the input after the pool for each window
+   std::vector<sampleCount> windowEnds;
+   size_t nget;
+   sampleCount s{ 0 };
+   size_t windowIndex{ 0 };
+   bool first_time{ true };
 };
 
 //
@@ -170,6 +257,80 @@ double EffectPaulstretch::CalcPreviewInputLength(double previewLength)
 }
 
 
+bool EffectPaulstretch::CanReusePreview()
+{
+   // Renderings differ only in random phases
+   return true;
+}
+
+namespace {
+//! Stretches each channel of a preview in memory, a batch of windows at a
+//! time
+class PaulstretchRenderer final : public PreviewRenderer
+{
+public:
+   PaulstretchRenderer(std::shared_ptr<const Buffers> input, double amount,
+      size_t bufsize, float rate, unsigned nThreads)
+      : mInput{ std::move(input) }
+   {
+      // A batch of as many windows as threads, but at least the two that
+      // the start needs, so that output comes often
+      const auto batchSize = std::max(2u, nThreads);
+      for (auto &channel : *mInput)
+         mPasses.push_back(std::make_unique<PaulStretchPass>(
+            amount, bufsize, rate, channel.size(),
+            [&channel](float *buffer, sampleCount pos, size_t len){
+               // Zeroes after the end of the input
+               const auto start = std::min(pos.as_size_t(), channel.size());
+               const auto n = std::min(len, channel.size() - start);
+               std::copy(channel.begin() + start,
+                  channel.begin() + start + n, buffer);
+               std::fill(buffer + n, buffer + len, 0.0f);
+            },
+            batchSize, nThreads));
+   }
+
+   bool Render(Buffers &outputs) override
+   {
+      for (size_t ii = 0; ii < mPasses.size(); ++ii) {
+         auto &pass = *mPasses[ii];
+         if (!pass.Done())
+            pass.NextBatch([&](const float *buffer, size_t len, sampleCount){
+               outputs[ii].insert(outputs[ii].end(), buffer, buffer + len);
+               return true;
+            });
+      }
+      return true;
+   }
+
+private:
+   const std::shared_ptr<const Buffers> mInput;
+   std::vector<std::unique_ptr<PaulStretchPass>> mPasses;
+};
+}
+
+std::unique_ptr<PreviewRenderer> EffectPaulstretch::MakePreviewRenderer(
+   std::shared_ptr<const PreviewRenderer::Buffers> input, double rate)
+{
+   // Process() shows the messages for sizes that don't work
+   const auto stretch_buf_size = GetBufferSize(rate);
+   const auto minDuration = stretch_buf_size * 2 + 1;
+   if (stretch_buf_size == 0 || minDuration < stretch_buf_size)
+      return nullptr;
+   for (auto &channel : *input)
+      if (channel.size() < minDuration)
+         return nullptr;
+
+   try {
+      // Preferences are read here, in the main thread
+      return std::make_unique<PaulstretchRenderer>(std::move(input), mAmount,
+         stretch_buf_size, rate, ParallelConcurrency());
+   }
+   catch ( const std::bad_alloc& ) {
+      return nullptr;
+   }
+}
+
 bool EffectPaulstretch::Process()
 {
    CopyInputTracks();
@@ -331,74 +492,32 @@ bool EffectPaulstretch::ProcessOne(WaveTrack *track,double t0,double t1,int coun
    }
 
 
-   auto dlen = len.as_double();
-   double adjust_amount = dlen /
-      (dlen - ((double)stretch_buf_size * 2.0));
-   amount = 1.0 + (amount - 1.0) * adjust_amount;
-
    auto outputTrack = track->EmptyCopy();
 
    try {
       // This encloses all the allocations of buffers, including those in
       // the constructor of the PaulStretch object
 
-      PaulStretch stretch(amount, stretch_buf_size, track->GetRate());
-
-      auto nget = stretch.get_nsamples_for_fill();
+      // The first pool is transformed twice, the first time only to be
+      // overlapped with the second, so a batch has room for at least two.
+      // The pool of a window has twice the buffer size.
+      const size_t batchSize =
+         std::max<size_t>(2, MaxBatchSamples / (2 * stretch_buf_size));
+      PaulStretchPass pass{ amount, stretch_buf_size, float(track->GetRate()),
+         len,
+         [&](float *buffer, sampleCount pos, size_t n){
+            track->GetFloats(buffer, start + pos, n);
+         },
+         batchSize, ParallelConcurrency() };
 
-      auto bufsize = stretch.poolsize;
-      Floats buffer0{ bufsize };
-      float *bufferptr0 = buffer0.get();
-      bool first_time = true;
-
-      const auto fade_len = std::min<size_t>(100, bufsize / 2 - 1);
       bool cancelled = false;
-
-      {
-         Floats fade_track_smps{ fade_len };
-         decltype(len) s=0;
-
-         while (s < len) {
-            track->GetFloats(bufferptr0, start + s, nget);
-            stretch.process(buffer0.get(), nget);
-
-            if (first_time) {
-               stretch.process(buffer0.get(), 0);
-            };
-
-            s += nget;
-
-            if (first_time){//blend the start of the selection
-               track->GetFloats(fade_track_smps.get(), start, fade_len);
-               first_time = false;
-               for (size_t i = 0; i < fade_len; i++){
-                  float fi = (float)i / (float)fade_len;
-                  stretch.out_buf[i] =
-                     stretch.out_buf[i] * fi + (1.0 - fi) * fade_track_smps[i];
-               }
-            }
-            if (s >= len){//blend the end of the selection
-               track->GetFloats(fade_track_smps.get(), end - fade_len, fade_len);
-               for (size_t i = 0; i < fade_len; i++){
-                  float fi = (float)i / (float)fade_len;
-                  auto i2 = bufsize / 2 - 1 - i;
-                  stretch.out_buf[i2] =
-                     stretch.out_buf[i2] * fi + (1.0 - fi) *
-                     fade_track_smps[fade_len - 1 - i];
-               }
-            }
-
-            outputTrack->Append((samplePtr)stretch.out_buf.get(), floatSample, stretch.out_bufsize);
-
-            nget = stretch.get_nsamples();
-            if (TrackProgress(count,
-               s.as_double() / len.as_double()
-            )) {
-               cancelled = true;
-               break;
-            }
-         }
-      }
+      while (!pass.Done() && !cancelled)
+         cancelled = !pass.NextBatch(
+            [&](const float *buffer, size_t n, sampleCount pos){
+               outputTrack->Append((samplePtr)buffer, floatSample, n);
+               return !TrackProgress(count,
+                  pos.as_double() / len.as_double());
+            });
 
       if (!cancelled){
          outputTrack->Flush();
@@ -429,11 +548,6 @@ PaulStretch::PaulStretch(float rap_, size_t in_bufsize_, float samplerate_ )
    , poolsize { in_bufsize_ * 2 }
    , in_pool { poolsize, true }
    , remained_samples { 0.0 }
-   , fft_smps { poolsize, true }
-   , fft_c { poolsize, true }
-   , fft_s { poolsize, true }
-   , fft_freq { poolsize, true }
-   , fft_tmp { poolsize }
 {
 }
 
@@ -441,7 +555,15 @@ PaulStretch::~PaulStretch()
 {
 }
 
-void PaulStretch::process(float *smps, size_t nsmps)
+PaulStretch::Scratch::Scratch(size_t poolsize)
+   : fft_c { poolsize, true }
+   , fft_s { poolsize, true }
+   , fft_freq { poolsize, true }
+   , fft_tmp { poolsize }
+{
+}
+
+void PaulStretch::add_samples(const float *smps, size_t nsmps, float *window)
 {
    //add NEW samples to the pool
    if ((smps != NULL) && (nsmps != 0)) {
@@ -460,21 +582,51 @@ void PaulStretch::process(float *smps, size_t nsmps)
    }
 
    //get the samples from the pool
-   for (size_t i = 0; i < poolsize; i++)
-      fft_smps[i] = in_pool[i];
-   WindowFunc(eWinFuncHann, poolsize, fft_smps.get());
+   std::copy(in_pool.get(), in_pool.get() + poolsize, window);
+}
+
+namespace {
+//! Random numbers of 15 bits, like those of rand(), but the same for each
+//! window every time
+class PhaseRandom
+{
+public:
+   explicit PhaseRandom(size_t index)
+      : state{ static_cast<uint32_t>(index) * 2654435761u + 12345u }
+   {}
+   unsigned operator ()()
+   {
+      state = state * 1103515245u + 12345u;
+      return (state >> 16) & 0x7fff;
+   }
+private:
+   uint32_t state;
+};
+}
+
+void PaulStretch::transform(
+   float *window, size_t index, Scratch &scratch) const
+{
+   const auto fft_smps = window;
+   const auto fft_c = scratch.fft_c.get();
+   const auto fft_s = scratch.fft_s.get();
+   const auto fft_freq = scratch.fft_freq.get();
+   const auto fft_tmp = scratch.fft_tmp.get();
 
-   RealFFT(poolsize, fft_smps.get(), fft_c.get(), fft_s.get());
+   WindowFunc(eWinFuncHann, poolsize, fft_smps);
+
+   RealFFT(poolsize, fft_smps, fft_c, fft_s);
 
    for (size_t i = 0; i < poolsize / 2; i++)
       fft_freq[i] = sqrt(fft_c[i] * fft_c[i] + fft_s[i] * fft_s[i]);
-   process_spectrum(fft_freq.get());
+   process_spectrum(fft_freq);
 
 
    //put randomize phases to frequencies and do a IFFT
+   PhaseRandom random_phase{ index };
    float inv_2p15_2pi = 1.0 / 16384.0 * (float)M_PI;
    for (size_t i = 1; i < poolsize / 2; i++) {
-      unsigned int random = (rand()) & 0x7fff;
+      unsigned int random = random_phase();
       float phase = random * inv_2p15_2pi;
       float s = fft_freq[i] * sin(phase);
       float c = fft_freq[i] * cos(phase);
@@ -486,14 +638,12 @@ void PaulStretch::process(float *smps, size_t nsmps)
    fft_c[0] = fft_s[0] = 0.0;
    fft_c[poolsize / 2] = fft_s[poolsize / 2] = 0.0;
 
-   FFT(poolsize, true, fft_c.get(), fft_s.get(), fft_smps.get(), fft_tmp.get());
-
-   float max = 0.0, max2 = 0.0;
-   for (size_t i = 0; i < poolsize; i++) {
-      max = std::max(max, fabsf(fft_tmp[i]));
-      max2 = std::max(max2, fabsf(fft_smps[i]));
-   }
+   FFT(poolsize, true, fft_c, fft_s, fft_smps, fft_tmp);
+}
 
+void PaulStretch::make_output(const float *transformed)
+{
+   const auto fft_smps = transformed;
 
    //make the output buffer
    float tmp = 1.0 / (float) out_bufsize * M_PI;
@@ -541,3 +691,106 @@ size_t PaulStretch::get_nsamples_for_fill()
 {
    return poolsize;
 }
+
+PaulStretchPass::PaulStretchPass(double amount, size_t bufsize_, float rate,
+   sampleCount len_, Reader reader_, size_t batchSize_, unsigned nThreads_)
+   : len{ len_ }
+   , reader{ std::move(reader_) }
+   , stretch{ float(AdjustedAmount(amount, bufsize_, len_)), bufsize_, rate }
+   , bufsize{ stretch.poolsize }
+   , fade_len{ std::min<size_t>(100, bufsize / 2 - 1) }
+   , batchSize{ std::max<size_t>(2, batchSize_) }
+   , nThreads{ std::max(1u, nThreads_) }
+   , buffer0{ bufsize }
+   , fade_track_smps{ fade_len }
+   , windows{ batchSize * bufsize }
+   , nget{ stretch.get_nsamples_for_fill() }
+{
+   scratches.reserve(nThreads);
+   for (unsigned ii = 0; ii < nThreads; ++ii)
+      scratches.emplace_back(bufsize);
+   windowEnds.reserve(batchSize);
+}
+
+double PaulStretchPass::AdjustedAmount(double amount, size_t bufsize,
+   sampleCount len)
+{
+   auto dlen = len.as_double();
+   double adjust_amount = dlen /
+      (dlen - ((double)bufsize * 2.0));
+   return 1.0 + (amount - 1.0) * adjust_amount;
+}
+
+bool PaulStretchPass::NextBatch(const Writer &writer)
+{
+   float *bufferptr0 = buffer0.get();
+
+   // Fill the pools of a batch of windows
+   const auto firstIndex = windowIndex;
+   windowEnds.clear();
+   while (windowEnds.size() < batchSize && s < len) {
+      reader(bufferptr0, s, nget);
+      s += nget;
+      stretch.add_samples(bufferptr0, nget,
+         windows.get() + windowEnds.size() * bufsize);
+      windowEnds.push_back(s);
+      if (first_time) {
+         stretch.add_samples(nullptr, 0,
+            windows.get() + windowEnds.size() * bufsize);
+         windowEnds.push_back(s);
+         first_time = false;
+      }
+      nget = stretch.get_nsamples();
+   }
+   const auto nWindows = windowEnds.size();
+   windowIndex += nWindows;
+
+   // The very first transform is done here alone, so that FFT()
+   // makes its tables before any other thread calls it
+   size_t begin = 0;
+   if (firstIndex == 0) {
+      stretch.transform(windows.get(), 0, scratches[0]);
+      begin = 1;
+   }
+   const auto nRanges =
+      std::min<size_t>(nThreads, nWindows - begin);
+   ParallelFor(nRanges, [&](size_t range){
+      const auto first = begin + (nWindows - begin) * range / nRanges;
+      const auto last =
+         begin + (nWindows - begin) * (range + 1) / nRanges;
+      for (auto ii = first; ii < last; ++ii)
+         stretch.transform(windows.get() + ii * bufsize,
+            firstIndex + ii, scratches[range]);
+   }, nThreads);
+
+   // Overlap the transformed windows, and write the output
+   for (size_t ii = 0; ii < nWindows; ++ii) {
+      stretch.make_output(windows.get() + ii * bufsize);
+      if (firstIndex + ii == 0)
+         // Output is only from the repeated first window
+         continue;
+
+      if (firstIndex + ii == 1){//blend the start of the selection
+         reader(fade_track_smps.get(), 0, fade_len);
+         for (size_t i = 0; i < fade_len; i++){
+            float fi = (float)i / (float)fade_len;
+            stretch.out_buf[i] =
+               stretch.out_buf[i] * fi + (1.0 - fi) * fade_track_smps[i];
+         }
+      }
+      if (windowEnds[ii] >= len){//blend the end of the selection
+         reader(fade_track_smps.get(), len - fade_len, fade_len);
+         for (size_t i = 0; i < fade_len; i++){
+            float fi = (float)i / (float)fade_len;
+            auto i2 = bufsize / 2 - 1 - i;
+            stretch.out_buf[i2] =
+               stretch.out_buf[i2] * fi + (1.0 - fi) *
+               fade_track_smps[fade_len - 1 - i];
+         }
+      }
+
+      if (!writer(stretch.out_buf.get(), stretch.out_bufsize, windowEnds[ii]))
+         return false;
+   }
+   return true;
+}
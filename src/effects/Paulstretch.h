@@ -42,6 +42,10 @@ public:
 
    double CalcPreviewInputLength(double previewLength) override;
    bool Process() override;
+   bool CanReusePreview() override;
+   std::unique_ptr<PreviewRenderer> MakePreviewRenderer(
+      std::shared_ptr<const PreviewRenderer::Buffers> input,
+      double rate) override;
    void PopulateOrExchange(ShuttleGui & S) override;
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
@@ -377,6 +377,12 @@ bool EffectPhaser::TransferDataFromWindow()
    return true;
 }
 
+std::unique_ptr<Effect> EffectPhaser::CloneForParallelProcessing()
+{
+   // ProcessInitialize() makes all the state for each track
+   return CloneWithSettings<EffectPhaser>();
+}
+
 // EffectPhaser implementation
 
 void EffectPhaser::InstanceInit(EffectPhaserState & data, float sampleRate)
@@ -81,6 +81,8 @@ public:
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
 
+   std::unique_ptr<Effect> CloneForParallelProcessing() override;
+
 private:
    // EffectPhaser implementation
 
@@ -0,0 +1,179 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file PreviewPlayback.cpp
+
+ **********************************************************************/
+
+#include "PreviewPlayback.h"
+
+#include "SampleCount.h"
+
+#include <cmath>
+
+//! How far playback stays behind the end of an incomplete rendering, in
+//! seconds; more than a resampler reads ahead of what it produces
+static constexpr double RenderMargin = 0.25;
+
+PreviewFeed::PreviewFeed()
+{
+   mMessages.Initialize();
+}
+
+void PreviewFeed::Post(WaveTrackConstArray tracks, double end, bool complete,
+   bool restart)
+{
+   if (restart)
+      ++mGeneration;
+   mMessages.Write(
+      { std::move(tracks), end, complete, mGeneration, ++mSerial });
+}
+
+PreviewPlaybackPolicy::PreviewPlaybackPolicy(
+   std::shared_ptr<PreviewFeed> pFeed)
+   : mpFeed{ std::move(pFeed) }
+{
+}
+
+PreviewPlaybackPolicy::~PreviewPlaybackPolicy() = default;
+
+void PreviewPlaybackPolicy::Initialize(
+   PlaybackSchedule &schedule, double rate )
+{
+   PlaybackPolicy::Initialize(schedule, rate);
+
+   // The first post describes the tracks given to the stream.  Learn how
+   // much is rendered before the buffers are primed.
+   MessageConsumer(schedule);
+   if (mHasPending)
+      UpdateEnd(schedule);
+}
+
+PlaybackPolicy::BufferTimes
+PreviewPlaybackPolicy::SuggestedBufferTimes(PlaybackSchedule &)
+{
+   // Shorter times than in the default policy so that a new rendering is
+   // heard soon
+   return { 0.5, 0.5, 1.0 };
+}
+
+bool PreviewPlaybackPolicy::AllowSeek(PlaybackSchedule &)
+{
+   return false;
+}
+
+bool PreviewPlaybackPolicy::Done( PlaybackSchedule &schedule,
+   unsigned long outputFrames )
+{
+   const auto end = mFinalEnd.load(std::memory_order_relaxed);
+   if (!std::isfinite(end))
+      // Still rendering; if playback caught up, it waits
+      return false;
+   auto diff = schedule.GetTrackTime() - end;
+   return sampleCount(floor(diff * mRate + 0.5)) >= 0 &&
+      // Require also that output frames are all consumed from ring buffer
+      outputFrames == 0;
+}
+
+PlaybackSlice PreviewPlaybackPolicy::GetPlaybackSlice(
+   PlaybackSchedule &schedule, size_t available)
+{
+   // Without a time warp, real time and track time agree
+   const auto time = schedule.mT0 + schedule.mWarpedTime;
+   auto frames = available;
+   auto toProduce = frames;
+
+   if (!mComplete) {
+      // Stay behind the end of the rendering, so that no mixer reaches the
+      // end of its track and flushes its resampler
+      const auto ready = std::max(0.0, mEnd - RenderMargin - time);
+      if (ready * mRate < available)
+         frames = toProduce = ready * mRate;
+      schedule.RealTimeAdvance( frames / mRate );
+   }
+   else {
+      const auto remaining =
+         std::max(0.0, std::min(schedule.mT1, mEnd) - time);
+      double deltat = frames / mRate;
+      if (deltat > remaining) {
+         // Produce some extra silence so that the time queue consumer can
+         // satisfy its end condition
+         const double extraRealTime = (TimeQueueGrainSize + 1) / mRate;
+         auto extra = std::min( extraRealTime, deltat - remaining );
+         auto realTime = remaining + extra;
+         frames = realTime * mRate;
+         toProduce = remaining * mRate;
+         schedule.RealTimeAdvance( realTime );
+      }
+      else
+         schedule.RealTimeAdvance( deltat );
+   }
+
+   return { available, frames, toProduce };
+}
+
+std::pair<double, double> PreviewPlaybackPolicy::AdvancedTrackTime(
+   PlaybackSchedule &schedule, double trackTime, size_t nSamples )
+{
+   trackTime += nSamples / mRate;
+   if (mComplete) {
+      const auto end = std::min(schedule.mT1, mEnd);
+      if (trackTime >= end)
+         return { end, std::numeric_limits<double>::infinity() };
+   }
+   return { trackTime, trackTime };
+}
+
+void PreviewPlaybackPolicy::MessageConsumer( PlaybackSchedule & )
+{
+   // This executes in the TrackBufferExchange thread.  A slot read before
+   // is left empty, with its old serial number, so it is ignored.
+   auto message = mpFeed->mMessages.Read();
+   if (message.serial > mSerial) {
+      mSerial = message.serial;
+      mPending = std::move(message);
+      mHasPending = true;
+   }
+}
+
+bool PreviewPlaybackPolicy::RepositionPlayback(
+   PlaybackSchedule &schedule, const Mixers &playbackMixers, size_t, size_t )
+{
+   if (!mHasPending)
+      return true;
+   mHasPending = false;
+
+   // The main thread keeps all the posted tracks until the stream stops, so
+   // no track is destroyed in this thread
+   const auto &tracks = mPending.tracks;
+   if (tracks.size() == playbackMixers.size())
+      for (size_t ii = 0; ii < tracks.size(); ++ii)
+         playbackMixers[ii]->ReplaceInputTracks({ tracks[ii] });
+
+   if (mPending.generation != mGeneration) {
+      // A new rendering plays from the start
+      mGeneration = mPending.generation;
+      for (auto &pMixer : playbackMixers)
+         pMixer->Reposition( schedule.mT0, true );
+      schedule.RealTimeRestart();
+      // So that the play head will redraw in the right place:
+      schedule.mTimeQueue.SetLastTime( schedule.mT0 );
+   }
+
+   UpdateEnd(schedule);
+   mPending.tracks.clear();
+
+   // Fill what is left of the buffers from the new tracks
+   return false;
+}
+
+void PreviewPlaybackPolicy::UpdateEnd( PlaybackSchedule &schedule )
+{
+   mEnd = mPending.end;
+   mComplete = mPending.complete;
+   mFinalEnd.store( mComplete
+      ? std::min(schedule.mT1, mEnd)
+      : std::numeric_limits<double>::infinity(),
+      std::memory_order_relaxed );
+}
@@ -0,0 +1,110 @@
+/*!********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file PreviewPlayback.h
+ @brief Playback of an effect preview that is still being rendered
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_PREVIEW_PLAYBACK__
+#define __AUDACITY_PREVIEW_PLAYBACK__
+
+#include "../PlaybackSchedule.h" // to inherit
+
+#include <atomic>
+#include <limits>
+#include <memory>
+
+//! Carries the growing rendering of a preview from the main thread to the
+//! thread that fills the playback buffers
+/*!
+ Each post describes all that was rendered so far, in copies of the tracks
+ that the main thread will not change again, one for each playback track and
+ in the same order.  So a post may supersede another that was not yet read.
+ */
+class PreviewFeed
+{
+public:
+   PreviewFeed();
+
+   //! Called by the main thread
+   /*!
+    @param end time up to which the tracks are rendered
+    @param complete whether there will be nothing after end
+    @param restart whether the tracks are a new rendering, to be played from
+       the start of the preview
+    */
+   void Post(WaveTrackConstArray tracks, double end, bool complete,
+      bool restart);
+
+private:
+   friend class PreviewPlaybackPolicy;
+
+   struct Message {
+      WaveTrackConstArray tracks;
+      double end{};
+      bool complete{};
+      unsigned generation{};
+      unsigned serial{};
+   };
+   MessageBuffer<Message> mMessages;
+
+   // Main thread's counts of renderings and of posts
+   unsigned mGeneration{ 0 };
+   unsigned mSerial{ 0 };
+};
+
+//! Plays a preview from the start while it is being rendered
+/*!
+ Playback stays a little behind the end of what is rendered, waiting in
+ silence if the rendering falls behind, and stops at the end of a complete
+ rendering.  A new rendering is played from the start, without stopping the
+ stream.  There is no seeking and no time warp.
+ */
+class PreviewPlaybackPolicy final : public PlaybackPolicy {
+public:
+   explicit PreviewPlaybackPolicy(std::shared_ptr<PreviewFeed> pFeed);
+   ~PreviewPlaybackPolicy() override;
+
+   void Initialize( PlaybackSchedule &schedule, double rate ) override;
+
+   BufferTimes SuggestedBufferTimes(PlaybackSchedule &schedule) override;
+
+   bool AllowSeek( PlaybackSchedule & ) override;
+
+   bool Done( PlaybackSchedule &schedule, unsigned long ) override;
+
+   PlaybackSlice GetPlaybackSlice(
+      PlaybackSchedule &schedule, size_t available) override;
+
+   std::pair<double, double>
+      AdvancedTrackTime( PlaybackSchedule &schedule,
+         double trackTime, size_t nSamples ) override;
+
+   void MessageConsumer( PlaybackSchedule &schedule ) override;
+
+   bool RepositionPlayback(
+      PlaybackSchedule &schedule, const Mixers &playbackMixers,
+      size_t frames, size_t available ) override;
+
+private:
+   //! Adopt the end of the rendering in mPending
+   void UpdateEnd( PlaybackSchedule &schedule );
+
+   const std::shared_ptr<PreviewFeed> mpFeed;
+
+   //! Last post read, not yet given to the mixers
+   PreviewFeed::Message mPending;
+   bool mHasPending{ false };
+
+   unsigned mGeneration{ 0 };
+   unsigned mSerial{ 0 };
+   double mEnd{ 0 };
+   bool mComplete{ false };
+   //! Where playback ends, once the rendering is complete; read by the
+   //! PortAudio callback thread
+   std::atomic<double> mFinalEnd{ std::numeric_limits<double>::infinity() };
+};
+
+#endif
@@ -16,6 +16,7 @@ effect that uses SBSMS to do its processing (TimeScale)
 #if USE_SBSMS
 #include "SBSMSEffect.h"
 
+#include <algorithm>
 #include <math.h>
 
 #include "../LabelTrack.h"
@@ -51,6 +52,9 @@ public:
    ArrayOf<float> rightBuffer;
    WaveTrack *leftTrack;
    WaveTrack *rightTrack;
+   // Read instead of the tracks, if not null
+   const float *leftInput{};
+   const float *rightInput{};
    std::unique_ptr<SBSMS> sbsms;
    std::unique_ptr<SBSMSInterface> iface;
    ArrayOf<audio> SBSMSBuf;
@@ -58,8 +62,6 @@ public:
    // Not required by callbacks, but makes for easier cleanup
    std::unique_ptr<Resampler> resampler;
    std::unique_ptr<SBSMSQuality> quality;
-   std::shared_ptr<WaveTrack> outputLeftTrack;
-   std::shared_ptr<WaveTrack> outputRightTrack;
 
    std::exception_ptr mpException {};
 };
@@ -90,7 +92,7 @@ long resampleCB(void *cb_data, SBSMSFrame *data)
    ResampleBuf *r = (ResampleBuf*) cb_data;
 
    auto blockSize = limitSampleBufferSize(
-      r->leftTrack->GetBestBlockSize(r->offset),
+      r->leftInput ? r->blockSize : r->leftTrack->GetBestBlockSize(r->offset),
       r->end - r->offset
    );
 
@@ -99,10 +101,19 @@ long resampleCB(void *cb_data, SBSMSFrame *data)
    // does not seem to let us report error codes, so use this roundabout to
    // stop the effect early.
    try {
-      r->leftTrack->GetFloats(
-         (r->leftBuffer.get()), r->offset, blockSize);
-      r->rightTrack->GetFloats(
-         (r->rightBuffer.get()), r->offset, blockSize);
+      if (r->leftInput) {
+         const auto offset = r->offset.as_size_t();
+         std::copy(r->leftInput + offset, r->leftInput + offset + blockSize,
+            r->leftBuffer.get());
+         std::copy(r->rightInput + offset, r->rightInput + offset + blockSize,
+            r->rightBuffer.get());
+      }
+      else {
+         r->leftTrack->GetFloats(
+            (r->leftBuffer.get()), r->offset, blockSize);
+         r->rightTrack->GetFloats(
+            (r->rightBuffer.get()), r->offset, blockSize);
+      }
    }
    catch ( ... ) {
       // Save the exception object for re-throw when out of the library
@@ -144,6 +155,196 @@ long postResampleCB(void *cb_data, SBSMSFrame *data)
    return count;
 }
 
+//! SBSMS processing of one track, with resampling to and from the rate of
+//! SBSMS, read a block at a time
+class EffectSBSMS::Stream
+{
+public:
+   //! Reads from the tracks; rightTrack may be null
+   Stream(const EffectSBSMS &effect, WaveTrack *leftTrack,
+      WaveTrack *rightTrack, sampleCount start, sampleCount end);
+   //! Reads from memory, which must outlive this; rightInput may be null
+   Stream(const EffectSBSMS &effect, float srTrack,
+      const float *leftInput, const float *rightInput, size_t len);
+   Stream(const Stream&) = delete;
+   Stream &operator=(const Stream&) = delete;
+
+   bool Done() const { return pos >= samplesOut || outputCount == 0; }
+
+   //! Read at most SBSMSOutBlockSize frames of output; right may be null
+   /*! Rethrows what reading the input threw */
+   long Read(float *left, float *right);
+
+private:
+   explicit Stream(const EffectSBSMS &effect);
+   void Setup(const EffectSBSMS &effect, float srTrack, bool stereo,
+      size_t blockSize, sampleCount start, sampleCount end);
+
+   Slide rateSlide;
+   Slide pitchSlide;
+   ResampleBuf rb;
+   std::unique_ptr<Resampler> resampler;
+
+public:
+   // Samples in output after resampling back
+   sampleCount samplesOut;
+   long pos = 0;
+
+private:
+   long outputCount = -1;
+};
+
+EffectSBSMS::Stream::Stream(const EffectSBSMS &effect)
+   : rateSlide(effect.rateSlideType, effect.rateStart, effect.rateEnd)
+   , pitchSlide(effect.pitchSlideType, effect.pitchStart, effect.pitchEnd)
+{
+}
+
+EffectSBSMS::Stream::Stream(const EffectSBSMS &effect, WaveTrack *leftTrack,
+   WaveTrack *rightTrack, sampleCount start, sampleCount end)
+   : Stream{ effect }
+{
+   rb.leftTrack = leftTrack;
+   rb.rightTrack = rightTrack?rightTrack:leftTrack;
+   Setup(effect, leftTrack->GetRate(), rightTrack != nullptr,
+      leftTrack->GetMaxBlockSize(), start, end);
+}
+
+EffectSBSMS::Stream::Stream(const EffectSBSMS &effect, float srTrack,
+   const float *leftInput, const float *rightInput, size_t len)
+   : Stream{ effect }
+{
+   rb.leftInput = leftInput;
+   rb.rightInput = rightInput?rightInput:leftInput;
+   Setup(effect, srTrack, rightInput != nullptr, 65536, 0, len);
+}
+
+void EffectSBSMS::Stream::Setup(const EffectSBSMS &effect, float srTrack,
+   bool stereo, size_t blockSize, sampleCount start, sampleCount end)
+{
+   // SBSMS has a fixed sample rate - we just convert to its sample rate and then convert back
+   float srProcess = effect.bLinkRatePitch ? srTrack : 44100.0;
+
+   // the resampler needs a callback to supply its samples
+   rb.blockSize = blockSize;
+   rb.buf.reinit(rb.blockSize, true);
+   rb.leftBuffer.reinit(blockSize, true);
+   rb.rightBuffer.reinit(blockSize, true);
+
+   // Samples in selection
+   auto samplesIn = end - start;
+
+   // Samples for SBSMS to process after resampling
+   auto samplesToProcess = (sampleCount) (samplesIn.as_float() * (srProcess/srTrack));
+
+   SlideType outSlideType;
+   SBSMSResampleCB outResampleCB;
+
+   if(effect.bLinkRatePitch) {
+     rb.bPitch = true;
+     outSlideType = effect.rateSlideType;
+     outResampleCB = resampleCB;
+     rb.offset = start;
+     rb.end = end;
+      // Third party library has its own type alias, check it
+      static_assert(sizeof(sampleCount::type) <=
+                    sizeof(_sbsms_::SampleCountType),
+                    "Type _sbsms_::SampleCountType is too narrow to hold a sampleCount");
+     rb.iface = std::make_unique<SBSMSInterfaceSliding>
+         (&rateSlide, &pitchSlide, effect.bPitchReferenceInput,
+          static_cast<_sbsms_::SampleCountType>
+             ( samplesToProcess.as_long_long() ),
+          0, nullptr);
+
+   }
+   else {
+     rb.bPitch = false;
+     outSlideType = (srProcess==srTrack?SlideIdentity:SlideConstant);
+     outResampleCB = postResampleCB;
+     rb.ratio = srProcess/srTrack;
+     rb.quality = std::make_unique<SBSMSQuality>(&SBSMSQualityStandard);
+     rb.resampler = std::make_unique<Resampler>(resampleCB, &rb, srProcess==srTrack?SlideIdentity:SlideConstant);
+     rb.sbsms = std::make_unique<SBSMS>(stereo ? 2 : 1, rb.quality.get(), true);
+     rb.SBSMSBlockSize = rb.sbsms->getInputFrameSize();
+     rb.SBSMSBuf.reinit(static_cast<size_t>(rb.SBSMSBlockSize), true);
+     rb.offset = start;
+     rb.end = end;
+     rb.iface = std::make_unique<SBSMSEffectInterface>
+         (rb.resampler.get(), &rateSlide, &pitchSlide,
+          effect.bPitchReferenceInput,
+          static_cast<_sbsms_::SampleCountType>( samplesToProcess.as_long_long() ),
+          0,
+          rb.quality.get());
+   }
+
+   resampler = std::make_unique<Resampler>(outResampleCB,&rb,outSlideType);
+
+   // Samples in output after SBSMS
+   sampleCount samplesToOutput = rb.iface->getSamplesToOutput();
+
+   samplesOut = (sampleCount) (samplesToOutput.as_float() * (srTrack/srProcess));
+}
+
+long EffectSBSMS::Stream::Read(float *left, float *right)
+{
+   audio outBuf[SBSMSOutBlockSize];
+
+   const auto frames =
+      limitSampleBufferSize( SBSMSOutBlockSize, samplesOut - pos );
+
+   outputCount = resampler->read(outBuf,frames);
+   for(int i = 0; i < outputCount; i++) {
+      left[i] = outBuf[i][0];
+      if(right)
+         right[i] = outBuf[i][1];
+   }
+   pos += outputCount;
+
+   auto pException = rb.mpException;
+   rb.mpException = {};
+   if (pException)
+      std::rethrow_exception(pException);
+
+   return outputCount;
+}
+
+//! Stretches a preview in memory, some blocks at a time
+class EffectSBSMS::Renderer final : public PreviewRenderer
+{
+public:
+   Renderer(const EffectSBSMS &effect,
+      std::shared_ptr<const Buffers> input, double rate)
+      : mInput{ std::move(input) }
+      , mStream{ effect, float(rate), (*mInput)[0].data(),
+         mInput->size() > 1 ? (*mInput)[1].data() : nullptr,
+         (*mInput)[0].size() }
+   {
+   }
+
+   bool Render(Buffers &outputs) override
+   {
+      float outBufLeft[2*SBSMSOutBlockSize];
+      float outBufRight[2*SBSMSOutBlockSize];
+      const bool stereo = outputs.size() > 1;
+      for (int ii = 0; ii < BlocksPerRender && !mStream.Done(); ++ii) {
+         const auto outputCount =
+            mStream.Read(outBufLeft, stereo ? outBufRight : nullptr);
+         outputs[0].insert(outputs[0].end(),
+            outBufLeft, outBufLeft + outputCount);
+         if (stereo)
+            outputs[1].insert(outputs[1].end(),
+               outBufRight, outBufRight + outputCount);
+      }
+      return true;
+   }
+
+private:
+   static constexpr int BlocksPerRender = 64;
+
+   const std::shared_ptr<const Buffers> mInput;
+   Stream mStream;
+};
+
 void EffectSBSMS :: setParameters(double rateStartIn, double rateEndIn, double pitchStartIn, double pitchEndIn,
                                   SlideType rateSlideTypeIn, SlideType pitchSlideTypeIn,
                                   bool bLinkRatePitchIn, bool bRateReferenceInputIn, bool bPitchReferenceInputIn)
@@ -209,6 +410,15 @@ double EffectSBSMS::getRate(double rateStart, double rateEnd, SlideType slideTyp
    return slide.getRate(t);
 }
 
+std::unique_ptr<PreviewRenderer> EffectSBSMS::MakePreviewRenderer(
+   std::shared_ptr<const PreviewRenderer::Buffers> input, double rate)
+{
+   // TODO: more-than-two-channels
+   if (input->empty() || input->size() > 2)
+      return nullptr;
+   return std::make_unique<Renderer>(*this, std::move(input), rate);
+}
+
 bool EffectSBSMS::Process()
 {
    bool bGoodResult = true;
@@ -223,7 +433,6 @@ bool EffectSBSMS::Process()
    // Must sync if selection length will change
    bool mustSync = (rateStart != rateEnd);
    Slide rateSlide(rateSlideType,rateStart,rateEnd);
-   Slide pitchSlide(pitchSlideType,pitchStart,pitchEnd);
    mTotalStretch = rateSlide.getTotalStretch();
 
    mOutputTracks->Leaders().VisitWhile( bGoodResult,
@@ -274,77 +483,12 @@ bool EffectSBSMS::Process()
                mCurTrackNum++; // Increment for rightTrack, too.
             }
 
-            // SBSMS has a fixed sample rate - we just convert to its sample rate and then convert back
-            float srTrack = leftTrack->GetRate();
-            float srProcess = bLinkRatePitch ? srTrack : 44100.0;
-
-            // the resampler needs a callback to supply its samples
-            ResampleBuf rb;
-            auto maxBlockSize = leftTrack->GetMaxBlockSize();
-            rb.blockSize = maxBlockSize;
-            rb.buf.reinit(rb.blockSize, true);
-            rb.leftTrack = leftTrack;
-            rb.rightTrack = rightTrack?rightTrack:leftTrack;
-            rb.leftBuffer.reinit(maxBlockSize, true);
-            rb.rightBuffer.reinit(maxBlockSize, true);
-
-            // Samples in selection
-            auto samplesIn = end - start;
-
-            // Samples for SBSMS to process after resampling
-            auto samplesToProcess = (sampleCount) (samplesIn.as_float() * (srProcess/srTrack));
-
-            SlideType outSlideType;
-            SBSMSResampleCB outResampleCB;
-
-            if(bLinkRatePitch) {
-              rb.bPitch = true;
-              outSlideType = rateSlideType;
-              outResampleCB = resampleCB;
-              rb.offset = start;
-              rb.end = end;
-               // Third party library has its own type alias, check it
-               static_assert(sizeof(sampleCount::type) <=
-                             sizeof(_sbsms_::SampleCountType),
-                             "Type _sbsms_::SampleCountType is too narrow to hold a sampleCount");
-              rb.iface = std::make_unique<SBSMSInterfaceSliding>
-                  (&rateSlide, &pitchSlide, bPitchReferenceInput,
-                   static_cast<_sbsms_::SampleCountType>
-                      ( samplesToProcess.as_long_long() ),
-                   0, nullptr);
-               
-            }
-            else {
-              rb.bPitch = false;
-              outSlideType = (srProcess==srTrack?SlideIdentity:SlideConstant);
-              outResampleCB = postResampleCB;
-              rb.ratio = srProcess/srTrack;
-              rb.quality = std::make_unique<SBSMSQuality>(&SBSMSQualityStandard);
-              rb.resampler = std::make_unique<Resampler>(resampleCB, &rb, srProcess==srTrack?SlideIdentity:SlideConstant);
-              rb.sbsms = std::make_unique<SBSMS>(rightTrack ? 2 : 1, rb.quality.get(), true);
-              rb.SBSMSBlockSize = rb.sbsms->getInputFrameSize();
-              rb.SBSMSBuf.reinit(static_cast<size_t>(rb.SBSMSBlockSize), true);
-              rb.offset = start;
-              rb.end = end;
-              rb.iface = std::make_unique<SBSMSEffectInterface>
-                  (rb.resampler.get(), &rateSlide, &pitchSlide,
-                   bPitchReferenceInput,
-                   static_cast<_sbsms_::SampleCountType>( samplesToProcess.as_long_long() ),
-                   0,
-                   rb.quality.get());
-            }
-            
-            Resampler resampler(outResampleCB,&rb,outSlideType);
+            Stream stream{ *this, leftTrack, rightTrack, start, end };
 
-            audio outBuf[SBSMSOutBlockSize];
             float outBufLeft[2*SBSMSOutBlockSize];
             float outBufRight[2*SBSMSOutBlockSize];
 
-            // Samples in output after SBSMS
-            sampleCount samplesToOutput = rb.iface->getSamplesToOutput();
-
-            // Samples in output after resampling back
-            auto samplesOut = (sampleCount) (samplesToOutput.as_float() * (srTrack/srProcess));
+            const auto samplesOut = stream.samplesOut;
 
             // Duration in track time
             double duration =  (mCurT1-mCurT0) * mTotalStretch;
@@ -354,30 +498,20 @@ bool EffectSBSMS::Process()
 
             auto warper = createTimeWarper(mCurT0,mCurT1,maxDuration,rateStart,rateEnd,rateSlideType);
 
-            rb.outputLeftTrack = leftTrack->EmptyCopy();
+            auto outputLeftTrack = leftTrack->EmptyCopy();
+            WaveTrack::Holder outputRightTrack;
             if(rightTrack)
-               rb.outputRightTrack = rightTrack->EmptyCopy();
-   
-            long pos = 0;
-            long outputCount = -1;
+               outputRightTrack = rightTrack->EmptyCopy();
 
             // process
-            while(pos<samplesOut && outputCount) {
-               const auto frames =
-                  limitSampleBufferSize( SBSMSOutBlockSize, samplesOut - pos );
-
-               outputCount = resampler.read(outBuf,frames);
-               for(int i = 0; i < outputCount; i++) {
-                  outBufLeft[i] = outBuf[i][0];
-                  if(rightTrack)
-                     outBufRight[i] = outBuf[i][1];
-               }
-               pos += outputCount;
-               rb.outputLeftTrack->Append((samplePtr)outBufLeft, floatSample, outputCount);
+            while(!stream.Done()) {
+               const auto outputCount = stream.Read(
+                  outBufLeft, rightTrack ? outBufRight : nullptr);
+               outputLeftTrack->Append((samplePtr)outBufLeft, floatSample, outputCount);
                if(rightTrack)
-                  rb.outputRightTrack->Append((samplePtr)outBufRight, floatSample, outputCount);
+                  outputRightTrack->Append((samplePtr)outBufRight, floatSample, outputCount);
 
-               double frac = (double)pos / samplesOut.as_double();
+               double frac = (double)stream.pos / samplesOut.as_double();
                int nWhichTrack = mCurTrackNum;
                if(rightTrack) {
                   nWhichTrack = 2*(mCurTrackNum/2);
@@ -395,20 +529,13 @@ bool EffectSBSMS::Process()
                }
             }
 
-            {
-               auto pException = rb.mpException;
-               rb.mpException = {};
-               if (pException)
-                  std::rethrow_exception(pException);
-            }
-
-            rb.outputLeftTrack->Flush();
+            outputLeftTrack->Flush();
             if(rightTrack)
-               rb.outputRightTrack->Flush();
+               outputRightTrack->Flush();
 
-            Finalize(leftTrack, rb.outputLeftTrack.get(), warper.get());
+            Finalize(leftTrack, outputLeftTrack.get(), warper.get());
             if(rightTrack)
-               Finalize(rightTrack, rb.outputRightTrack.get(), warper.get());
+               Finalize(rightTrack, outputRightTrack.get(), warper.get());
          }
          mCurTrackNum++;
       },
@@ -44,7 +44,14 @@ protected:
    // GetSymbol() is overridden further in derived classes.
    ComponentInterfaceSymbol GetSymbol() override { return mProxyEffectName; }
 
+   std::unique_ptr<PreviewRenderer> MakePreviewRenderer(
+      std::shared_ptr<const PreviewRenderer::Buffers> input,
+      double rate) override;
+
 private:
+   class Stream;
+   class Renderer;
+
    bool ProcessLabelTrack(LabelTrack *track);
    void Finalize(WaveTrack* orig, WaveTrack* out, const TimeWarper *warper);
 
@@ -227,12 +227,8 @@ bool EffectScienFilter::ProcessInitialize(sampleCount WXUNUSED(totalLen), Channe
 
 size_t EffectScienFilter::ProcessBlock(float **inBlock, float **outBlock, size_t blockLen)
 {
-   float *ibuf = inBlock[0];
-   for (int iPair = 0; iPair < (mOrder + 1) / 2; iPair++)
-   {
-      mpBiquad[iPair].Process(ibuf, outBlock[0], blockLen);
-      ibuf = outBlock[0];
-   }
+   Biquad::ProcessCascade(mpBiquad.get(), (mOrder + 1) / 2,
+      inBlock[0], outBlock[0], blockLen);
 
    return blockLen;
 }
@@ -576,6 +572,34 @@ bool EffectScienFilter::TransferDataFromWindow()
    return true;
 }
 
+std::unique_ptr<Effect> EffectScienFilter::CloneForParallelProcessing()
+{
+   auto result = CloneWithSettings<EffectScienFilter>();
+   if (result) {
+      // The filter is designed for the rate found by Init()
+      auto &filter = static_cast<EffectScienFilter&>(*result);
+      filter.mNyquist = mNyquist;
+      filter.CalcFilter();
+   }
+   return result;
+}
+
+std::optional<size_t> EffectScienFilter::GetWarmUpLength(double sampleRate)
+{
+   // Errors in the state of each section pass on to the following ones
+   size_t length = 0;
+   for (int iPair = 0; iPair < (mOrder + 1) / 2; iPair++) {
+      const auto settling = mpBiquad[iPair].SettlingLength();
+      if (settling == 0)
+         return {};
+      length += settling;
+   }
+   // Don't bother if the filter rings for very long
+   if (length > sampleRate * 10)
+      return {};
+   return length;
+}
+
 // EffectScienFilter implementation
 
 //
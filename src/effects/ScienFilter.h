@@ -65,6 +65,9 @@ public:
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
 
+   std::unique_ptr<Effect> CloneForParallelProcessing() override;
+   std::optional<size_t> GetWarmUpLength(double sampleRate) override;
+
 private:
    // EffectScienFilter implementation
 
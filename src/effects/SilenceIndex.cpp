@@ -0,0 +1,125 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SilenceIndex.cpp
+
+**********************************************************************/
+
+#include "SilenceIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+#include "../SampleBlock.h"
+
+namespace {
+
+//! Indices of recently analysed regions, used only from the main thread
+/*!
+ An index of a three hour track at 44100 Hz takes about seven megabytes
+ */
+constexpr size_t SilenceIndexCacheSize = 8;
+std::deque<std::shared_ptr<const SilenceIndex>> sSilenceIndexCache;
+
+}
+
+std::shared_ptr<const SilenceIndex>
+SilenceIndex::Get(const WaveTrack &track, sampleCount start, sampleCount end)
+{
+   ChannelContents contents{ track, start, end };
+   const auto length = end - start;
+   auto iter = std::find_if(
+      sSilenceIndexCache.begin(), sSilenceIndexCache.end(),
+      [&](const std::shared_ptr<const SilenceIndex> &pIndex){
+         return pIndex->mLength == length && pIndex->mContents == contents;
+      });
+   if (iter != sSilenceIndexCache.end())
+      return *iter;
+
+   auto pIndex =
+      std::make_shared<const SilenceIndex>(std::move(contents), length);
+   if (sSilenceIndexCache.size() >= SilenceIndexCacheSize)
+      sSilenceIndexCache.pop_back();
+   sSilenceIndexCache.push_front(pIndex);
+   return pIndex;
+}
+
+SilenceIndex::SilenceIndex(ChannelContents contents, sampleCount length)
+   : mContents{ std::move(contents) }
+   , mLength{ length }
+{
+   std::vector<float> summary;
+   for (const auto &piece : mContents.pieces) {
+      const auto first = piece.offset / FrameSize;
+      const auto last = (piece.offset + piece.count - 1) / FrameSize;
+      const auto nFrames = last - first + 1;
+
+      // The track holds the blocks while the index is made
+      const auto block = piece.block.lock();
+      mBlockSizes.push_back(block->GetSampleCount());
+      mFirstPeaks.push_back(mPeaks.size());
+
+      // Each frame of the summary is minimum, maximum, and RMS
+      summary.resize(3 * nFrames);
+      if (block->GetSummary256(summary.data(), first, nFrames))
+         for (size_t ii = 0; ii < nFrames; ++ii)
+            mPeaks.push_back(
+               std::max(-summary[3 * ii], summary[3 * ii + 1]));
+      else
+         // Unknown, so never certainly silent
+         mPeaks.insert(mPeaks.end(), nFrames,
+            std::numeric_limits<float>::infinity());
+   }
+}
+
+auto SilenceIndex::FrameAt(sampleCount position) const -> Frame
+{
+   const auto &pieces = mContents.pieces;
+   // Find the first piece starting after position
+   auto iter = std::upper_bound(pieces.begin(), pieces.end(), position,
+      [](sampleCount pos, const ChannelContents::Piece &piece)
+         { return pos < piece.position; });
+
+   sampleCount gapStart = 0;
+   if (iter != pieces.begin()) {
+      const auto &piece = *(iter - 1);
+      const auto pieceEnd = piece.position + piece.count;
+      if (position < pieceEnd) {
+         const auto nn = (iter - 1) - pieces.begin();
+         const auto blockPos =
+            piece.offset + (position - piece.position).as_size_t();
+         const auto frame = blockPos / FrameSize;
+         const auto frameStart = frame * FrameSize;
+         const auto frameEnd =
+            std::min(frameStart + FrameSize, mBlockSizes[nn]);
+         const auto start = std::max(frameStart, piece.offset);
+         const auto end = std::min(frameEnd, piece.offset + piece.count);
+         const auto peak =
+            mPeaks[mFirstPeaks[nn] + frame - piece.offset / FrameSize];
+         return {
+            piece.position + (start - piece.offset),
+            piece.position + (end - piece.offset),
+            peak,
+            start == frameStart && end == frameEnd && std::isfinite(peak)
+         };
+      }
+      gapStart = pieceEnd;
+   }
+
+   // Between clips
+   const auto gapEnd = (iter == pieces.end()) ? mLength : iter->position;
+   return { gapStart, gapEnd, 0.0f, true };
+}
+
+bool SilenceIndex::IsBetweenSounds(const Frame &frame, double threshold) const
+{
+   if (frame.start <= 0 || frame.end >= mLength)
+      return false;
+   const auto before = FrameAt(frame.start - 1);
+   const auto after = FrameAt(frame.end);
+   return before.exact && before.peak >= threshold &&
+      after.exact && after.peak >= threshold;
+}
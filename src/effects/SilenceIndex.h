@@ -0,0 +1,70 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SilenceIndex.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SILENCE_INDEX__
+#define __AUDACITY_SILENCE_INDEX__
+
+#include <memory>
+#include <vector>
+
+#include "ChannelContents.h"
+
+//! Peak level of a channel in each frame of up to 256 samples of a region,
+//! from the summaries of the sample blocks
+/*!
+ Frames follow the summaries, so they may be shorter at the ends of blocks,
+ of the visible parts of clips, and of the region.  Stretches outside of
+ clips, which read as zeroes, make frames of zero peak.
+
+ A frame with peak below a threshold is certainly silent.  If the frame is
+ exact, a peak at or above the threshold means that at least one sample is
+ too.  Frames cut short by trimming of clips, or by the ends of the region,
+ are not exact, because their peaks include samples outside them; nor are
+ frames whose summaries could not be read.
+ */
+class SilenceIndex final
+{
+public:
+   static constexpr size_t FrameSize = 256;
+
+   struct Frame
+   {
+      sampleCount start; //!< relative to the start of the region
+      sampleCount end;
+      float peak;
+      bool exact;
+   };
+
+   //! Index of the channel from start to end
+   /*!
+    Reuses one made earlier for the same samples, if still remembered,
+    which saves reading the summaries again
+    */
+   static std::shared_ptr<const SilenceIndex>
+      Get(const WaveTrack &track, sampleCount start, sampleCount end);
+
+   SilenceIndex(ChannelContents contents, sampleCount length);
+
+   //! Frame containing position, relative to the start of the region
+   Frame FrameAt(sampleCount position) const;
+
+   //! Whether the frames before and after exist, are exact, and have peaks
+   //! at least threshold
+   bool IsBetweenSounds(const Frame &frame, double threshold) const;
+
+private:
+   ChannelContents mContents;
+   //! For each piece of mContents, the sample count of its block
+   std::vector<size_t> mBlockSizes;
+   //! For each piece of mContents, index of the peak of its first frame
+   std::vector<size_t> mFirstPeaks;
+   std::vector<float> mPeaks;
+   sampleCount mLength;
+};
+
+#endif
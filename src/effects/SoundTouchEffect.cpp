@@ -17,6 +17,7 @@ effect that uses SoundTouch to do its processing (ChangeTempo
 #if USE_SOUNDTOUCH
 #include "SoundTouchEffect.h"
 
+#include <algorithm>
 #include <math.h>
 
 #include "../LabelTrack.h"
@@ -183,6 +184,106 @@ bool EffectSoundTouch::ProcessWithTimeWarper(InitFunction initer,
    return bGoodResult;
 }
 
+namespace {
+//! Feeds the channels of a preview, interleaved, to SoundTouch
+class SoundTouchRenderer final : public PreviewRenderer
+{
+public:
+   SoundTouchRenderer(std::unique_ptr<soundtouch::SoundTouch> pSoundTouch,
+      bool preserveLength, std::shared_ptr<const Buffers> input)
+      : mSoundTouch{ std::move(pSoundTouch) }
+      , mPreserveLength{ preserveLength }
+      , mInput{ std::move(input) }
+      , mNumChannels{ mInput->size() }
+      , mLength{ (*mInput)[0].size() }
+      , mBuffer( BlockSize * mNumChannels )
+   {
+   }
+
+   bool Render(Buffers &outputs) override
+   {
+      if (mDone)
+         return true;
+
+      if (mPos < mLength) {
+         const auto block = std::min(BlockSize, mLength - mPos);
+         // Interleave, as SoundTouch wants it
+         for (size_t index = 0; index < block; ++index)
+            for (size_t iChannel = 0; iChannel < mNumChannels; ++iChannel)
+               mBuffer[index * mNumChannels + iChannel] =
+                  (*mInput)[iChannel][mPos + index];
+         mSoundTouch->putSamples(mBuffer.data(), block);
+         mPos += block;
+      }
+      else {
+         // Tell SoundTouch to finish processing any remaining samples
+         mSoundTouch->flush();
+         mDone = true;
+      }
+
+      Receive(outputs, mSoundTouch->numSamples());
+
+      if (mDone && mPreserveLength && mProduced < mLength) {
+         // Pad output to original length since SoundTouch may remove samples
+         for (auto &output : outputs)
+            output.resize(output.size() + mLength - mProduced, 0.0f);
+         mProduced = mLength;
+      }
+      return true;
+   }
+
+private:
+   void Receive(Buffers &outputs, size_t outputCount)
+   {
+      if (outputCount == 0)
+         return;
+      mOutputBuffer.resize(outputCount * mNumChannels);
+      mSoundTouch->receiveSamples(mOutputBuffer.data(), outputCount);
+      // Trim output to original length since SoundTouch may add extra
+      // samples
+      if (mPreserveLength)
+         outputCount = std::min(outputCount, mLength - mProduced);
+      // Dis-interleave
+      for (size_t iChannel = 0; iChannel < mNumChannels; ++iChannel) {
+         auto &output = outputs[iChannel];
+         for (size_t index = 0; index < outputCount; ++index)
+            output.push_back(
+               mOutputBuffer[index * mNumChannels + iChannel]);
+      }
+      mProduced += outputCount;
+   }
+
+   static constexpr size_t BlockSize = 8192;
+
+   const std::unique_ptr<soundtouch::SoundTouch> mSoundTouch;
+   const bool mPreserveLength;
+   const std::shared_ptr<const Buffers> mInput;
+   const size_t mNumChannels;
+   const size_t mLength;
+   std::vector<float> mBuffer;
+   std::vector<float> mOutputBuffer;
+   size_t mPos{ 0 };
+   size_t mProduced{ 0 };
+   bool mDone{ false };
+};
+}
+
+std::unique_ptr<PreviewRenderer> EffectSoundTouch::MakeSoundTouchRenderer(
+   InitFunction initer, bool preserveLength,
+   std::shared_ptr<const PreviewRenderer::Buffers> input, double rate)
+{
+   // TODO: more-than-two-channels
+   if (input->empty() || input->size() > 2)
+      return nullptr;
+
+   auto pSoundTouch = std::make_unique<soundtouch::SoundTouch>();
+   initer(pSoundTouch.get());
+   pSoundTouch->setChannels(input->size());
+   pSoundTouch->setSampleRate((unsigned int)(rate + 0.5));
+   return std::make_unique<SoundTouchRenderer>(
+      std::move(pSoundTouch), preserveLength, std::move(input));
+}
+
 void EffectSoundTouch::End()
 {
    mSoundTouch.reset();
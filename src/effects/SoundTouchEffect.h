@@ -53,6 +53,12 @@ protected:
                               const TimeWarper &warper,
                               bool preserveLength);
 
+   //! Render a preview as ProcessWithTimeWarper() would, in memory
+   /*! For MakePreviewRenderer() of subclasses */
+   std::unique_ptr<PreviewRenderer> MakeSoundTouchRenderer(
+      InitFunction initer, bool preserveLength,
+      std::shared_ptr<const PreviewRenderer::Buffers> input, double rate);
+
    std::unique_ptr<soundtouch::SoundTouch> mSoundTouch;
    double mCurT0;
    double mCurT1;
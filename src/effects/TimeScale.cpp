@@ -183,7 +183,29 @@ void EffectTimeScale::Preview(bool dryOnly)
    Effect::Preview(dryOnly);
 }
 
+bool EffectTimeScale::CanReusePreview()
+{
+   // The result depends only on the input and the parameters
+   return true;
+}
+
+std::unique_ptr<PreviewRenderer> EffectTimeScale::MakePreviewRenderer(
+   std::shared_ptr<const PreviewRenderer::Buffers> input, double rate)
+{
+   if (input->empty())
+      return nullptr;
+   // The input is the previewed part of the selection
+   SetSBSMSParameters((*input)[0].size() / rate);
+   return EffectSBSMS::MakePreviewRenderer(std::move(input), rate);
+}
+
 bool EffectTimeScale::Process()
+{
+   SetSBSMSParameters(mT1-mT0);
+   return EffectSBSMS::Process();
+}
+
+void EffectTimeScale::SetSBSMSParameters(double duration)
 {
    double pitchStart1 = PercentChangeToRatio(m_PitchPercentChangeStart);
    double pitchEnd1 = PercentChangeToRatio(m_PitchPercentChangeEnd);
@@ -191,13 +213,12 @@ bool EffectTimeScale::Process()
    double rateEnd1 = PercentChangeToRatio(m_RatePercentChangeEnd);
   
    if(bPreview) {
-      double t = (mT1-mT0) / previewSelectedDuration;
+      double t = duration / previewSelectedDuration;
       rateEnd1 = EffectSBSMS::getRate(rateStart1,rateEnd1,slideTypeRate,t);
       pitchEnd1 = EffectSBSMS::getRate(pitchStart1,pitchEnd1,slideTypePitch,t);
    }
    
    EffectSBSMS::setParameters(rateStart1,rateEnd1,pitchStart1,pitchEnd1,slideTypeRate,slideTypePitch,false,false,false);
-   return EffectSBSMS::Process();
 }
 
 void EffectTimeScale::PopulateOrExchange(ShuttleGui & S)
@@ -50,6 +50,10 @@ public:
    bool Init() override;
    void Preview(bool dryOnly) override;
    bool Process() override;
+   bool CanReusePreview() override;
+   std::unique_ptr<PreviewRenderer> MakePreviewRenderer(
+      std::shared_ptr<const PreviewRenderer::Buffers> input,
+      double rate) override;
    void PopulateOrExchange(ShuttleGui & S) override;
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
@@ -62,6 +66,9 @@ private:
    inline double HalfStepsToPercentChange(double halfSteps);
    inline double PercentChangeToHalfSteps(double percentChange);
 
+   //! Set the parameters of EffectSBSMS for duration seconds of the selection
+   void SetSBSMSParameters(double duration);
+
    void OnText_RatePercentChangeStart(wxCommandEvent & evt);
    void OnText_RatePercentChangeEnd(wxCommandEvent & evt);
    void OnText_PitchPercentChangeStart(wxCommandEvent & evt);
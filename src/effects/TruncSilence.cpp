@@ -18,6 +18,7 @@
 
 #include "TruncSilence.h"
 #include "LoadEffects.h"
+#include "SilenceIndex.h"
 
 #include <algorithm>
 #include <list>
@@ -623,6 +624,21 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
    // Allocate buffer
    Floats buffer{ blockLen };
 
+   // Except when finding the length for preview, which needs every sample,
+   // read only frames that the block summaries leave in doubt
+   std::shared_ptr<const SilenceIndex> silenceIndex;
+   if (!inputLength)
+      silenceIndex = SilenceIndex::Get(*wt, start, end);
+   // Silences long enough to detect cannot end within a frame having
+   // sound on both sides, so such frames need not be read either
+   const bool skipBetweenSounds =
+      minSilenceFrames >= 3 * SilenceIndex::FrameSize;
+   const auto needsReading = [&](const SilenceIndex::Frame &frame){
+      return frame.peak >= truncDbSilenceThreshold &&
+         !(skipBetweenSounds &&
+           silenceIndex->IsBetweenSounds(frame, truncDbSilenceThreshold));
+   };
+
    // Loop through current track
    while (*index < end) {
       if (inputLength && ((outLength >= previewLen) || (*index - start > wt->TimeToLongSamples(*minInputLength)))) {
@@ -688,6 +704,52 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
       // Limit size of current block if we've reached the end
       auto count = limitSampleBufferSize( blockLen, end - *index );
 
+      if (silenceIndex) {
+         const auto blockEnd = *index + count;
+         auto pos = *index;
+         while (pos < blockEnd) {
+            auto frame = silenceIndex->FrameAt(pos - start);
+            auto frameEnd = std::min(start + frame.end, blockEnd);
+            if (frame.peak < truncDbSilenceThreshold) {
+               *silentFrame += frameEnd - pos;
+               pos = frameEnd;
+               continue;
+            }
+            if (!needsReading(frame)) {
+               *silentFrame = 0;
+               pos = frameEnd;
+               continue;
+            }
+
+            // Read this and any following frames in doubt at once
+            while (frameEnd < blockEnd) {
+               frame = silenceIndex->FrameAt(frameEnd - start);
+               if (!needsReading(frame))
+                  break;
+               frameEnd = std::min(start + frame.end, blockEnd);
+            }
+            const auto len = (frameEnd - pos).as_size_t();
+            wt->GetFloats(buffer.get(), pos, len);
+            for (size_t i = 0; i < len; ++i) {
+               if (fabs(buffer[i]) < truncDbSilenceThreshold)
+                  (*silentFrame)++;
+               else {
+                  if (*silentFrame >= minSilenceFrames)
+                     trackSilences.push_back(Region(
+                        wt->LongSamplesToTime(pos + i - *silentFrame),
+                        wt->LongSamplesToTime(pos + i)
+                     ));
+                  *silentFrame = 0;
+               }
+            }
+            pos = frameEnd;
+         }
+
+         // Next block
+         *index += count;
+         continue;
+      }
+
       // Fill buffer
       wt->GetFloats((buffer.get()), *index, count);
 
@@ -341,6 +341,12 @@ bool EffectWahwah::TransferDataFromWindow()
    return true;
 }
 
+std::unique_ptr<Effect> EffectWahwah::CloneForParallelProcessing()
+{
+   // ProcessInitialize() makes all the state for each track
+   return CloneWithSettings<EffectWahwah>();
+}
+
 // EffectWahwah implementation
 
 void EffectWahwah::InstanceInit(EffectWahwahState & data, float sampleRate)
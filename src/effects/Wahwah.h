@@ -78,6 +78,8 @@ public:
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
 
+   std::unique_ptr<Effect> CloneForParallelProcessing() override;
+
 private:
    // EffectWahwah implementation
 
@@ -285,7 +285,9 @@ ProgressResult ExportOGG::Export(AudacityProject *project,
 
       while (updateResult == ProgressResult::Success && !eos) {
          float **vorbis_buffer = vorbis_analysis_buffer(&dsp, SAMPLES_PER_RUN);
-         auto samplesThisRun = mixer->Process(SAMPLES_PER_RUN);
+         // Mix directly into the encoder's buffers
+         auto samplesThisRun = mixer->Process(SAMPLES_PER_RUN,
+            reinterpret_cast<const samplePtr *>(vorbis_buffer));
 
          int err;
          if (samplesThisRun == 0) {
@@ -293,12 +295,6 @@ ProgressResult ExportOGG::Export(AudacityProject *project,
             err = vorbis_analysis_wrote(&dsp, 0);
          }
          else {
-
-            for (size_t i = 0; i < numChannels; i++) {
-               float *temp = (float *)mixer->GetBuffer(i);
-               memcpy(vorbis_buffer[i], temp, sizeof(float)*SAMPLES_PER_RUN);
-            }
-
             // tell the encoder how many samples we have
             err = vorbis_analysis_wrote(&dsp, samplesThisRun);
          }
@@ -5,6 +5,7 @@
 #include "../CommonCommandFlags.h"
 #include "DeviceManager.h"
 #include "../LabelTrack.h"
+#include "../LatencyMeasurement.h"
 #include "../Menus.h"
 #include "Prefs.h"
 #include "Project.h"
@@ -38,6 +39,7 @@
 
 #include <float.h>
 #include <wx/app.h>
+#include <wx/utils.h>
 
 // private helper classes and functions
 namespace {
@@ -703,6 +705,55 @@ void OnRescanDevices(const CommandContext &WXUNUSED(context) )
    DeviceManager::Instance()->Rescan();
 }
 
+void OnMeasureLatency(const CommandContext &context)
+{
+   AudacityProject &project = context.project;
+   auto &window = GetProjectFrame( project );
+
+   auto choice = AudacityMessageBox(
+      XO(
+"Audacity will play a short burst of noise and record it back, to measure the\n"
+"round trip latency of the selected playback and recording devices.\n\n"
+"Connect the output to the input, for instance with a loopback cable, or\n"
+"place a microphone near the speakers, and then press OK."),
+      XO("Measure Recording Latency"),
+      wxOK | wxCANCEL | wxICON_INFORMATION,
+      &window );
+   if (choice != wxOK)
+      return;
+
+   auto gAudioIO = AudioIO::Get();
+   if (gAudioIO->IsMonitoring()) {
+      gAudioIO->StopStream();
+      while (gAudioIO->IsBusy())
+         wxMilliSleep(100);
+   }
+
+   wxBusyCursor busy;
+   auto latency = gAudioIO->MeasureLatency( DefaultPlayOptions( project ) );
+   if (!latency) {
+      AudacityMessageBox(
+         XO(
+"The test signal could not be found in the recording.\n"
+"Check the connection and the recording level, and try again."),
+         XO("Measure Recording Latency"),
+         wxOK | wxICON_WARNING,
+         &window );
+      return;
+   }
+
+   const auto milliseconds = *latency * 1000.0;
+   LatencyMeasurement::Store(milliseconds);
+   AudacityMessageBox(
+      XO(
+"The measured round trip latency is %.1f milliseconds.\n"
+"It will be compensated when recording with these devices.")
+         .Format( milliseconds ),
+      XO("Measure Recording Latency"),
+      wxOK | wxICON_INFORMATION,
+      &window );
+}
+
 void OnSoundActivated(const CommandContext &context)
 {
    AudacityProject &project = context.project;
@@ -1183,6 +1234,9 @@ BaseItemSharedPtr TransportMenu()
          Command( wxT("RescanDevices"), XXO("R&escan Audio Devices"),
             FN(OnRescanDevices), AudioIONotBusyFlag() | CanStopAudioStreamFlag() ),
 
+         Command( wxT("MeasureLatency"), XXO("&Measure Recording Latency..."),
+            FN(OnMeasureLatency), AudioIONotBusyFlag() | CanStopAudioStreamFlag() ),
+
          Menu( wxT("Options"), XXO("Transport &Options"),
             Section( "",
                // Sound Activated recording options
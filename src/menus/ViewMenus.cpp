@@ -3,6 +3,7 @@
 #include "Prefs.h"
 #include "Project.h"
 #include "../ProjectHistory.h"
+#include "../ProjectOverview.h"
 #include "../ProjectSettings.h"
 #include "../ProjectWindow.h"
 #include "../Track.h"
@@ -336,6 +337,19 @@ void OnShowClipping(const CommandContext &context)
    trackPanel.Refresh(false);
 }
 
+void OnShowOverview(const CommandContext &context)
+{
+   auto &project = context.project;
+   auto &commandManager = CommandManager::Get( project );
+
+   bool checked = !ShowProjectOverview.Read();
+   ShowProjectOverview.Write(checked);
+   gPrefs->Flush();
+   commandManager.Check(wxT("ShowOverview"), checked);
+
+   PrefsListener::Broadcast(ShowOverviewPrefsID());
+}
+
 void OnShowNameOverlay(const CommandContext &context)
 {
    auto &project = context.project;
@@ -465,7 +479,10 @@ BaseItemSharedPtr ViewMenu()
             Options{}.CheckTest( wxT("/GUI/ShowTrackNameInWaveform"), false ) ),
          Command( wxT("ShowClipping"), XXO("&Show Clipping (on/off)"),
             FN(OnShowClipping), AlwaysEnabledFlag,
-            Options{}.CheckTest( wxT("/GUI/ShowClipping"), false ) )
+            Options{}.CheckTest( wxT("/GUI/ShowClipping"), false ) ),
+         Command( wxT("ShowOverview"), XXO("Project &Overview (on/off)"),
+            FN(OnShowOverview), AlwaysEnabledFlag,
+            Options{}.CheckTest( wxT("/GUI/ShowOverview"), false ) )
    #if defined(EXPERIMENTAL_EFFECTS_RACK)
          ,
          Command( wxT("ShowEffectsRack"), XXO("Show Effects Rack"),
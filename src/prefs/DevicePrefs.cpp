@@ -201,6 +201,12 @@ void DevicePrefs::PopulateOrExchange(ShuttleGui & S)
             .TieNumericTextBox(XXO("&Latency compensation:"),
                AudioIOLatencyCorrection, 9);
          S.AddUnits(XO("milliseconds"));
+
+         w = S
+            .NameSuffix(XO("milliseconds"))
+            .TieNumericTextBox(XXO("&Monitoring buffer length:"),
+               AudioIOMonitorBufferDuration, 9);
+         S.AddUnits(XO("milliseconds"));
       }
       S.EndThreeColumn();
    }
@@ -412,6 +418,9 @@ bool DevicePrefs::Commit()
       AudioIORecordChannels.Write(mChannels->GetSelection() + 1);
    }
 
+   if (AudioIOMonitorBufferDuration.Read() < 0)
+      AudioIOMonitorBufferDuration.Reset();
+
    return true;
 }
 
@@ -24,6 +24,7 @@
 #include <wx/defs.h>
 
 #include "Languages.h"
+#include "../ParallelFor.h"
 #include "../PluginManager.h"
 #include "Prefs.h"
 #include "../ShuttleGui.h"
@@ -208,6 +209,10 @@ void EffectsPrefs::PopulateOrExchange(ShuttleGui & S)
 #endif
                              },
                              5);
+
+         S.TieIntegerTextBox(
+            XXO("Maximum &threads for processing (0 for all processors):"),
+            EffectsMaxThreads, 5);
       }
       S.EndMultiColumn();
    }
@@ -226,15 +231,6 @@ void EffectsPrefs::PopulateOrExchange(ShuttleGui & S)
    S.EndStatic();
 #endif
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   S.StartStatic(XO("Instruction Set"));
-   {
-      S.TieCheckBox(XXO("&Use SSE/SSE2/.../AVX"),
-                    {wxT("/SSE/GUI"),
-                    true});
-   }
-   S.EndStatic();
-#endif
    S.EndScroller();
 }
 
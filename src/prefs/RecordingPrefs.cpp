@@ -21,6 +21,7 @@
 
 #include "RecordingPrefs.h"
 #include "AudioIOBase.h"
+#include "../LatencyMeasurement.h"
 
 #include <wx/defs.h>
 #include <wx/textctrl.h>
@@ -106,6 +107,10 @@ void RecordingPrefs::PopulateOrExchange(ShuttleGui & S)
       S.TieCheckBox(XXO("&Software playthrough of input"),
                     {wxT("/AudioIO/SWPlaythrough"),
                      false});
+      S.TieCheckBox(XXO("Apply realtime effects to playthrough while &monitoring"),
+                    AudioIOMonitorEffects);
+      S.TieCheckBox(XXO("Use measured latenc&y when available"),
+                    AudioIOUseMeasuredLatency);
 #if !defined(__WXMAC__)
       //S.AddUnits(XO("     (uncheck when recording computer playback)"));
 #endif
@@ -26,6 +26,7 @@
 #include "FFT.h"
 #include "Project.h"
 #include "../ShuttleGui.h"
+#include "../SpectrogramTileStore.h"
 
 #include "../TrackPanel.h"
 #include "../WaveTrack.h"
@@ -319,6 +320,16 @@ void SpectrumPrefs::PopulateOrExchange(ShuttleGui & S)
    S.EndStatic();
 #endif
 
+   if (!mWt) {
+      S.StartStatic(XO("Project files"));
+      {
+         S.TieCheckBox(
+            XXO("&Keep computed spectrograms in the project file"),
+            SpectrumCacheInProject);
+      }
+      S.EndStatic();
+   }
+
    } S.EndScroller();
    
    // Enabling and disabling belongs outside this function.
@@ -205,6 +205,7 @@ std::vector<UIHandlePtr> LabelTrackView::DetailedHitTest
 bool LabelTrackView::mbGlyphsReady=false;
 
 wxFont LabelTrackView::msFont;
+unsigned LabelTrackView::msFontGeneration = 1;
 
 /// We have several variants of the icons (highlighting).
 /// The icons are draggable, and you can drag one boundary
@@ -264,6 +265,7 @@ void LabelTrackView::ResetFont()
    wxString facename = gPrefs->Read(wxT("/GUI/LabelFontFacename"), wxT(""));
    int size = gPrefs->Read(wxT("/GUI/LabelFontSize"), DefaultFontSize);
    msFont = GetFont(facename, size);
+   ++msFontGeneration;
 }
 
 /// ComputeTextPosition is 'smart' about where to display
@@ -807,12 +809,16 @@ void LabelTrackView::Draw
 
    wxCoord textWidth, textHeight;
 
-   // Get the text widths.
-   // TODO: Make more efficient by only re-computing when a
-   // text label title changes.
+   // Get the text widths, measuring only labels whose titles or font
+   // changed since last drawn.
+   int maxWidth = 0;
    for (const auto &labelStruct : mLabels) {
-      dc.GetTextExtent(labelStruct.title, &textWidth, &textHeight);
-      labelStruct.width = textWidth;
+      if (labelStruct.widthGeneration != msFontGeneration) {
+         dc.GetTextExtent(labelStruct.title, &textWidth, &textHeight);
+         labelStruct.width = textWidth;
+         labelStruct.widthGeneration = msFontGeneration;
+      }
+      maxWidth = wxMax(maxWidth, labelStruct.width);
    }
 
    // TODO: And this only needs to be done once, but we
@@ -825,6 +831,15 @@ void LabelTrackView::Draw
    const int yFrameHeight = mTextHeight + TextFramePadding * 2;
 
    ComputeLayout( r, zoomInfo );
+
+   // Draw only labels that may show in r.  Text lies between the ends of its
+   // label, or to the right of the left end if too wide, so labels ending
+   // further left than the widest text can't show.
+   const auto range = pTrack->FindLabels(
+      zoomInfo.PositionToTime(r.x - maxWidth - 3 * mIconWidth, r.x),
+      zoomInfo.PositionToTime(r.x + r.width + mIconWidth, r.x));
+   const int first = range.first, last = range.second;
+
    dc.SetTextForeground(theTheme.Colour( clrLabelTrackText));
    dc.SetBackgroundMode(wxTRANSPARENT);
    dc.SetBrush(AColor::labelTextNormalBrush);
@@ -835,11 +850,12 @@ void LabelTrackView::Draw
    // so that the correct things overpaint each other.
 
    // Draw vertical lines that show where the end positions are.
-   for (const auto &labelStruct : mLabels)
-      DrawLines( dc, labelStruct, r );
+   for (int i = first; i < last; ++i)
+      DrawLines( dc, mLabels[i], r );
 
    // Draw the end glyphs.
-   { int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+   for (int i = first; i < last; ++i) {
+      const auto &labelStruct = mLabels[i];
       GlyphLeft=0;
       GlyphRight=1;
       if( pHit && i == pHit->mMouseOverLabelLeft )
@@ -847,7 +863,7 @@ void LabelTrackView::Draw
       if( pHit && i == pHit->mMouseOverLabelRight )
          GlyphRight = (pHit->mEdge & 4) ? 7:4;
       DrawGlyphs( dc, labelStruct, r, GlyphLeft, GlyphRight );
-   }}
+   }
 
    auto &project = *artist->parent->GetProject();
 
@@ -858,7 +874,8 @@ void LabelTrackView::Draw
       auto target = dynamic_cast<LabelTextHandle*>(context.target.get());
       highlightTrack = target && target->GetTrack().get() == this;
 #endif
-      int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+      for (int i = first; i < last; ++i) {
+         const auto &labelStruct = mLabels[i];
          bool highlight = false;
 #ifdef EXPERIMENTAL_TRACK_PANEL_HIGHLIGHTING
          highlight = highlightTrack && target->GetLabelNum() == i;
@@ -892,13 +909,13 @@ void LabelTrackView::Draw
    }
 
    // Draw the text and the label boxes.
-   { int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+   for (int i = first; i < last; ++i) {
       if(mTextEditIndex == i )
          dc.SetBrush(AColor::labelTextEditBrush);
-      DrawText( dc, labelStruct, r );
+      DrawText( dc, mLabels[i], r );
       if(mTextEditIndex == i )
          dc.SetBrush(AColor::labelTextNormalBrush);
-   }}
+   }
 
    // Draw the cursor, if there is one.
    if(mInitialCursorPos == mCurrentCursorPos && IsValidIndex(mTextEditIndex, project))
@@ -2032,13 +2049,15 @@ int LabelTrackView::GetLabelIndex(double t, double t1)
    const double delta = 1.0e-7;
    const auto pTrack = FindLabelTrack();
    const auto &mLabels = pTrack->GetLabels();
-   { int i = -1; for (const auto &labelStruct : mLabels) { ++i;
+   const auto range = pTrack->FindLabels( t - delta, t + delta );
+   for (int i = range.first; i < (int)range.second; ++i) {
+      const auto &labelStruct = mLabels[i];
       if( fabs( labelStruct.getT0() - t ) > delta )
          continue;
       if( fabs( labelStruct.getT1() - t1 ) > delta )
          continue;
       return i;
-   }}
+   }
 
    return wxNOT_FOUND;
 }
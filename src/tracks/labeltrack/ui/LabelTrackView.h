@@ -258,6 +258,8 @@ private:
    std::weak_ptr<LabelTextHandle> mTextHandle;
 
    static wxFont msFont;
+   /// Counts changes of msFont, so that text widths are measured again
+   static unsigned msFontGeneration;
 
    // Bug #2571: See explanation in ShowContextMenu()
    int mEditIndex;
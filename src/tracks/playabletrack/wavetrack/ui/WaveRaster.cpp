@@ -0,0 +1,114 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+WaveRaster.cpp
+
+split from WaveformView.cpp
+
+**********************************************************************/
+
+#include "WaveRaster.h"
+
+#include <algorithm>
+#include <vector>
+#include <wx/bitmap.h>
+#include <wx/colour.h>
+#include <wx/dc.h>
+#include <wx/pen.h>
+
+namespace {
+//! How many sizes of bitmap to keep
+constexpr size_t MaxBitmaps = 4;
+
+//! Most recently used first
+std::vector<wxBitmap> &Bitmaps()
+{
+   static std::vector<wxBitmap> bitmaps;
+   return bitmaps;
+}
+}
+
+WaveRaster::Colour::Colour(const wxPen &pen)
+   : red{ pen.GetColour().Red() }
+   , green{ pen.GetColour().Green() }
+   , blue{ pen.GetColour().Blue() }
+{
+}
+
+wxBitmap &WaveRaster::FindBitmap(int width, int height)
+{
+   auto &bitmaps = Bitmaps();
+   auto iter = std::find_if(bitmaps.begin(), bitmaps.end(),
+      [&](const wxBitmap &bitmap){
+         return bitmap.GetWidth() == width && bitmap.GetHeight() == height;
+      });
+   if (iter != bitmaps.end())
+      std::rotate(bitmaps.begin(), iter, iter + 1);
+   else {
+      if (bitmaps.size() >= MaxBitmaps)
+         bitmaps.pop_back();
+      bitmaps.emplace(bitmaps.begin(), width, height, 32);
+#ifdef __WXMSW__
+      bitmaps.front().UseAlpha();
+#endif
+   }
+   return bitmaps.front();
+}
+
+WaveRaster::WaveRaster(int width, int height)
+   : mBitmap{ FindBitmap(width, height) }
+   , mpData{ std::make_unique<wxAlphaPixelData>(mBitmap) }
+   , mWidth{ width }
+   , mHeight{ height }
+{
+   if (!*mpData) {
+      mpData.reset();
+      return;
+   }
+
+   // All zero is transparent, whether or not the platform premultiplies
+   // alpha, and opaque pixels need no premultiplying
+   wxAlphaPixelData::Iterator row{ *mpData };
+   for (int yy = 0; yy < mHeight; ++yy, row.OffsetY(*mpData, 1)) {
+      auto pixel = row;
+      for (int xx = 0; xx < mWidth; ++xx, ++pixel) {
+         pixel.Red() = 0;
+         pixel.Green() = 0;
+         pixel.Blue() = 0;
+         pixel.Alpha() = wxALPHA_TRANSPARENT;
+      }
+   }
+}
+
+WaveRaster::~WaveRaster()
+{
+}
+
+void WaveRaster::Span(int x, int y0, int y1, const Colour &colour)
+{
+   if (!mpData || x < 0 || x >= mWidth)
+      return;
+   if (y0 > y1)
+      std::swap(y0, y1);
+   y0 = std::max(0, y0);
+   y1 = std::min(mHeight - 1, y1);
+
+   wxAlphaPixelData::Iterator pixel{ *mpData };
+   pixel.MoveTo(*mpData, x, y0);
+   for (int yy = y0; yy <= y1; ++yy, pixel.OffsetY(*mpData, 1)) {
+      pixel.Red() = colour.red;
+      pixel.Green() = colour.green;
+      pixel.Blue() = colour.blue;
+      pixel.Alpha() = wxALPHA_OPAQUE;
+   }
+}
+
+void WaveRaster::Draw(wxDC &dc, int x, int y)
+{
+   if (!mpData)
+      return;
+   // Give the pixels back to the bitmap before drawing it
+   mpData.reset();
+   dc.DrawBitmap(mBitmap, x, y);
+}
@@ -0,0 +1,57 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+WaveRaster.h
+
+split from WaveformView.cpp
+
+**********************************************************************/
+
+#ifndef __AUDACITY_WAVE_RASTER__
+#define __AUDACITY_WAVE_RASTER__
+
+#include <memory>
+#include <wx/bitmap.h>
+#include <wx/rawbmp.h> // member variable
+
+class wxDC;
+class wxPen;
+
+//! Pixels of a waveform drawn into a bitmap, where the rest is transparent,
+//! to go over the background in one blit rather than a line for each column
+/*!
+ The bitmaps are kept between paints, one for each of the last few sizes
+ drawn, so that a paint allocates nothing unless the track sizes changed.
+ Only one raster may exist at a time.
+ */
+class AUDACITY_DLL_API WaveRaster
+{
+public:
+   struct Colour
+   {
+      explicit Colour(const wxPen &pen);
+      unsigned char red, green, blue;
+   };
+
+   //! Starts all transparent
+   WaveRaster(int width, int height);
+   ~WaveRaster();
+
+   //! Rows y0 through y1 of column x, in either order, inclusive as for
+   //! AColor::Line
+   void Span(int x, int y0, int y1, const Colour &colour);
+
+   //! Finishes writing pixels, and draws them with the top left at (x, y)
+   void Draw(wxDC &dc, int x, int y);
+
+private:
+   static wxBitmap &FindBitmap(int width, int height);
+
+   wxBitmap &mBitmap;
+   std::unique_ptr<wxAlphaPixelData> mpData;
+   const int mWidth;
+   const int mHeight;
+};
+
+#endif
@@ -14,6 +14,7 @@ Paul Licameli split from WaveTrackView.cpp
 #include "WaveformVRulerControls.h"
 #include "WaveTrackView.h"
 #include "WaveTrackViewConstants.h"
+#include "WaveRaster.h"
 
 #include "SampleHandle.h"
 #include "../../../ui/EnvelopeHandle.h"
@@ -353,10 +354,11 @@ void DrawMinMaxRMS(
    bool drawStripes = true;
    bool drawWaveform = true;
 
-   const auto &muteSamplePen = artist->muteSamplePen;
-   const auto &samplePen = artist->samplePen;
+   const WaveRaster::Colour muteSampleColour{ artist->muteSamplePen };
+   const WaveRaster::Colour sampleColour{ artist->samplePen };
+   const auto &lineColour = muted ? muteSampleColour : sampleColour;
 
-   dc.SetPen(muted ? muteSamplePen : samplePen);
+   WaveRaster raster{ rect.width, rect.height };
    for (int x0 = 0; x0 < rect.width; ++x0) {
       int xx = rect.x + x0;
       double v;
@@ -411,14 +413,13 @@ void DrawMinMaxRMS(
       if (bl[x0] <= -1) {
          if (drawStripes) {
             // TODO:unify with buffer drawing.
-            dc.SetPen((bl[x0] % 2) ? muteSamplePen : samplePen);
+            const auto &stripeColour =
+               (bl[x0] % 2) ? muteSampleColour : sampleColour;
             for (int yy = 0; yy < rect.height / 25 + 1; ++yy) {
-               // we are drawing over the buffer, but I think DrawLine takes care of this.
-               AColor::Line(dc,
-                            xx,
-                            rect.y + 25 * yy + (x0 /*+pixAnimOffset*/) % 25,
-                            xx,
-                            rect.y + 25 * yy + (x0 /*+pixAnimOffset*/) % 25 + 6); //take the min so we don't draw past the edge
+               raster.Span(x0,
+                           25 * yy + (x0 /*+pixAnimOffset*/) % 25,
+                           25 * yy + (x0 /*+pixAnimOffset*/) % 25 + 6,
+                           stripeColour);
             }
          }
 
@@ -426,48 +427,41 @@ void DrawMinMaxRMS(
          // Lets use a triangle wave for now since it's easier - I don't want to use sin() or make a wavetable just for this.
          if (drawWaveform) {
             int triX;
-            dc.SetPen(samplePen);
             triX = fabs((double)((x0 + pixAnimOffset) % (2 * rect.height)) - rect.height) + rect.height;
             for (int yy = 0; yy < rect.height; ++yy) {
                if ((yy + triX) % rect.height == 0) {
-                  dc.DrawPoint(xx, rect.y + yy);
+                  raster.Span(x0, yy, yy, sampleColour);
                }
             }
          }
-
-         // Restore the pen for remaining pixel columns!
-         dc.SetPen(muted ? muteSamplePen : samplePen);
       }
       else {
-         AColor::Line(dc, xx, rect.y + h2, xx, rect.y + h1);
+         raster.Span(x0, h2, h1, lineColour);
       }
    }
 
    // Stroke rms over the min-max
-   const auto &muteRmsPen = artist->muteRmsPen;
-   const auto &rmsPen = artist->rmsPen;
-
-   dc.SetPen(muted ? muteRmsPen : rmsPen);
+   const WaveRaster::Colour rmsColour{
+      muted ? artist->muteRmsPen : artist->rmsPen };
    for (int x0 = 0; x0 < rect.width; ++x0) {
-      int xx = rect.x + x0;
       if (bl[x0] <= -1) {
       }
       else if (r1[x0] != r2[x0]) {
-         AColor::Line(dc, xx, rect.y + r2[x0], xx, rect.y + r1[x0]);
+         raster.Span(x0, r2[x0], r1[x0], rmsColour);
       }
    }
 
    // Draw the clipping lines
    if (clipcnt) {
-      const auto &muteClippedPen = artist->muteClippedPen;
-      const auto &clippedPen = artist->clippedPen;
-
-      dc.SetPen(muted ? muteClippedPen : clippedPen);
+      const WaveRaster::Colour clippedColour{
+         muted ? artist->muteClippedPen : artist->clippedPen };
       while (--clipcnt >= 0) {
          int xx = clipped[clipcnt];
-         AColor::Line(dc, xx, rect.y, xx, rect.y + rect.height);
+         raster.Span(xx - rect.x, 0, rect.height, clippedColour);
       }
    }
+
+   raster.Draw(dc, rect.x, rect.y);
 }
 
 void DrawIndividualSamples(TrackPanelDrawingContext &context,
@@ -28,19 +28,16 @@
 
 *//****************************************************************//**
 
-\class MeterUpdateMsg
-\brief Message used to update the MeterPanel
-
-*//****************************************************************//**
-
-\class MeterUpdateQueue
-\brief Queue of MeterUpdateMsg used to feed the MeterPanel.
+\class MeterChannelLevels
+\brief Levels of one channel passed from the audio thread to the
+MeterPanel.
 
 *//******************************************************************/
 
 #include "MeterPanel.h"
 
 #include <algorithm>
+#include <cstring>
 #include <wx/setup.h> // for wxUSE_* macros
 #include <wx/wxcrtvararg.h>
 #include <wx/app.h>
@@ -157,93 +154,71 @@ public:
 static const long MIN_REFRESH_RATE = 1;
 static const long MAX_REFRESH_RATE = 100;
 
-/* Updates to the meter are passed across via meter updates, each contained in
- * a MeterUpdateMsg object */
-wxString MeterUpdateMsg::toString()
-{
-wxString output;  // somewhere to build up a string in
-output = wxString::Format(wxT("Meter update msg: %i channels, %i samples\n"), \
-      kMaxMeterBars, numFrames);
-for (int i = 0; i<kMaxMeterBars; i++)
-   {  // for each channel of the meters
-   output += wxString::Format(wxT("%f peak, %f rms "), peak[i], rms[i]);
-   if (clipping[i])
-      output += wxString::Format(wxT("clipped "));
-   else
-      output += wxString::Format(wxT("no clip "));
-   output += wxString::Format(wxT("%i head, %i tail\n"), headPeakCount[i], tailPeakCount[i]);
-   }
-return output;
-}
-
-wxString MeterUpdateMsg::toStringIfClipped()
-{
-   for (int i = 0; i<kMaxMeterBars; i++)
-   {
-      if (clipping[i] || (headPeakCount[i] > 0) || (tailPeakCount[i] > 0))
-         return toString();
-   }
-   return wxT("");
-}
-
 //
-// The MeterPanel passes itself messages via this queue so that it can
-// communicate between the audio thread and the GUI thread.
-// This class is as simple as possible in order to be thread-safe
-// without needing mutexes.
+// The audio thread accumulates levels here, and the MeterPanel takes them
+// on its timer.  The audio thread never waits, and nothing is lost when
+// the timer is late.
 //
 
-MeterUpdateQueue::MeterUpdateQueue(size_t maxLen):
-   mBufferSize(maxLen)
+namespace {
+std::uint64_t PackEnergy(std::uint32_t numFrames, float sumOfSquares)
 {
-   Clear();
+   std::uint32_t bits;
+   memcpy(&bits, &sumOfSquares, sizeof(bits));
+   return (std::uint64_t(numFrames) << 32) | bits;
 }
 
-// destructor
-MeterUpdateQueue::~MeterUpdateQueue()
+void UnpackEnergy(std::uint64_t energy, int &numFrames, float &sumOfSquares)
 {
+   numFrames = int(energy >> 32);
+   const auto bits = std::uint32_t(energy);
+   memcpy(&sumOfSquares, &bits, sizeof(bits));
+}
 }
 
-void MeterUpdateQueue::Clear()
+void MeterChannelLevels::Accumulate(int numFrames, float peak,
+   float sumOfSquares, bool clipping, int tailPeakCount)
 {
-   mStart = 0;
-   mEnd = 0;
+   // There is one writer, so these loops only retry when Take() intervenes
+   auto oldPeak = mPeak.load(std::memory_order_relaxed);
+   while (oldPeak < peak &&
+      !mPeak.compare_exchange_weak(oldPeak, peak, std::memory_order_relaxed))
+      ;
+   if (clipping)
+      mClipping.store(true, std::memory_order_relaxed);
+   mTailPeakCount.store(tailPeakCount, std::memory_order_relaxed);
+   // Frames and their sum of squares change together, so Take() never sees
+   // the one without the other
+   auto oldEnergy = mEnergy.load(std::memory_order_relaxed);
+   std::uint64_t newEnergy;
+   do {
+      int oldFrames;
+      float oldSum;
+      UnpackEnergy(oldEnergy, oldFrames, oldSum);
+      newEnergy = PackEnergy(oldFrames + numFrames, oldSum + sumOfSquares);
+   } while (!mEnergy.compare_exchange_weak(
+      oldEnergy, newEnergy, std::memory_order_relaxed));
 }
 
-// Add a message to the end of the queue.  Return false if the
-// queue was full.
-bool MeterUpdateQueue::Put(MeterUpdateMsg &msg)
+MeterChannelLevels::Totals MeterChannelLevels::Take()
 {
-   // mStart can be greater than mEnd because it is all mod mBufferSize
-   wxASSERT( (mEnd + mBufferSize - mStart) >= 0 );
-   int len = (mEnd + mBufferSize - mStart) % mBufferSize;
-
-   // Never completely fill the queue, because then the
-   // state is ambiguous (mStart==mEnd)
-   if (len + 1 >= (int)(mBufferSize))
-      return false;
-
-   //wxLogDebug(wxT("Put: %s"), msg.toString());
-
-   mBuffer[mEnd] = msg;
-   mEnd = (mEnd+1)%mBufferSize;
-
-   return true;
+   Totals totals;
+   float sumOfSquares;
+   UnpackEnergy(mEnergy.exchange(0, std::memory_order_relaxed),
+      totals.numFrames, sumOfSquares);
+   totals.peak = mPeak.exchange(0, std::memory_order_relaxed);
+   totals.rms = totals.numFrames > 0
+      ? sqrt(sumOfSquares / totals.numFrames) : 0;
+   totals.clipping = mClipping.exchange(false, std::memory_order_relaxed);
+   return totals;
 }
 
-// Get the next message from the start of the queue.
-// Return false if the queue was empty.
-bool MeterUpdateQueue::Get(MeterUpdateMsg &msg)
+void MeterChannelLevels::Clear()
 {
-   int len = (mEnd + mBufferSize - mStart) % mBufferSize;
-
-   if (len == 0)
-      return false;
-
-   msg = mBuffer[mStart];
-   mStart = (mStart+1)%mBufferSize;
-
-   return true;
+   mEnergy.store(0, std::memory_order_relaxed);
+   mPeak.store(0, std::memory_order_relaxed);
+   mClipping.store(false, std::memory_order_relaxed);
+   mTailPeakCount.store(0, std::memory_order_relaxed);
 }
 
 //
@@ -295,7 +270,6 @@ MeterPanel::MeterPanel(AudacityProject *project,
              float fDecayRate /*= 60.0f*/)
 : MeterPanelBase(parent, id, pos, size, wxTAB_TRAVERSAL | wxNO_BORDER | wxWANTS_CHARS),
    mProject(project),
-   mQueue(1024),
    mWidth(size.x),
    mHeight(size.y),
    mIsInput(isInput),
@@ -407,7 +381,8 @@ MeterPanel::MeterPanel(AudacityProject *project,
 
 void MeterPanel::Clear()
 {
-   mQueue.Clear();
+   for (auto &levels : mLevels)
+      levels.Clear();
 }
 
 void MeterPanel::UpdatePrefs()
@@ -782,6 +757,12 @@ void MeterPanel::OnMouse(wxMouseEvent &evt)
       wxToolTip * pTip = this->GetToolTip();
       if( pTip ) {
          auto tipText = Verbatim( pTip->GetTip() );
+         // The recording meter also tells the delay of software playthrough
+         const auto latency = (mIsInput && mActive)
+            ? AudioIO::Get()->GetMonitorLatency() : 0.0;
+         if (latency > 0)
+            tipText = XO("%s (playthrough latency %.1f ms)")
+               .Format( pTip->GetTip(), 1000 * latency );
          ProjectStatus::Get( *mProject ).Set(tipText);
       }
    }
@@ -941,8 +922,9 @@ void MeterPanel::Reset(double sampleRate, bool resetClipping)
    // no good reason, so this "primes" it every now and then...
    mTimer.Stop();
 
-   // While it's stopped, empty the queue
-   mQueue.Clear();
+   // While it's stopped, discard what the audio thread accumulated
+   for (auto &levels : mLevels)
+      levels.Clear();
 
    mLayoutValid = false;
 
@@ -991,89 +973,39 @@ static float ToDB(float v, float range)
 void MeterPanel::UpdateDisplay(
    unsigned numChannels, int numFrames, const float *sampleData)
 {
-   auto sptr = sampleData;
-   auto num = std::min(numChannels, mNumBars);
-   MeterUpdateMsg msg;
-
-   memset(&msg, 0, sizeof(msg));
-   msg.numFrames = numFrames;
-
-   for(int i=0; i<numFrames; i++) {
-      for(unsigned int j=0; j<num; j++) {
-         msg.peak[j] = floatMax(msg.peak[j], fabs(sptr[j]));
-         msg.rms[j] += sptr[j]*sptr[j];
-
-         // In addition to looking for mNumPeakSamplesToClip peaked
-         // samples in a row, also send the number of peaked samples
-         // at the head and tail, in case there's a run of peaked samples
-         // that crosses block boundaries
-         if (fabs(sptr[j])>=MAX_AUDIO) {
-            if (msg.headPeakCount[j]==i)
-               msg.headPeakCount[j]++;
-            msg.tailPeakCount[j]++;
-            if (msg.tailPeakCount[j] > mNumPeakSamplesToClip)
-               msg.clipping[j] = true;
+   // The timer lays out the bars again if the channel count changed
+   auto num = std::min<unsigned>(numChannels, kMaxMeterBars);
+   mNumChannels.store(num, std::memory_order_relaxed);
+
+   for(unsigned int j=0; j<num; j++) {
+      auto &levels = mLevels[j];
+      auto sptr = sampleData + j;
+      float peak = 0, sumOfSquares = 0;
+      bool clipping = false;
+      // Continue any run of peaked samples from the previous block
+      int tailPeakCount = levels.GetTailPeakCount();
+
+      for(int i=0; i<numFrames; i++, sptr += numChannels) {
+         const float sample = fabs(*sptr);
+         peak = floatMax(peak, sample);
+         sumOfSquares += sample * sample;
+
+         // Look for mNumPeakSamplesToClip peaked samples in a row
+         if (sample>=MAX_AUDIO) {
+            if (++tailPeakCount >= mNumPeakSamplesToClip)
+               clipping = true;
          }
          else
-            msg.tailPeakCount[j] = 0;
+            tailPeakCount = 0;
       }
-      sptr += numChannels;
-   }
-   for(unsigned int j=0; j<mNumBars; j++)
-      msg.rms[j] = sqrt(msg.rms[j]/numFrames);
 
-   mQueue.Put(msg);
+      levels.Accumulate(
+         numFrames, peak, sumOfSquares, clipping, tailPeakCount);
+   }
 }
 
-// Vaughan, 2010-11-29: This not currently used. See comments in MixerTrackCluster::UpdateMeter().
-//void MeterPanel::UpdateDisplay(int numChannels, int numFrames,
-//                           // Need to make these double-indexed arrays if we handle more than 2 channels.
-//                           float* maxLeft, float* rmsLeft,
-//                           float* maxRight, float* rmsRight,
-//                           const size_t kSampleCount)
-//{
-//   int i, j;
-//   int num = intmin(numChannels, mNumBars);
-//   MeterUpdateMsg msg;
-//
-//   msg.numFrames = kSampleCount;
-//   for(j=0; j<mNumBars; j++) {
-//      msg.peak[j] = 0.0;
-//      msg.rms[j] = 0.0;
-//      msg.clipping[j] = false;
-//      msg.headPeakCount[j] = 0;
-//      msg.tailPeakCount[j] = 0;
-//   }
-//
-//   for(i=0; i<numFrames; i++) {
-//      for(j=0; j<num; j++) {
-//         msg.peak[j] = floatMax(msg.peak[j], ((j == 0) ? maxLeft[i] : maxRight[i]));
-//         msg.rms[j] = floatMax(msg.rms[j], ((j == 0) ? rmsLeft[i] : rmsRight[i]));
-//
-//         // In addition to looking for mNumPeakSamplesToClip peaked
-//         // samples in a row, also send the number of peaked samples
-//         // at the head and tail, in case there's a run
-//         // of peaked samples that crosses block boundaries.
-//         if (fabs((j == 0) ? maxLeft[i] : maxRight[i]) >= MAX_AUDIO)
-//         {
-//            if (msg.headPeakCount[j]==i)
-//               msg.headPeakCount[j]++;
-//            msg.tailPeakCount[j]++;
-//            if (msg.tailPeakCount[j] > mNumPeakSamplesToClip)
-//               msg.clipping[j] = true;
-//         }
-//         else
-//            msg.tailPeakCount[j] = 0;
-//      }
-//   }
-//
-//   mQueue.Put(msg);
-//}
-
 void MeterPanel::OnMeterUpdate(wxTimerEvent & WXUNUSED(event))
 {
-   MeterUpdateMsg msg;
-   int numChanges = 0;
 #ifdef EXPERIMENTAL_AUTOMATED_INPUT_LEVEL_ADJUSTMENT
    double maxPeak = 0.0;
    bool discarded = false;
@@ -1081,91 +1013,104 @@ void MeterPanel::OnMeterUpdate(wxTimerEvent & WXUNUSED(event))
 
    // We shouldn't receive any events if the meter is disabled, but clear it to be safe
    if (mMeterDisabled) {
-      mQueue.Clear();
+      for (auto &levels : mLevels)
+         levels.Clear();
       return;
    }
 
    auto gAudioIO = AudioIO::Get();
 
-   // There may have been several update messages since the last
-   // time we got to this function.  Catch up to real-time by
-   // popping them off until there are none left.  It is necessary
-   // to process all of them, otherwise we won't handle peaks and
-   // peak-hold bars correctly.
-   while(mQueue.Get(msg)) {
-      numChanges++;
-      double deltaT = msg.numFrames / mRate;
+   // Lay out one bar per channel, but never fewer than the two the styles
+   // were drawn for
+   const auto numBars =
+      std::max(2u, mNumChannels.load(std::memory_order_relaxed));
+   if (numBars != mNumBars && mLayoutValid) {
+      for (auto &levels : mLevels)
+         levels.Clear();
+      mLayoutValid = false;
+      Refresh(false);
+      return;
+   }
+
+   // Take everything accumulated since the last time we got to this
+   // function, however many blocks that was, so that peaks and peak-hold
+   // bars are handled correctly.
+   MeterChannelLevels::Totals totals[kMaxMeterBars];
+   int numFrames = 0;
+   for(unsigned int j=0; j<mNumBars; j++) {
+      totals[j] = mLevels[j].Take();
+      numFrames = intmax(numFrames, totals[j].numFrames);
+   }
+   if (numFrames == 0)
+      return;
 
-      mT += deltaT;
-      for(unsigned int j=0; j<mNumBars; j++) {
-         mBar[j].isclipping = false;
+   double deltaT = numFrames / mRate;
 
-         //
+   mT += deltaT;
+   for(unsigned int j=0; j<mNumBars; j++) {
+      auto &total = totals[j];
+      mBar[j].isclipping = false;
+
+      //
+      if (mDB) {
+         total.peak = ToDB(total.peak, mDBRange);
+         total.rms = ToDB(total.rms, mDBRange);
+      }
+
+      if (mDecay) {
          if (mDB) {
-            msg.peak[j] = ToDB(msg.peak[j], mDBRange);
-            msg.rms[j] = ToDB(msg.rms[j], mDBRange);
+            float decayAmount = mDecayRate * deltaT / mDBRange;
+            mBar[j].peak = floatMax(total.peak,
+                                    mBar[j].peak - decayAmount);
          }
-
-         if (mDecay) {
-            if (mDB) {
-               float decayAmount = mDecayRate * deltaT / mDBRange;
-               mBar[j].peak = floatMax(msg.peak[j],
-                                       mBar[j].peak - decayAmount);
-            }
-            else {
-               double decayAmount = mDecayRate * deltaT;
-               double decayFactor = DB_TO_LINEAR(-decayAmount);
-               mBar[j].peak = floatMax(msg.peak[j],
-                                       mBar[j].peak * decayFactor);
-            }
+         else {
+            double decayAmount = mDecayRate * deltaT;
+            double decayFactor = DB_TO_LINEAR(-decayAmount);
+            mBar[j].peak = floatMax(total.peak,
+                                    mBar[j].peak * decayFactor);
          }
-         else
-            mBar[j].peak = msg.peak[j];
+      }
+      else
+         mBar[j].peak = total.peak;
 
-         // This smooths out the RMS signal
-         float smooth = pow(0.9, (double)msg.numFrames/1024.0);
-         mBar[j].rms = mBar[j].rms * smooth + msg.rms[j] * (1.0 - smooth);
+      // This smooths out the RMS signal
+      float smooth = pow(0.9, (double)numFrames/1024.0);
+      mBar[j].rms = mBar[j].rms * smooth + total.rms * (1.0 - smooth);
 
-         if (mT - mBar[j].peakHoldTime > mPeakHoldDuration ||
-             mBar[j].peak > mBar[j].peakHold) {
-            mBar[j].peakHold = mBar[j].peak;
-            mBar[j].peakHoldTime = mT;
-         }
+      if (mT - mBar[j].peakHoldTime > mPeakHoldDuration ||
+          mBar[j].peak > mBar[j].peakHold) {
+         mBar[j].peakHold = mBar[j].peak;
+         mBar[j].peakHoldTime = mT;
+      }
 
-         if (mBar[j].peak > mBar[j].peakPeakHold )
-            mBar[j].peakPeakHold = mBar[j].peak;
+      if (mBar[j].peak > mBar[j].peakPeakHold )
+         mBar[j].peakPeakHold = mBar[j].peak;
 
-         if (msg.clipping[j] ||
-             mBar[j].tailPeakCount+msg.headPeakCount[j] >=
-             mNumPeakSamplesToClip){
-            mBar[j].clipping = true;
-            mBar[j].isclipping = true;
-         }
+      if (total.clipping) {
+         mBar[j].clipping = true;
+         mBar[j].isclipping = true;
+      }
 
-         mBar[j].tailPeakCount = msg.tailPeakCount[j];
 #ifdef EXPERIMENTAL_AUTOMATED_INPUT_LEVEL_ADJUSTMENT
-         if (mT > gAudioIO->AILAGetLastDecisionTime()) {
-            discarded = false;
-            maxPeak = msg.peak[j] > maxPeak ? msg.peak[j] : maxPeak;
-            wxPrintf("%f@%f ", msg.peak[j], mT);
-         }
-         else {
-            discarded = true;
-            wxPrintf("%f@%f discarded\n", msg.peak[j], mT);
-         }
-#endif
+      if (mT > gAudioIO->AILAGetLastDecisionTime()) {
+         discarded = false;
+         maxPeak = total.peak > maxPeak ? total.peak : maxPeak;
+         wxPrintf("%f@%f ", total.peak, mT);
       }
-   } // while
-
-   if (numChanges > 0) {
-      #ifdef EXPERIMENTAL_AUTOMATED_INPUT_LEVEL_ADJUSTMENT
-         if (gAudioIO->AILAIsActive() && mIsInput && !discarded) {
-            gAudioIO->AILAProcess(maxPeak);
-            putchar('\n');
-         }
-      #endif
-      RepaintBarsNow();
+      else {
+         discarded = true;
+         wxPrintf("%f@%f discarded\n", total.peak, mT);
+      }
+#endif
    }
+
+   #ifdef EXPERIMENTAL_AUTOMATED_INPUT_LEVEL_ADJUSTMENT
+      if (gAudioIO->AILAIsActive() && mIsInput && !discarded) {
+         gAudioIO->AILAProcess(maxPeak);
+         putchar('\n');
+      }
+   #endif
+   RepaintBarsNow();
 }
 
 float MeterPanel::GetMaxPeak() const
@@ -1200,7 +1145,6 @@ void MeterPanel::ResetBar(MeterBar *b, bool resetClipping)
       b->peakPeakHold = 0.0;
    }
    b->isclipping = false;
-   b->tailPeakCount = 0;
 }
 
 bool MeterPanel::IsClipping() const
@@ -1295,6 +1239,25 @@ void MeterPanel::SetBarAndClip(int iBar, bool vert)
    }
 }
 
+// Lays out mNumBars bevels the size of first, gap pixels apart, side by
+// side if vert or else one above the other
+void MeterPanel::SetBars(const wxRect &first, bool vert)
+{
+   mBar[0].b = first;
+   for (unsigned int i = 1; i < mNumBars; i++)
+   {
+      mBar[i].b = mBar[i - 1].b;
+      if (vert)
+         mBar[i].b.SetLeft(mBar[i - 1].b.GetRight() + 1 + gap); // +1 for right edge
+      else
+         mBar[i].b.SetTop(mBar[i - 1].b.GetBottom() + 1 + gap); // +1 for bottom edge
+   }
+
+   // Set bar and clipping indicator dimensions
+   for (unsigned int i = 0; i < mNumBars; i++)
+      SetBarAndClip(i, vert);
+}
+
 void MeterPanel::HandleLayout(wxDC &dc)
 {
    // Refresh to reflect any language changes
@@ -1346,6 +1309,10 @@ void MeterPanel::HandleLayout(wxDC &dc)
    int rtxtWidth = mRightSize.GetWidth();
    int rtxtHeight = mRightSize.GetHeight();
 
+   mNumBars = std::max(2u, mNumChannels.load(std::memory_order_relaxed));
+   // The ruler goes beside the last bar
+   const auto &last = mBar[mNumBars - 1];
+
    switch (mStyle)
    {
    default:
@@ -1358,30 +1325,20 @@ void MeterPanel::HandleLayout(wxDC &dc)
       // height is now the entire height of the meter canvas
       height -= top + gap;
  
-      // barw is half of the canvas while allowing for a gap between meters
-      barw = (width - gap) / 2;
+      // barw divides the canvas among the bars while allowing for a gap
+      // between meters
+      barw = (width - (int(mNumBars) - 1) * gap) / int(mNumBars);
 
       // barh is now the height of the canvas
       barh = height;
 
-      // We always have 2 bars
-      mNumBars = 2;
+      // Save dimensions of the bevels, left to right
+      SetBars(wxRect(left, top, barw, barh), true);
 
-      // Save dimensions of the left bevel
-      mBar[0].b = wxRect(left, top, barw, barh);
-
-      // Save dimensions of the right bevel
-      mBar[1].b = mBar[0].b;
-      mBar[1].b.SetLeft(mBar[0].b.GetRight() + 1 + gap); // +1 for right edge
-
-      // Set bar and clipping indicator dimensions
-      SetBarAndClip(0, true);
-      SetBarAndClip(1, true);
-
-      mRuler.SetBounds(mBar[1].r.GetRight() + 1,   // +1 for the bevel
-                       mBar[1].r.GetTop(),
+      mRuler.SetBounds(last.r.GetRight() + 1,   // +1 for the bevel
+                       last.r.GetTop(),
                        mWidth,
-                       mBar[1].r.GetBottom());
+                       last.r.GetBottom());
       mRuler.OfflimitsPixels(0, 0);
       break;
    case VerticalStereo:
@@ -1414,31 +1371,21 @@ void MeterPanel::HandleLayout(wxDC &dc)
       // height is now the entire height of the meter canvas
       height -= top + gap;
  
-      // barw is half of the canvas while allowing for a gap between meters
-      barw = (width - gap) / 2;
+      // barw divides the canvas among the bars while allowing for a gap
+      // between meters
+      barw = (width - (int(mNumBars) - 1) * gap) / int(mNumBars);
 
       // barh is now the height of the canvas
       barh = height;
 
-      // We always have 2 bars
-      mNumBars = 2;
-
-      // Save dimensions of the left bevel
-      mBar[0].b = wxRect(left, top, barw, barh);
-
-      // Save dimensions of the right bevel
-      mBar[1].b = mBar[0].b;
-      mBar[1].b.SetLeft(mBar[0].b.GetRight() + 1 + gap); // +1 for right edge
-
-      // Set bar and clipping indicator dimensions
-      SetBarAndClip(0, true);
-      SetBarAndClip(1, true);
+      // Save dimensions of the bevels, left to right
+      SetBars(wxRect(left, top, barw, barh), true);
 
-      mRuler.SetBounds(mBar[1].r.GetRight() + 1,   // +1 for the bevel
-                       mBar[1].r.GetTop(),
+      mRuler.SetBounds(last.r.GetRight() + 1,   // +1 for the bevel
+                       last.r.GetTop(),
                        mWidth,
-                       mBar[1].r.GetBottom());
-      mRuler.OfflimitsPixels(mRightTextPos.y - gap, mBar[1].r.GetBottom());
+                       last.r.GetBottom());
+      mRuler.OfflimitsPixels(mRightTextPos.y - gap, last.r.GetBottom());
       break;
    case VerticalStereoCompact:
       // Ensure there's a margin between top edge of window and the meters
@@ -1456,34 +1403,24 @@ void MeterPanel::HandleLayout(wxDC &dc)
       // height is now the entire height of the meter canvas
       height -= top + gap + ltxtHeight + gap;
 
-      // barw is half of the canvas while allowing for a gap between meters
-      barw = (width / 2) - gap;
+      // barw divides the canvas among the bars while allowing for a gap
+      // between meters
+      barw = (width / int(mNumBars)) - gap;
 
       // barh is now the height of the canvas
       barh = height;
 
-      // We always have 2 bars
-      mNumBars = 2;
-
-      // Save dimensions of the left bevel
-      mBar[0].b = wxRect(left, top, barw, barh);
-
-      // Save dimensions of the right bevel
-      mBar[1].b = mBar[0].b;
-      mBar[1].b.SetLeft(mBar[0].b.GetRight() + 1 + gap); // +1 for right edge
-
-      // Set bar and clipping indicator dimensions
-      SetBarAndClip(0, true);
-      SetBarAndClip(1, true);
+      // Save dimensions of the bevels, left to right
+      SetBars(wxRect(left, top, barw, barh), true);
 
       // L/R is centered horizontally under each bar
       mLeftTextPos = wxPoint(mBar[0].b.GetLeft() + ((mBar[0].b.GetWidth() - ltxtWidth) / 2), top + barh + gap);
-      mRightTextPos = wxPoint(mBar[1].b.GetLeft() + ((mBar[1].b.GetWidth() - rtxtWidth) / 2), top + barh + gap);
+      mRightTextPos = wxPoint(mBar[mNumBars - 1].b.GetLeft() + ((mBar[mNumBars - 1].b.GetWidth() - rtxtWidth) / 2), top + barh + gap);
 
       mRuler.SetBounds((mWidth - mRulerWidth) / 2,
-                       mBar[1].r.GetTop(),
+                       last.r.GetTop(),
                        (mWidth - mRulerWidth) / 2,
-                       mBar[1].r.GetBottom());
+                       last.r.GetBottom());
       mRuler.OfflimitsPixels(0, 0);
       break;
    case HorizontalStereo:
@@ -1519,27 +1456,17 @@ void MeterPanel::HandleLayout(wxDC &dc)
       // barw is now the width of the canvas minus gap between canvas and right window edge
       barw = width - gap;
 
-      // barh is half of the canvas while allowing for a gap between meters
-      barh = (height - gap) / 2;
+      // barh divides the canvas among the bars while allowing for a gap
+      // between meters
+      barh = (height - (int(mNumBars) - 1) * gap) / int(mNumBars);
 
-      // We always have 2 bars
-      mNumBars = 2;
+      // Save dimensions of the bevels, top to bottom
+      SetBars(wxRect(left, top, barw, barh), false);
 
-      // Save dimensions of the top bevel
-      mBar[0].b = wxRect(left, top, barw, barh);
-
-      // Save dimensions of the bottom bevel
-      mBar[1].b = mBar[0].b;
-      mBar[1].b.SetTop(mBar[0].b.GetBottom() + 1 + gap); // +1 for bottom edge
-
-      // Set bar and clipping indicator dimensions
-      SetBarAndClip(0, false);
-      SetBarAndClip(1, false);
-
-      mRuler.SetBounds(mBar[1].r.GetLeft(),
-                       mBar[1].r.GetBottom() + 1, // +1 to fit below bevel
-                       mBar[1].r.GetRight(),
-                       mHeight - mBar[1].r.GetBottom() + 1);
+      mRuler.SetBounds(last.r.GetLeft(),
+                       last.r.GetBottom() + 1, // +1 to fit below bevel
+                       last.r.GetRight(),
+                       mHeight - last.r.GetBottom() + 1);
       mRuler.OfflimitsPixels(0, mIconRect.GetRight() - 4);
       break;
    case HorizontalStereoCompact:
@@ -1569,31 +1496,30 @@ void MeterPanel::HandleLayout(wxDC &dc)
       // barw is now the width of the canvas minus gap between canvas and window edge
       barw = width - gap;
 
-      // barh is half of the canvas while allowing for a gap between meters
-      barh = (height - gap) / 2;
-
-      // We always have 2 bars
-      mNumBars = 2;
+      // barh divides the canvas among the bars while allowing for a gap
+      // between meters
+      barh = (height - (int(mNumBars) - 1) * gap) / int(mNumBars);
 
-      // Save dimensions of the top bevel
-      mBar[0].b = wxRect(left, top, barw, barh);
-
-      // Save dimensions of the bottom bevel
+      // Save dimensions of the bevels, top to bottom
       // Since the bars butt up against the window's top and bottom edges, we need
       // to include an extra pixel in the bottom bar when the window height and
       // meter height do not exactly match.
-      mBar[1].b = mBar[0].b;
-      mBar[1].b.SetTop(mBar[0].b.GetBottom() + 1 + gap); // +1 for bottom bevel
-      mBar[1].b.SetHeight(mHeight - mBar[1].b.GetTop() - 1); // +1 for bottom bevel
+      mBar[0].b = wxRect(left, top, barw, barh);
+      for (unsigned int i = 1; i < mNumBars; i++)
+      {
+         mBar[i].b = mBar[i - 1].b;
+         mBar[i].b.SetTop(mBar[i - 1].b.GetBottom() + 1 + gap); // +1 for bottom bevel
+      }
+      mBar[mNumBars - 1].b.SetHeight(mHeight - mBar[mNumBars - 1].b.GetTop() - 1); // +1 for bottom bevel
 
       // Add clipping indicators - do after setting bar/bevel dimensions above
-      SetBarAndClip(0, false);
-      SetBarAndClip(1, false);
+      for (unsigned int i = 0; i < mNumBars; i++)
+         SetBarAndClip(i, false);
 
-      mRuler.SetBounds(mBar[1].r.GetLeft(),
-                       mBar[1].b.GetTop() - (mRulerHeight / 2),
-                       mBar[1].r.GetRight(),
-                       mBar[1].b.GetTop() - (mRulerHeight / 2));
+      mRuler.SetBounds(last.r.GetLeft(),
+                       last.b.GetTop() - (mRulerHeight / 2),
+                       last.r.GetRight(),
+                       last.b.GetTop() - (mRulerHeight / 2));
       mRuler.OfflimitsPixels(0, 0);
       break;
    }
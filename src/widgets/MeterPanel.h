@@ -16,6 +16,8 @@
 #ifndef __AUDACITY_METER_PANEL__
 #define __AUDACITY_METER_PANEL__
 
+#include <atomic>
+#include <cstdint>
 #include <wx/setup.h> // for wxUSE_* macros
 #include <wx/brush.h> // member variable
 #include <wx/defs.h>
@@ -28,9 +30,8 @@
 
 class AudacityProject;
 
-// Increase this when we add support for multichannel meters
-// (most of the code is already there)
-const int kMaxMeterBars = 2;
+// Meters lay out one bar per channel of the device, up to this many
+const int kMaxMeterBars = 64;
 
 struct MeterBar {
    bool   vert;
@@ -43,47 +44,49 @@ struct MeterBar {
    wxRect rClip;
    bool   clipping;
    bool   isclipping; //ANSWER-ME: What's the diff between these bools?! "clipping" vs "isclipping" is not clear.
-   int    tailPeakCount;
    float  peakPeakHold;
 };
 
-class MeterUpdateMsg
-{
-   public:
-   int numFrames;
-   float peak[kMaxMeterBars];
-   float rms[kMaxMeterBars];
-   bool clipping[kMaxMeterBars];
-   int headPeakCount[kMaxMeterBars];
-   int tailPeakCount[kMaxMeterBars];
-
-   /* neither constructor nor destructor do anything */
-   MeterUpdateMsg() { }
-   ~MeterUpdateMsg() { }
-   /* for debugging purposes, printing the values out is really handy */
-   /** \brief Print out all the values in the meter update message */
-   wxString toString();
-   /** \brief Only print meter updates if clipping may be happening */
-   wxString toStringIfClipped();
-};
-
-// Thread-safe queue of update messages
-class MeterUpdateQueue
+//! Levels of one channel, accumulated by the audio thread until the meter
+//! next takes them
+/*!
+ Updated with relaxed atomics and no locks.  The meter takes the totals at
+ its own refresh rate, so nothing is dropped however many blocks arrive in
+ between, and the cost of a block does not depend on the number of meters.
+ The frame count and sum of squares share one atomic, so the RMS always
+ covers whole blocks; the peak and clipping may be taken a block apart,
+ which the display can't show.
+ */
+class MeterChannelLevels
 {
  public:
-   explicit MeterUpdateQueue(size_t maxLen);
-   ~MeterUpdateQueue();
+   struct Totals
+   {
+      int numFrames;
+      float peak;
+      float rms;
+      bool clipping;
+   };
+
+   //! Called by the audio thread only
+   void Accumulate(int numFrames, float peak, float sumOfSquares,
+      bool clipping, int tailPeakCount);
+   //! Run of peaked samples at the end of the last block
+   int GetTailPeakCount() const
+   { return mTailPeakCount.load(std::memory_order_relaxed); }
 
-   bool Put(MeterUpdateMsg &msg);
-   bool Get(MeterUpdateMsg &msg);
+   //! Returns the totals since the last call, and restarts them
+   Totals Take();
 
    void Clear();
 
  private:
-   int              mStart;
-   int              mEnd;
-   size_t           mBufferSize;
-   ArrayOf<MeterUpdateMsg> mBuffer{mBufferSize};
+   //! Frame count in the high half, bits of the float sum of squares in
+   //! the low half
+   std::atomic<std::uint64_t> mEnergy{ 0 };
+   std::atomic<float> mPeak{ 0 };
+   std::atomic<bool> mClipping{ false };
+   std::atomic<int> mTailPeakCount{ 0 };
 };
 
 class MeterAx;
@@ -158,13 +161,6 @@ class AUDACITY_DLL_API MeterPanel final
    void UpdateDisplay(unsigned numChannels,
                       int numFrames, const float *sampleData) override;
 
-   // Vaughan, 2010-11-29: This not currently used. See comments in MixerTrackCluster::UpdateMeter().
-   //void UpdateDisplay(int numChannels, int numFrames,
-   //                     // Need to make these double-indexed max and min arrays if we handle more than 2 channels.
-   //                     float* maxLeft, float* rmsLeft,
-   //                     float* maxRight, float* rmsRight,
-   //                     const size_t kSampleCount);
-
    /** \brief Find out if the level meter is disabled or not.
     *
     * This method is thread-safe!  Feel free to call from a
@@ -212,6 +208,7 @@ class AUDACITY_DLL_API MeterPanel final
    void HandleLayout(wxDC &dc);
    void SetActiveStyle(Style style);
    void SetBarAndClip(int iBar, bool vert);
+   void SetBars(const wxRect &first, bool vert);
    void DrawMeterBar(wxDC &dc, MeterBar *meterBar);
    void ResetBar(MeterBar *bar, bool resetClipping);
    void RepaintBarsNow();
@@ -227,7 +224,7 @@ class AUDACITY_DLL_API MeterPanel final
    wxString Key(const wxString & key) const;
 
    AudacityProject *mProject;
-   MeterUpdateQueue mQueue;
+   MeterChannelLevels mLevels[kMaxMeterBars];
    wxTimer          mTimer;
 
    int       mWidth;
@@ -259,6 +256,8 @@ class AUDACITY_DLL_API MeterPanel final
 
    unsigned  mNumBars;
    MeterBar  mBar[kMaxMeterBars];
+   //! Channels last given to UpdateDisplay, which the layout follows
+   std::atomic<unsigned> mNumChannels{ 2 };
 
    bool      mLayoutValid;
 